@@ -170,6 +170,11 @@ set(USE_NNPACK OFF)
 # - /path/to/install_nn2: use specific path to CSI-NN library
 set(USE_CSINN ON)
 
+# Whether use zlib for the deflated entries of indexed CSI-NN params
+# (params_compress). Without it the CRC32 of the entries is computed in place
+# and compressed params cannot be written nor loaded.
+set(USE_CSINN_ZLIB ON)
+
 # Possible values:
 # - ON: enable tflite with cmake's find search
 # - OFF: disable tflite
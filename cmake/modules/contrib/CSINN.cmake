@@ -16,11 +16,17 @@
 # under the License.
 
 if(USE_CSINN)
-  find_package(ZLIB REQUIRED)
+  add_definitions(-DUSE_CSINN=1)
+  if(USE_CSINN_ZLIB)
+    find_package(ZLIB REQUIRED)
+    add_definitions(-DUSE_CSINN_ZLIB=1)
+    include_directories(${ZLIB_INCLUDE_DIRS})
+    list(APPEND TVM_RUNTIME_LINKER_LIBS ${ZLIB_LIBRARIES})
+  endif()
 
   file(GLOB CSINN_RELAY_CONTRIB_SRC src/relay/backend/contrib/csinn/*.cc)
   list(APPEND COMPILER_SRCS ${CSINN_RELAY_CONTRIB_SRC})
-  file(GLOB CSINN_RUNTIME_SRC src/runtime/hhb/hhb_runtime.cc)
+  file(GLOB CSINN_RUNTIME_SRC src/runtime/hhb/*.cc)
   list(APPEND RUNTIME_SRCS ${CSINN_RUNTIME_SRC})
   file(GLOB CSINN_CONTRIB_SRC src/runtime/contrib/csinn/*.cc)
   #list(APPEND RUNTIME_SRCS ${CSINN_CONTRIB_SRC})
@@ -46,6 +46,15 @@
 namespace tvm {
 using tvm::transform::Pass;
 
+/*!
+ * \brief Get the number of threads the build uses to lower and compile independent functions.
+ *
+ *  It is set by the "tir.num_build_threads" option of the current PassContext, 0 uses all the
+ *  cores. The build is serial when the PassContext has instruments.
+ * \return The number of threads, 1 for a serial build.
+ */
+TVM_DLL int GetNumBuildThreads();
+
 /*!
  * \brief Configures and returns the composite Pass for the fused module (pre split) that contains
  * device and host code.
@@ -47,5 +47,34 @@ TVM_DLL std::string SaveJSON(const runtime::ObjectRef& node);
  */
 TVM_DLL runtime::ObjectRef LoadJSON(std::string json_str);
 
+/*!
+ * \brief save the node as well as all the node it depends on in binary.
+ *  It covers the same objects as SaveJSON, but stores the attributes as typed
+ *  binary values and the NDArrays raw in an aligned section of their own,
+ *  which makes saving and loading large constants much cheaper.
+ *
+ * \return the binary representation of the node.
+ */
+TVM_DLL std::string SaveBinary(const runtime::ObjectRef& node);
+
+/*!
+ * \brief Load tvm Node object from the binary representation of SaveBinary.
+ * \param blob The binary representation.
+ *
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(const std::string& blob);
+
+/*!
+ * \brief Load tvm Node object from a file written with SaveBinary.
+ *  The file is mapped, and the NDArrays of the node are views of the mapping
+ *  rather than copies, so their pages are only read once they are accessed.
+ *  The mapping is read-only, the NDArrays must not be written to.
+ * \param path The path of the file.
+ *
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinaryFile(const std::string& path);
+
 }  // namespace tvm
 #endif  // TVM_NODE_SERIALIZATION_H_
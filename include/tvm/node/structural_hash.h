@@ -27,6 +27,7 @@
 #include <tvm/runtime/data_type.h>
 
 #include <functional>
+#include <memory>
 #include <string>
 
 namespace tvm {
@@ -83,6 +84,48 @@ class StructuralHash : public BaseValueHash {
   TVM_DLL size_t operator()(const ObjectRef& key) const;
 };
 
+/*!
+ * \brief Memoize structural hash values across StructuralHash calls.
+ *
+ *  While a memo is alive, the hash values of the subtrees that do not depend
+ *  on their context, i.e. that contain neither variables nor graph nodes
+ *  (types, attributes, constants, ...), are kept and reused by the later
+ *  StructuralHash calls of the same thread. The memo holds a reference to
+ *  each of these nodes, so CopyOnWrite copies them instead of mutating them
+ *  in place and the memoized values stay valid.
+ *
+ * \code
+ *
+ *  {
+ *    StructuralHashMemo memo;
+ *    for (const CCacheKey& key : keys) {
+ *      cache[key];  // the constants of the functions are hashed once
+ *    }
+ *  }
+ *
+ * \endcode
+ *
+ * \note A memo created while another one is alive on the same thread
+ *  shares it. Objects changed in place without CopyOnWrite, e.g. the
+ *  content of an NDArray, must not be hashed again while the memo lives.
+ */
+class StructuralHashMemo {
+ public:
+  TVM_DLL StructuralHashMemo();
+  TVM_DLL ~StructuralHashMemo();
+  /*! \return The number of memoized nodes. */
+  TVM_DLL size_t size() const;
+  /*! \return The number of hashes found in the memo rather than computed. */
+  TVM_DLL size_t hits() const;
+
+  class Table;
+
+ private:
+  /*! \brief The table of the memo, owned when it is the outermost one. */
+  std::unique_ptr<Table> owned_;
+  Table* table_;
+};
+
 /*!
  * \brief A Reducer class to reduce the structural hash value.
  *
@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/bound_packed_call.h
+ * \brief A PackedFunc call whose arguments are packed once and replayed.
+ */
+#ifndef TVM_RUNTIME_BOUND_PACKED_CALL_H_
+#define TVM_RUNTIME_BOUND_PACKED_CALL_H_
+
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+
+/*!
+ * \brief Get the backend function a PackedFunc of a compiled library calls.
+ * \param func The packed function.
+ * \return The function address, nullptr if func does not wrap one.
+ */
+TVM_DLL TVMBackendPackedCFunc GetBackendPackedCFunc(const PackedFunc& func);
+
+/*!
+ * \brief A call of a PackedFunc with arguments that are packed once and replayed.
+ *
+ *  Executors set the arguments that do not change once, e.g. the DLTensors of an
+ *  operator which are refreshed in place, and only update the others before each
+ *  Run. When the function comes from a compiled library, Run invokes its backend
+ *  function directly rather than going through the PackedFunc.
+ *
+ * \code
+ *
+ *  BoundPackedCall call(module.GetFunction("add"), 3);
+ *  call.Set(0, &a);
+ *  call.Set(1, &b);
+ *  call.Set(2, &c);
+ *  for (int i = 0; i < n; ++i) {
+ *    call.Run();
+ *  }
+ *
+ * \endcode
+ *
+ * \note The call does not keep its arguments alive.
+ */
+class BoundPackedCall {
+ public:
+  BoundPackedCall() = default;
+  /*!
+   * \brief Bind a function.
+   * \param func The function to call.
+   * \param num_args The number of arguments.
+   */
+  explicit BoundPackedCall(PackedFunc func, int num_args = 0)
+      : func_(std::move(func)), faddr_(GetBackendPackedCFunc(func_)) {
+    SetNumArgs(num_args);
+  }
+  /*! \brief Resize the arguments, keeps the ones that are already set. */
+  void SetNumArgs(int num_args) {
+    values_.resize(num_args);
+    type_codes_.resize(num_args, kTVMNullptr);
+  }
+  /*! \return The number of arguments. */
+  int num_args() const { return static_cast<int>(values_.size()); }
+  /*!
+   * \brief Set an argument.
+   * \param i The argument index.
+   * \param value The value, anything a PackedFunc takes.
+   */
+  template <typename T>
+  void Set(int i, T&& value) {
+    TVMArgsSetter(values_.data(), type_codes_.data())(i, std::forward<T>(value));
+  }
+  /*! \return The bound function. */
+  const PackedFunc& func() const { return func_; }
+  /*! \return Whether Run calls the backend function directly. */
+  bool is_direct() const { return faddr_ != nullptr; }
+  /*!
+   * \brief Call the function with the current arguments.
+   * \param rv The return value, can be nullptr to discard it.
+   */
+  void Run(TVMRetValue* rv = nullptr) {
+    if (faddr_ != nullptr) {
+      TVMValue ret_value;
+      int ret_type_code = kTVMNullptr;
+      int ret = (*faddr_)(values_.data(), type_codes_.data(), num_args(), &ret_value,
+                          &ret_type_code, nullptr);
+      ICHECK_EQ(ret, 0) << TVMGetLastError();
+      if (ret_type_code != kTVMNullptr) {
+        TVMRetValue value = TVMRetValue::MoveFromCHost(ret_value, ret_type_code);
+        if (rv != nullptr) *rv = std::move(value);
+      }
+    } else {
+      TVMRetValue value;
+      func_.CallPacked(TVMArgs(values_.data(), type_codes_.data(), num_args()), &value);
+      if (rv != nullptr) *rv = std::move(value);
+    }
+  }
+
+ private:
+  PackedFunc func_;
+  TVMBackendPackedCFunc faddr_{nullptr};
+  std::vector<TVMValue> values_;
+  std::vector<int> type_codes_;
+};
+
+}  // namespace runtime
+}  // namespace tvm
+#endif  // TVM_RUNTIME_BOUND_PACKED_CALL_H_
@@ -64,21 +64,26 @@ class ThreadGroup {
   enum AffinityMode : int {
     kBig = 1,
     kLittle = -1,
+    /*! \brief Bind the workers to the given cpus, one cpu per worker. */
+    kSpecifyOneCorePerThread = -2,
   };
 
   /*!
    * \brief configure the CPU id affinity
    *
-   * \param mode The preferred CPU type (1 = big, -1 = little).
+   * \param mode The preferred CPU type (1 = big, -1 = little, -2 = the given cpus).
    * \param nthreads The number of threads to use (0 = use all).
    * \param exclude_worker0 Whether to use the main thread as a worker.
    *        If  `true`, worker0 will not be launched in a new thread and
    *        `worker_callback` will only be called for values >= 1. This
    *        allows use of the main thread as a worker.
+   * \param cpus The cpu ids of kSpecifyOneCorePerThread, worker i is bound to
+   *        cpus[i] and the main thread may run on any of them.
    *
    * \return The number of workers to use.
    */
-  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0);
+  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0,
+                const std::vector<unsigned int>& cpus = {});
 
  private:
   Impl* impl_;
@@ -97,6 +97,26 @@ class Executable : public ModuleNode {
    */
   static runtime::Module Load(const std::string& code, const runtime::Module lib);
 
+  /*!
+   * \brief Save the constants to a file that can be mapped by LoadConstantsMapped.
+   *
+   *  From then on Save leaves the constant data out of the executable, which only
+   *  keeps the number of constants and their devices.
+   *
+   * \param path The file to write.
+   */
+  void SaveConstantsMapped(const std::string& path);
+
+  /*!
+   * \brief Map the constants saved by SaveConstantsMapped.
+   *
+   *  CPU constants are used where the file is mapped, so their pages are shared by
+   *  every process loading the same file.
+   *
+   * \param path The file to map.
+   */
+  void LoadConstantsMapped(const std::string& path);
+
   /*!
    * \brief Get the serialized form of the `functions`. This is
    * essentially bytecode serialization.
@@ -257,6 +277,8 @@ class Executable : public ModuleNode {
 
   /*! \brief The serialized bytecode. */
   std::string code_;
+  /*! \brief The constant data is saved apart, see SaveConstantsMapped. */
+  bool constants_mapped_{false};
 };
 
 }  // namespace vm
@@ -24,6 +24,7 @@
 #ifndef TVM_RUNTIME_VM_VM_H_
 #define TVM_RUNTIME_VM_VM_H_
 
+#include <tvm/runtime/bound_packed_call.h>
 #include <tvm/runtime/container/closure.h>
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/object.h>
@@ -228,7 +229,8 @@ class VirtualMachine : public runtime::ModuleNode {
    * \brief Invoke a PackedFunction
    *
    * \param packed_index The offset of the PackedFunction in all functions.
-   * \param func The PackedFunction to be invoked.
+   * \param func The PackedFunction to be invoked. When it is packed_funcs_[packed_index]
+   *  itself, the call bound at load time is reused.
    * \param arg_count The number of arguments to the PackedFunction.
    * \param output_size The number of outputs of the PackedFunction.
    * \param args Arguments to the PackedFunction.
@@ -287,6 +289,10 @@ class VirtualMachine : public runtime::ModuleNode {
  protected:
   /*! \brief The virtual machine's packed function table. */
   std::vector<PackedFunc> packed_funcs_;
+  /*! \brief The calls of packed_funcs_, their argument arrays are reused across invocations. */
+  std::vector<BoundPackedCall> packed_calls_;
+  /*! \brief Scratch space of the register values passed to InvokePacked. */
+  std::vector<ObjectRef> packed_args_;
   /*! \brief The current stack of call frames. */
   std::vector<VMFrame> frames_;
   /*! \brief The fuction table index of the current function. */
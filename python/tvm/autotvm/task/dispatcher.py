@@ -34,6 +34,8 @@ import logging
 
 import numpy as np
 
+import tvm._ffi
+
 from .space import FallbackConfigEntity
 from .. import env as _env
 
@@ -347,6 +349,13 @@ DispatchContext.current = FallbackContext()
 DispatchContext.current.silent = True
 
 
+@tvm._ffi.register_func("autotvm.using_tuned_configs")
+def _using_tuned_configs():
+    """Whether the configs of the templates come from tuning, a log or a tuner,
+    rather than from the fallback context."""
+    return not isinstance(DispatchContext.current, FallbackContext)
+
+
 def clear_fallback_cache(target, workload):
     """Clear fallback cache. Pass the same argument as _query_inside to this function
     to clean the cache.
@@ -15,6 +15,8 @@
 # specific language governing permissions and limitations
 # under the License.
 """Minimum graph executor that executes graph containing TVM PackedFunc."""
+from contextlib import contextmanager
+
 import numpy as np
 import tvm._ffi
 
@@ -154,6 +156,8 @@ class GraphModule(object):
         self.module = module
         self._set_input = module["set_input"]
         self._run = module["run"]
+        # looked up on first use, not every executor exports it
+        self._run_from_bytes = None
         self._get_output = module["get_output"]
         self._get_input = module["get_input"]
         self._get_num_outputs = module["get_num_outputs"]
@@ -161,6 +165,7 @@ class GraphModule(object):
         self._get_num_inputs = module["get_num_inputs"]
         self._load_params = module["load_params"]
         self._share_params = module["share_params"]
+        self._output_specs = None
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
@@ -206,6 +211,48 @@ class GraphModule(object):
             self.set_input(**input_dict)
         self._run()
 
+    def run_from_bytes(self, **input_dict):
+        """Set the inputs, run and fetch all outputs in a single call.
+
+        On a remote executor this is one round trip per inference instead of one
+        per input and output copy.
+
+        Parameters
+        ----------
+        input_dict: dict of str to numpy.ndarray
+            The inputs of the graph.
+
+        Returns
+        -------
+        outputs : list of numpy.ndarray
+            The outputs of the graph.
+        """
+        if self._run_from_bytes is None:
+            try:
+                self._run_from_bytes = self.module["run_from_bytes"]
+            except AttributeError as err:
+                raise RuntimeError(
+                    "run_from_bytes is not supported by this graph executor"
+                ) from err
+        if self._output_specs is None:
+            self._output_specs = []
+            for i in range(self.get_num_outputs()):
+                out = self._get_output(i)
+                self._output_specs.append((out.shape, out.dtype))
+        args = []
+        for key, value in input_dict.items():
+            args += [key, bytearray(np.ascontiguousarray(value).tobytes())]
+        blob = self._run_from_bytes(*args)
+        outputs = []
+        offset = 0
+        for shape, dtype in self._output_specs:
+            count = int(np.prod(shape))
+            outputs.append(
+                np.frombuffer(blob, dtype=dtype, count=count, offset=offset).reshape(shape)
+            )
+            offset += count * np.dtype(dtype).itemsize
+        return outputs
+
     def get_num_outputs(self):
         """Get the number of outputs from the graph
 
@@ -298,6 +345,20 @@ class GraphModule(object):
         """
         self._load_params(bytearray(params_bytes))
 
+    def load_params_mapped(self, path):
+        """Load parameters from a file saved by :py:func:`tvm.runtime.save_param_dict_mapped`.
+
+        Parameters on the CPU are used where the file is mapped instead of being
+        copied, so startup does not read the weights and processes loading the same
+        file share their pages.
+
+        Parameters
+        ----------
+        path : str
+            The parameter file.
+        """
+        self.module["load_params_mapped"](path)
+
     def share_params(self, other, params_bytes):
         """Share parameters from pre-existing GraphExecutor instance.
 
@@ -311,6 +372,26 @@ class GraphModule(object):
         """
         self._share_params(other.module, bytearray(params_bytes))
 
+    def config_inter_op_parallel(self, inter_op_threads, intra_op_threads=0):
+        """Run the independent operators of the graph concurrently.
+
+        Only graphs running on the CPU are supported. The same can be set for every
+        executor with the TVM_GRAPH_EXECUTOR_INTER_OP_THREADS and
+        TVM_GRAPH_EXECUTOR_INTRA_OP_THREADS environment variables.
+
+        Parameters
+        ----------
+        inter_op_threads : int
+            The number of threads running operators, 1 runs them one by one on the
+            calling thread.
+
+        intra_op_threads : int
+            The number of threads each of those threads runs a parallel operator with,
+            bound to cores no other of those threads uses. 0 splits the cores evenly
+            among them.
+        """
+        self.module["config_inter_op_parallel"](inter_op_threads, intra_op_threads)
+
     def __getitem__(self, key):
         """Get internal module function
 
@@ -407,3 +488,100 @@ class GraphModule(object):
         return self.module.time_evaluator(
             func_name, device, repeat=repeat, number=number, min_repeat_ms=min_repeat_ms
         )()
+
+
+class GraphModulePool(object):
+    """A pool of graph executors of one compiled graph, for multi-threaded serving.
+
+    The executors share the parameters and the compiled library, each of them owns
+    its activation storage. An executor is used by one thread at a time.
+
+    Parameters
+    ----------
+    module : tvm.runtime.Module
+        The internal tvm module that holds the executors, returned by the
+        ``create_pool`` function of a compiled library.
+
+    Examples
+    --------
+
+    .. code-block:: python
+
+        lib = relay.build(...)
+        pool = graph_executor.GraphModulePool(lib["create_pool"](4, dev))
+        # from any thread
+        outputs = pool.run(x=data)
+        # or drive one executor directly
+        with pool.instance() as gmod:
+            gmod.run(x=data)
+            out = gmod.get_output(0).numpy()
+    """
+
+    def __init__(self, module):
+        self.module = module
+        self._acquire = module["acquire"]
+        self._release = module["release"]
+        self._run_from_inputs = module["run_from_inputs"]
+        self._get_num_instances = module["get_num_instances"]
+
+    def get_num_instances(self):
+        """Get the number of executors in the pool
+
+        Returns
+        -------
+        count : int
+            The number of executors.
+        """
+        return self._get_num_instances()
+
+    def acquire(self):
+        """Take an idle executor, waits while all of them are in use
+
+        Returns
+        -------
+        gmod : GraphModule
+            The executor, to be given back with release.
+        """
+        return GraphModule(self._acquire())
+
+    def release(self, gmod):
+        """Give an executor back to the pool
+
+        Parameters
+        ----------
+        gmod : GraphModule
+            An executor returned by acquire.
+        """
+        self._release(gmod.module)
+
+    @contextmanager
+    def instance(self):
+        """Use an executor for the duration of a with block."""
+        gmod = self.acquire()
+        try:
+            yield gmod
+        finally:
+            self.release(gmod)
+
+    def run(self, device=None, **input_dict):
+        """Run the graph on an idle executor and get its outputs
+
+        Parameters
+        ----------
+        device : Device
+            The device the outputs are copied to, the CPU by default.
+
+        input_dict: dict of str to NDArray
+            The input values.
+
+        Returns
+        -------
+        outputs : list of NDArray
+            The outputs of the graph.
+        """
+        device = device or tvm.cpu(0)
+        args = [device.device_type, device.device_id]
+        for key, value in input_dict.items():
+            args.append(key)
+            args.append(value if isinstance(value, tvm.nd.NDArray) else tvm.nd.array(value))
+        return list(self._run_from_inputs(*args))
@@ -51,6 +51,9 @@ def create(libmod, origin_mod, ctx, output_dir="."):
     lib_path = os.path.join(output_dir, "quant.so")
     kwargs = {}
     kwargs["options"] = ["-O2", "-g", "-I" + include_path]
+    # the concurrent layer groups emitted with parallel_layer_threads > 1 need OpenMP
+    if _uses_openmp(libmod):
+        kwargs["options"].append("-fopenmp")
     libmod.export_hhb_library(lib_path, fcompile=False, output_dir=output_dir, **kwargs)
     lib = tvm.runtime.load_module(lib_path)
 
@@ -61,6 +64,14 @@ def create(libmod, origin_mod, ctx, output_dir="."):
     return mod
 
 
+def _uses_openmp(libmod):
+    """Whether the generated C code of the module runs layers in OpenMP sections."""
+    for mod in libmod._collect_dso_modules():
+        if mod.type_key == "c" and "#pragma omp parallel sections" in mod.get_source():
+            return True
+    return False
+
+
 def get_device_ctx(libmod, ctx):
     """Parse and validate all the device context(s).
 
@@ -126,52 +137,94 @@ class HHBModule(object):
 
     def __init__(self, module, omod):
         self.module = module
+        self._omod = omod
         self._run = module["run"]
         self._get_output = module["get_output"]
         self._set_output = module["set_output"]
         self._get_input = module["get_input"]
         self._set_input = module["set_input"]
+        self._get_input_index = module["get_input_index"]
+        self._get_input_dtype = module["get_input_dtype"]
+        self._set_input_zero_copy = module["set_input_zero_copy"]
+        self._set_output_zero_copy = module["set_output_zero_copy"]
         self._set_params = module["set_params"]
+        self._create_session = module["create_session"]
+        self._run_batch = module["run_batch"]
 
         if isinstance(omod, dict):
-            for idx, shape in enumerate(omod["output_shape_list"]):
-                output = np.array(np.zeros(shape, dtype=omod["output_dtype_list"][idx])) + idx
-                self.set_output(output)
+            if "input_name_list" in omod:
+                module["set_input_names"](omod["input_name_list"])
+            self._output_shapes = [list(shape) for shape in omod["output_shape_list"]]
+            self._output_dtypes = list(omod["output_dtype_list"])
+            for idx, shape in enumerate(self._output_shapes):
+                output = np.array(np.zeros(shape, dtype=self._output_dtypes[idx])) + idx
+                self.set_output(output, idx)
             self._output = omod["output_shape_list"]
         else:
             func = omod["main"]
             self._output = func.ret_type
+            module["set_input_names"]([p.name_hint for p in func.params])
 
             # if type(func.ret_type) == tvm.ir.type.TupleType:
             if isinstance(func.ret_type, tvm.ir.type.TupleType):
-                shapes = [[y.value for y in x.shape] for x in func.ret_type.fields]
-                for i, shape in enumerate(shapes):
-                    output = np.array(np.zeros(shape, dtype=func.ret_type.fields[i].dtype)) + i
-                    self.set_output(output)
+                fields = func.ret_type.fields
             else:
-                shape = [x.value for x in func.ret_type.shape]
-                output = np.array(np.zeros(shape, dtype=func.ret_type.dtype))
-                self.set_output(output)
+                fields = [func.ret_type]
+            self._output_shapes = [[y.value for y in x.shape] for x in fields]
+            self._output_dtypes = [x.dtype for x in fields]
+            for i, shape in enumerate(self._output_shapes):
+                output = np.array(np.zeros(shape, dtype=self._output_dtypes[i])) + i
+                self.set_output(output, i)
 
-    def set_params(self, params_path):
-        """Set inputs to the module via kwargs
+    def create_session(self):
+        """Create an independent session sharing the loaded library and params.
+
+        Each session owns its own input and output bindings, so several
+        sessions can run concurrently from different threads.
+
+        Returns
+        -------
+        session : HHBModule
+            The new session.
+        """
+        return HHBModule(self._create_session(), self._omod)
+
+    def set_params(self, params_path, use_mmap=False):
+        """Load the constant params of the module
 
         Parameters
         ----------
-        key : int or str
-           The input key
+        params_path : str
+           The path of the params file.
+
+        use_mmap : bool
+           Map the params file read-only into memory instead of reading it into
+           a private buffer. Pages are loaded lazily and shared through the page
+           cache by every process and session using the same file. The CRC32 of
+           the uncompressed entries of an indexed file is not checked then.
+        """
+        self._set_params(params_path, use_mmap)
 
-        value : the input value.
-           The input key
+    def get_param(self, name):
+        """Get the raw bytes of one constant of an indexed params file
 
-        params : dict of str to NDArray
-           Additional arguments
+        Parameters
+        ----------
+        name : str
+           The tensor name recorded in the params index.
+
+        Returns
+        -------
+        data : NDArray
+            A uint8 copy of the entry.
         """
-        self._set_params(params_path)
+        return self.module["get_param"](name)
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
 
+        The inputs stay bound across runs until they are replaced.
+
         Parameters
         ----------
         key : int or str
@@ -181,29 +234,75 @@ class HHBModule(object):
            The input key
 
         params : dict of str to NDArray
-           Additional arguments
+           Additional arguments, bound by input name. The names are known when the
+           module is created from a Relay module, or from the input_name_list of a
+           dict.
+
+        Arrays that are not NDArrays are converted to the dtype the model reports
+        for the input, or kept as they are if it reports none.
         """
-        if key:
-            self._set_input(value)
+        if key is not None:
+            self._set_input(key, self._input_array(key, value))
         if params:
             for k in list(params.keys()):
-                self._set_input(tvm.runtime.ndarray.array(params[k].astype(np.float32)))
-
-    def set_output(self, ref):
-        """Set inputs to the module via kwargs
+                if self._get_input_index(k) < 0:
+                    raise ValueError(
+                        "Unknown input %s, bind inputs by index if the module was "
+                        "created without input names" % k
+                    )
+                self._set_input(k, self._input_array(k, params[k]))
+
+    def _input_array(self, key, value):
+        if isinstance(value, tvm.runtime.NDArray):
+            return value
+        dtype = self._get_input_dtype(key)
+        if dtype:
+            value = np.asarray(value).astype(dtype, copy=False)
+        return tvm.runtime.ndarray.array(value)
+
+    def set_input_zero_copy(self, key, value):
+        """Bind an input to a caller owned NDArray without copying it.
 
         Parameters
         ----------
         key : int or str
            The input key
 
-        value : the input value.
-           The input key
+        value : NDArray
+           The input buffer, which must stay alive while it is bound.
+        """
+        self._set_input_zero_copy(key, value)
 
-        params : dict of str to NDArray
-           Additional arguments
+    def set_output(self, ref, index=None):
+        """Bind an output buffer of the module
+
+        Parameters
+        ----------
+        ref : numpy.ndarray or NDArray
+           The output buffer.
+
+        index : int or str, optional
+           The output key, append to the bound outputs if not given.
+        """
+        if not isinstance(ref, tvm.runtime.NDArray):
+            ref = tvm.runtime.ndarray.array(ref)
+        if index is None:
+            self._set_output(ref)
+        else:
+            self._set_output(index, ref)
+
+    def set_output_zero_copy(self, index, ref):
+        """Bind an output to a caller owned NDArray without copying it.
+
+        Parameters
+        ----------
+        index : int or str
+           The output key
+
+        ref : NDArray
+           The output buffer, which must stay alive while it is bound.
         """
-        self._set_output(tvm.runtime.ndarray.array(ref))
+        self._set_output_zero_copy(index, ref)
 
     def run(self, **input_dict):
         """Run forward execution of the graph
@@ -211,12 +310,62 @@ class HHBModule(object):
         Parameters
         ----------
         input_dict: dict of str to NDArray
-            List of input values to be feed to
+            List of input values to be feed to, by input name, see set_input.
         """
         if input_dict:
             self.set_input(**input_dict)
         self._run()
 
+    def run_batch(self, inputs, batch, outputs=None):
+        """Run a batch of samples over a model compiled for a single sample.
+
+        The samples are split over worker sessions sharing the loaded params
+        and run concurrently on the runtime thread pool. The bindings of this
+        session are left untouched.
+
+        Parameters
+        ----------
+        inputs : list of numpy.ndarray or NDArray
+            The batched inputs, samples stacked along the first axis.
+
+        batch : int
+            The number of samples.
+
+        outputs : list of NDArray, optional
+            The batched output buffers, samples stacked along the first axis.
+            Allocated from the model output shapes if not given.
+
+        Returns
+        -------
+        outputs : list of NDArray
+            The batched outputs, the given output buffers if any.
+        """
+        inputs = [
+            x if isinstance(x, tvm.runtime.NDArray) else tvm.runtime.ndarray.array(x)
+            for x in inputs
+        ]
+        if outputs is None:
+            outputs = []
+            for shape, dtype in zip(self._output_shapes, self._output_dtypes):
+                shape = list(shape)
+                shape[0] *= batch
+                outputs.append(tvm.runtime.ndarray.empty(shape, dtype))
+        self._run_batch(inputs, outputs, batch)
+        return outputs
+
+    def profile(self):
+        """Run the model once and time every layer.
+
+        The model must be generated with the csinn option layer_profile=True.
+
+        Returns
+        -------
+        report : tvm.runtime.profiling.Report
+            The duration, bytes read and bytes written of every layer, with the
+            total time and arena size as device metrics.
+        """
+        return self.module["profile"]()
+
     def get_num_outputs(self):
         """Get the number of outputs from the graph
 
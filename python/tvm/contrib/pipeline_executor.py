@@ -94,6 +94,62 @@ class PipelineModule(object):
             self.module = module
         # Get the packed functions from the pipeline executor.
         self._get_num_outputs = self.module["get_num_outputs"]
+        self._run = self.module["run"]
+        self._get_output = self.module["get_output"]
+        self._get_num_pending = self.module["get_num_pending"]
+        self._get_statistics = self.module["get_statistics"]
+
+    def run(self, **inputs):
+        """Feed one request to the pipeline.
+
+        The call returns as soon as the first modules accepted the request, every module
+        works on its own thread, so requests can be fed while earlier ones are still
+        running. It only blocks when the first modules are saturated.
+
+        Parameters
+        ----------
+        inputs : Dict[str, Union[numpy.ndarray, NDArray]]
+            The pipeline inputs, keyed by the pipeline input name. They are copied, the
+            arrays can be reused for the next request.
+
+        Returns
+        -------
+        request_id : int
+            The sequence number of the request.
+        """
+        data = {}
+        for name, value in inputs.items():
+            if not isinstance(value, tvm.nd.NDArray):
+                value = tvm.nd.array(value)
+            data[name] = value
+        return self._run(data)
+
+    def get_output(self):
+        """Get the outputs of the oldest request, waiting for it to finish if needed.
+        Requests finish in the order they were fed.
+
+        Returns
+        -------
+        outputs : List[NDArray]
+            The pipeline outputs.
+        """
+        return list(self._get_output())
+
+    @property
+    def num_pending(self):
+        """The number of requests fed but whose outputs are not fetched yet."""
+        return self._get_num_pending()
+
+    def get_statistics(self):
+        """Get the occupancy of every module since the pipeline was created.
+
+        Returns
+        -------
+        report : tvm.runtime.profiling.Report
+            One row per module with its busy time, occupancy, request count and the
+            time it waited for input.
+        """
+        return self._get_statistics()
 
     @property
     def num_outputs(self):
@@ -492,7 +548,17 @@ class PipelineConfig(object):
                 output["dependencies"] = dep_conf
                 output_conf.append(output)
 
+            # Generate the pipeline inputs this module reads.
+            input_conf = []
+            for global_name, binding in self.input_bindings.bindings.items():
+                for dep in binding.bindings:
+                    if dep.io_owner == module:
+                        input_conf.append(
+                            {"global_input_name": global_name, "input_name": dep.name}
+                        )
+
             mconf["mod_idx"] = module.idx
+            mconf["input"] = input_conf
             mconf["output"] = output_conf
 
             mconfig[mod] = {
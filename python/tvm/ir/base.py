@@ -157,6 +157,62 @@ def save_json(node):
     return tvm.runtime._ffi_node_api.SaveJSON(node)
 
 
+def load_binary(blob):
+    """Load tvm object saved by save_binary.
+
+    Parameters
+    ----------
+    blob : bytes or bytearray
+        The binary representation.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinary(blob)
+
+
+def load_binary_file(path):
+    """Load tvm object from a file holding the output of save_binary.
+
+    The file is mapped and the arrays of the object are views into the
+    mapping, so large constants are neither read nor copied up front. The
+    mapping is read-only, the arrays must not be written to.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinaryFile(path)
+
+
+def save_binary(node):
+    """Save tvm object in a binary format.
+
+    It covers the same objects as save_json, but the arrays are stored
+    raw rather than base64 encoded, which makes it much faster for IR
+    with large constants.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    blob : bytearray
+        The binary representation.
+    """
+    return tvm.runtime._ffi_node_api.SaveBinary(node)
+
+
 def structural_equal(lhs, rhs, map_free_vars=False):
     """Check structural equality of lhs and rhs.
 
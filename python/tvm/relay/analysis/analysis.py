@@ -23,6 +23,7 @@ configuring the passes and scripting them in Python.
 
 from ...ir import IRModule
 from ...relay import transform, build_module
+from ...runtime import ndarray
 from ...runtime.ndarray import cpu
 from ...target import Target
 
@@ -441,3 +442,86 @@ def get_calibration_data(mod, data):
         calib_data[gvar] = value
 
     return calib_data
+
+
+def get_calibration_stats(
+    mod, dataset, num_bins=2049, num_quantized_bins=255, num_workers=4, batch_size=None
+):
+    """Get the calibration statistics of a given relay graph over a dataset
+
+    Unlike :py:func:`get_calibration_data`, the values of the tensors are not kept.
+    The calibration module is built once and the dataset is read in batches. The
+    samples of a batch are run on a pool of `num_workers` executors in parallel and every run
+    is folded into running min/max and histograms as soon as it is done, so the
+    memory use grows with the batch size, not with the size of the dataset.
+
+    Parameters
+    ----------
+    mod : tvm.IRModule
+        The input module for collecting the calibration statistics
+
+    dataset : Iterable[Dict[str, NDArray]]
+        The samples (or batches) to run the module on
+
+    num_bins : int
+        The number of histogram bins of each tensor, must be odd
+
+    num_quantized_bins : int
+        The number of quantized levels the KL threshold is searched for
+
+    num_workers : int
+        The number of threads running samples, each with its own executor
+
+    batch_size : Optional[int]
+        The number of samples read from the dataset at a time, 16 per worker by default
+
+    Returns
+    -------
+    stats : Dict[tvm.relay.GlobalVar, Dict[str, List[Dict[str, float]]]]
+        The `min`, `max` and `threshold` of every input and output of each function.
+    """
+    # pylint: disable=import-outside-toplevel
+    from ...contrib import graph_executor
+
+    output_map = _ffi_api.get_calibrate_output_map(mod)
+
+    mod = _ffi_api.get_calibrate_module(mod)
+    mod = transform.Inline()(mod)
+    lib = build_module.build(mod, target="llvm")
+    pool = graph_executor.GraphModulePool(lib["create_pool"](num_workers, cpu(0)))
+    batch_size = batch_size or 16 * num_workers
+
+    with pool.instance() as runtime:
+        num_outputs = runtime.get_num_outputs()
+    collector = _ffi_api.CalibrationStats(num_outputs, num_bins)
+    batch = []
+    for data in dataset:
+        batch.append({k: ndarray.array(v) for k, v in data.items()})
+        if len(batch) == batch_size:
+            _ffi_api.CalibrationStatsRun(collector, pool.module, batch)
+            batch = []
+    if batch:
+        _ffi_api.CalibrationStatsRun(collector, pool.module, batch)
+
+    min_max = _ffi_api.CalibrationStatsMinMax(collector)
+    thresholds = _ffi_api.CalibrationStatsKL(collector, num_quantized_bins)
+    tensors = [
+        {
+            "min": min_max[i][0].value,
+            "max": min_max[i][1].value,
+            "threshold": thresholds[i].value,
+        }
+        for i in range(num_outputs)
+    ]
+
+    calib_stats = {}
+    for gvar, indices in output_map.items():
+        offset = int(indices[0])
+        in_len = int(indices[1])
+        out_len = int(indices[2])
+        calib_stats[gvar] = {
+            "inputs": tensors[offset : offset + in_len],
+            "outputs": tensors[offset + in_len : offset + in_len + out_len],
+        }
+
+    return calib_stats
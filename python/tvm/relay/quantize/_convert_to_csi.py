@@ -1918,6 +1918,35 @@ def _get_csi_op(name):
     return csi_op().all_handle[name]
 
 
+class ConsumerCounter(relay.ExprVisitor):
+    """Count the expressions reading each expression, keyed by hash."""
+
+    def __init__(self):
+        super(ConsumerCounter, self).__init__()
+        self.consumers = dict()
+
+    def add(self, args):
+        for arg in args:
+            self.consumers[hash(arg)] = self.consumers.get(hash(arg), 0) + 1
+
+    def visit_function(self, fn):
+        # the function output is read by the caller
+        self.add([fn.body])
+        super().visit_function(fn)
+
+    def visit_call(self, call):
+        self.add(call.args)
+        super().visit_call(call)
+
+    def visit_tuple(self, tup):
+        self.add(tup.fields)
+        super().visit_tuple(tup)
+
+    def visit_tuple_getitem(self, t):
+        self.add([t.tuple_value])
+        super().visit_tuple_getitem(t)
+
+
 def fuse_layer(mod):
     """remove unnecessary layer to speed up module.
 
@@ -2000,47 +2029,53 @@ def fuse_layer(mod):
             return Call(call.op, op_args, call.attrs)
 
     class FuseConvReluMutator(relay.ExprMutator):
-        """ Fuse relu layer helper class """
+        """ Fuse conv2d + (bias) + relu/relu6/clip into one conv2d_relu(6) layer """
 
-        def visit_call(self, call):
-            op_args = [self.visit(arg) for arg in call.args]
+        def __init__(self):
+            super(FuseConvReluMutator, self).__init__()
+            self.consumers = dict()
 
-            if call.op.name == "qnn.csi.relu":
-                pre_call = op_args[0]
-                if isinstance(pre_call, Call) and pre_call.op.name == "qnn.csi.conv2d":
-                    new_attrs = _qnn_attrs(pre_call.attrs)
-                    data = pre_call.args[0]
-                    weight = pre_call.args[1]
-                    bias = pre_call.args[2]
-                    new_attrs["q_params"][-1] = call.attrs.q_params[-1]
-                    new_call = relay.qnn.op.csi_conv2d_relu(data, weight, bias, **new_attrs)
-                    return new_call
+        def visit_function(self, fn):
+            # a nested function counts its own consumers, the outer ones apply again after it
+            outer = self.consumers
+            counter = ConsumerCounter()
+            counter.visit(fn)
+            self.consumers = counter.consumers
+            new_fn = super().visit_function(fn)
+            self.consumers = outer
+            return new_fn
+
+        def fuse(self, call, pre_call, fused_op):
+            """Take the conv2d inputs and the output quantization of the activation"""
+            new_attrs = _qnn_attrs(pre_call.attrs)
+            data = pre_call.args[0]
+            weight = pre_call.args[1]
+            bias = pre_call.args[2]
+            new_attrs["q_params"][-1] = call.attrs.q_params[-1]
+            return fused_op(data, weight, bias, **new_attrs)
 
-            # elif pre_call.op.name == "qnn.csi.dense":
-            #     data = pre_call.args[0]
-            #     weight = pre_call.args[1]
-            #     bias = pre_call.op_args[2]
-            #     new_attrs['axis'] = 0
-            #     new_attrs['output_scale'] = call.attrs.output_scale
-            #     new_attrs['output_zero_point'] = call.attrs.output_zero_point
-            #     new_call = relay.qnn.op.csi_dense(data, weight, bias, **new_attrs)
-            # elif pre_call.op.name == "qnn.csi.deconv2d":
-            #     data = pre_call.args[0]
-            #     weight = pre_call.args[1]
-            #     bias = pre_call.op_args[2]
-            #     new_attrs['output_scale'] = call.attrs.output_scale
-            #     new_attrs['output_zero_point'] = call.attrs.output_zero_point
-            #     new_call = relay.qnn.op.csi_deconv2d(data, weight, bias, **new_attrs)
-            elif call.op.name == "qnn.csi.relu6":
+        def visit_call(self, call):
+            op_args = [self.visit(arg) for arg in call.args]
+            # the conv output is gone after fusion, other readers would lose it
+            if (
+                op_args
+                and isinstance(call.op, tvm.ir.Op)
+                and isinstance(op_args[0], Call)
+                and isinstance(op_args[0].op, tvm.ir.Op)
+                and op_args[0].op.name == "qnn.csi.conv2d"
+                and self.consumers.get(hash(call.args[0]), 0) == 1
+            ):
                 pre_call = op_args[0]
-                if pre_call.op.name == "qnn.csi.conv2d":
-                    new_attrs = _qnn_attrs(pre_call.attrs)
-                    data = pre_call.args[0]
-                    weight = pre_call.args[1]
-                    bias = pre_call.args[2]
-                    new_attrs["q_params"][-1] = call.attrs.q_params[-1]
-                    new_call = relay.qnn.op.csi_conv2d_relu6(data, weight, bias, **new_attrs)
-                    return new_call
+                if call.op.name == "qnn.csi.relu":
+                    return self.fuse(call, pre_call, relay.qnn.op.csi_conv2d_relu)
+                if call.op.name == "qnn.csi.relu6":
+                    return self.fuse(call, pre_call, relay.qnn.op.csi_conv2d_relu6)
+                if call.op.name == "qnn.csi.clip" and call.attrs.a_min == 0:
+                    # clip(0, 6) is relu6, clip(0, max) left over by frontends is relu
+                    if call.attrs.a_max == 6:
+                        return self.fuse(call, pre_call, relay.qnn.op.csi_conv2d_relu6)
+                    if call.attrs.a_max >= np.finfo(np.float32).max:
+                        return self.fuse(call, pre_call, relay.qnn.op.csi_conv2d_relu)
 
             new_call = Call(call.op, op_args, call.attrs)
 
@@ -16,21 +16,57 @@
 # under the License.
 """RPC client tools"""
 import os
+import queue
 import stat
 import socket
 import struct
+import threading
 import time
+from concurrent.futures import Future
 
 import tvm._ffi
 from tvm.contrib import utils
 from tvm._ffi.base import TVMError
 from tvm.runtime import ndarray as nd
+from tvm.runtime import Object
 
 from . import base
 from . import server
 from . import _ffi_api
 
 
+@tvm._ffi.register_object("rpc.RPCFuture")
+class RPCFuture(Object):
+    """The pending result of :py:meth:`RPCSession.async_call`."""
+
+    def done(self):
+        """Return whether the call has finished."""
+        return bool(_ffi_api.RPCFutureDone(self))
+
+    def result(self, timeout=None):
+        """Wait for the call and return its value, raises the error of a failed call.
+
+        Parameters
+        ----------
+        timeout : float, optional
+            The number of seconds to wait, waits forever by default.
+
+        Returns
+        -------
+        value : object
+            The return value of the remote function.
+        """
+        start = time.time()
+        delay = 1e-4
+        # poll with sleeps rather than block in the FFI, so other Python threads keep running
+        while not self.done():
+            if timeout is not None and time.time() - start > timeout:
+                raise TimeoutError("RPC call did not finish in %s seconds" % timeout)
+            time.sleep(delay)
+            delay = min(delay * 2, 0.01)
+        return _ffi_api.RPCFutureResult(self)
+
+
 class RPCSession(object):
     """RPC Client session module
 
@@ -72,6 +108,30 @@ class RPCSession(object):
         """
         return self._sess.get_function(name)
 
+    def async_call(self, func, *args):
+        """Call a remote function without waiting for it.
+
+        Calls run in order on a worker thread of the session, the session still
+        serves one call at a time. The worker does not hold the Python GIL, so
+        calls on different sessions run concurrently.
+
+        Parameters
+        ----------
+        func : str or PackedFunc
+            The remote function or the name of a remote global function.
+
+        args : list
+            The arguments, they are kept alive until the call is done.
+
+        Returns
+        -------
+        future : RPCFuture
+            The pending result.
+        """
+        if isinstance(func, str):
+            func = self.get_function(func)
+        return _ffi_api.AsyncCall(self._sess, func, *args)
+
     def device(self, dev_type, dev_id=0):
         """Construct a remote device.
 
@@ -92,6 +152,24 @@ class RPCSession(object):
         dev._rpc_sess = self
         return dev
 
+    def set_copy_options(self, max_outstanding=4, compress=False):
+        """Configure how tensors are copied to and from the remote.
+
+        Large copies are split into blocks and up to max_outstanding blocks are
+        sent before the first one is acknowledged, so copies are bound by the
+        bandwidth rather than the latency of the link.
+
+        Parameters
+        ----------
+        max_outstanding : int
+            The maximum number of blocks in flight, 1 waits for every block.
+
+        compress : bool
+            Zero run-length encode the blocks, which pays off on slow links for
+            sparse tensors. Ignored when the remote cannot decode them.
+        """
+        _ffi_api.SessionSetCopyOptions(self._sess, max_outstanding, compress)
+
     def upload(self, data, target=None):
         """Upload file to remote runtime temp folder
 
@@ -418,6 +496,39 @@ class TrackerSession(object):
             "Cannot request %s after %d retry, last_error:%s" % (key, max_retry, str(last_err))
         )
 
+    def request_pool(self, key, num_sessions, priority=1, session_timeout=0, max_retry=5):
+        """Request several sessions of a device from the tracker as a session pool.
+
+        Parameters
+        ----------
+        key : str
+            The type key of the device.
+
+        num_sessions : int
+            The number of sessions, i.e. boards, to request.
+
+        priority : int, optional
+            The priority of the requests.
+
+        session_timeout : float, optional
+            The duration of each session.
+
+        max_retry : int, optional
+            Maximum number of times to retry each request before give up.
+
+        Returns
+        -------
+        pool : SessionPool
+            The pool of the sessions.
+        """
+        sessions = [
+            self.request(
+                key, priority=priority, session_timeout=session_timeout, max_retry=max_retry
+            )
+            for _ in range(num_sessions)
+        ]
+        return SessionPool(sessions)
+
     def request_and_run(self, key, func, priority=1, session_timeout=0, max_retry=2):
         """Request a resource from tracker and run the func.
 
@@ -460,6 +571,97 @@ class TrackerSession(object):
         )
 
 
+class SessionPool(object):
+    """Fan jobs out over several RPC sessions, typically one per board.
+
+    Each session runs one job at a time on its own thread and picks up the next
+    pending job as soon as it is done, so every board is kept busy. Jobs should
+    run their long remote calls with :py:meth:`RPCSession.async_call`, which
+    does not hold the Python GIL while waiting.
+
+    Parameters
+    ----------
+    sessions : list of RPCSession
+        The sessions of the pool.
+
+    Examples
+    --------
+    .. code-block:: python
+
+        pool = SessionPool([rpc.connect(host, port) for host, port in boards])
+
+        def measure(sess, lib_path):
+            sess.async_call("tvm.rpc.server.upload", "net.so", read(lib_path)).result()
+            ...
+
+        costs = pool.map(measure, lib_paths)
+    """
+
+    def __init__(self, sessions):
+        self._sessions = list(sessions)
+        if not self._sessions:
+            raise ValueError("SessionPool needs at least one session")
+        self._jobs = queue.Queue()
+        self._threads = []
+        for sess in self._sessions:
+            thread = threading.Thread(target=self._worker, args=(sess,), daemon=True)
+            thread.start()
+            self._threads.append(thread)
+
+    @property
+    def sessions(self):
+        """The sessions of the pool."""
+        return self._sessions
+
+    def _worker(self, sess):
+        while True:
+            job = self._jobs.get()
+            if job is None:
+                return
+            future, func, args, kwargs = job
+            if not future.set_running_or_notify_cancel():
+                continue
+            try:
+                future.set_result(func(sess, *args, **kwargs))
+            except BaseException as err:  # pylint: disable=broad-except
+                future.set_exception(err)
+
+    def submit(self, func, *args, **kwargs):
+        """Run func(session, *args, **kwargs) on the next idle session.
+
+        Returns
+        -------
+        future : concurrent.futures.Future
+            The pending result of the job.
+        """
+        if self._threads is None:
+            raise RuntimeError("SessionPool is closed")
+        future = Future()
+        self._jobs.put((future, func, args, kwargs))
+        return future
+
+    def map(self, func, iterable):
+        """Run func(session, item) for every item and return the results in order."""
+        futures = [self.submit(func, item) for item in iterable]
+        return [future.result() for future in futures]
+
+    def close(self):
+        """Finish the pending jobs and stop the workers."""
+        if self._threads is None:
+            return
+        for _ in self._threads:
+            self._jobs.put(None)
+        for thread in self._threads:
+            thread.join()
+        self._threads = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, exc_type, exc_value, traceback):
+        self.close()
+
+
 def connect(url, port, key="", session_timeout=0, session_constructor_args=None):
     """Connect to RPC Server
 
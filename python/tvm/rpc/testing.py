@@ -17,6 +17,8 @@
 
 # pylint: disable=invalid-name,unnecessary-comprehension
 """ Testing functions for the RPC server."""
+import time
+
 import numpy as np
 import tvm
 
@@ -27,6 +29,12 @@ def _addone(x):
     return x + 1
 
 
+@tvm.register_func("rpc.test.sleep")
+def _sleep(seconds):
+    time.sleep(seconds)
+    return seconds
+
+
 @tvm.register_func("rpc.test.strcat")
 def _strcat(name, x):
     return "%s:%d" % (name, x)
@@ -67,3 +67,42 @@ def load_param_dict(param_bytes):
     if isinstance(param_bytes, (bytes, str)):
         param_bytes = bytearray(param_bytes)
     return _ffi_api.LoadParams(param_bytes)
+
+
+def save_param_dict_mapped(params, path):
+    """Save parameter dictionary to a file that can be memory mapped.
+
+    The tensors are stored aligned, so that GraphModule's "load_params_mapped"
+    and :py:func:`load_param_dict_mapped` use them where the file is mapped
+    instead of copying them.
+
+    Parameters
+    ----------
+    params : dict of str to NDArray
+        The parameter dictionary.
+
+    path : str
+        The file to write.
+    """
+    transformed = {k: ndarray.array(v) for (k, v) in params.items()}
+    _ffi_api.SaveParamsMapped(path, transformed)
+
+
+def load_param_dict_mapped(path):
+    """Map a parameter file saved by :py:func:`save_param_dict_mapped`.
+
+    The returned arrays point into a private mapping of the file: pages are read
+    on first access, shared with other processes mapping the same file, and
+    copied only when written to.
+
+    Parameters
+    ----------
+    path : str
+        The file to map.
+
+    Returns
+    -------
+    params : dict of str to NDArray
+        The parameter dictionary.
+    """
+    return _ffi_api.LoadParamsMapped(path)
@@ -245,6 +245,42 @@ class Executable(object):
         """
         return self._get_bytecode()
 
+    def save_constants_mapped(self, path):
+        """Save the constants to a file that can be memory mapped.
+
+        Executables saved afterwards leave the constant data out, it has to be
+        loaded with :py:meth:`load_constants_mapped` before running.
+
+        Parameters
+        ----------
+        path : str
+            The file to write.
+
+        Examples
+        --------
+
+        .. code-block:: python
+
+            exec.save_constants_mapped("consts.bin")
+            code, lib = exec.save()
+            # later, possibly in another process
+            exec = tvm.runtime.vm.Executable.load_exec(code, lib)
+            exec.load_constants_mapped("consts.bin")
+        """
+        self.mod["save_constants_mapped"](path)
+
+    def load_constants_mapped(self, path):
+        """Map the constants saved by :py:meth:`save_constants_mapped`.
+
+        CPU constants are used where the file is mapped, without a copy.
+
+        Parameters
+        ----------
+        path : str
+            The file to map.
+        """
+        self.mod["load_constants_mapped"](path)
+
     @property
     def constants(self):
         """Returns a human-readable description of all the constants in the executable.
@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <mutex>
 #include <stack>
+#include <thread>
 
 namespace tvm {
 
@@ -45,6 +46,7 @@ TVM_REGISTER_PASS_CONFIG_OPTION("tir.disable_vectorize", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.is_entry_func", Bool);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.add_lower_pass", Array<Array<ObjectRef>>);
 TVM_REGISTER_PASS_CONFIG_OPTION("tir.debug_keep_trivial_loop", Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.num_build_threads", Integer);
 
 using runtime::PackedFunc;
 using runtime::TVMArgs;
@@ -52,6 +54,19 @@ using runtime::TVMRetValue;
 using tvm::Array;
 using tvm::transform::Pass;
 
+int GetNumBuildThreads() {
+  transform::PassContext pass_ctx = transform::PassContext::Current();
+  // instruments are invoked around every pass and may call back into the frontend.
+  if (!pass_ctx->instruments.empty()) {
+    return 1;
+  }
+  int64_t num_threads = pass_ctx->GetConfig<Integer>("tir.num_build_threads", Integer(1)).value();
+  if (num_threads <= 0) {
+    num_threads = std::thread::hardware_concurrency();
+  }
+  return static_cast<int>(std::max<int64_t>(num_threads, 1));
+}
+
 bool LLVMEnabled() {
   const runtime::PackedFunc* pf = runtime::Registry::Get("target.build.llvm");
   return pf != nullptr;
@@ -28,14 +28,20 @@
 #include <tvm/node/serialization.h>
 #include <tvm/relay/expr.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 
 #include <cctype>
+#include <cstring>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
+#include "../runtime/file_utils.h"
 #include "../runtime/object_internal.h"
 #include "../support/base64.h"
 
@@ -468,6 +474,46 @@ class JSONAttrSetter : public AttrVisitor {
   }
 };
 
+/*!
+ * \brief Order the nodes so that every node comes after the nodes it refers to.
+ * \param nodes The nodes, with the indices they refer to in data and fields.
+ */
+template <typename TNode>
+std::vector<size_t> TopoSortNodes(const std::vector<TNode>& nodes) {
+  size_t n_nodes = nodes.size();
+  std::vector<size_t> topo_order;
+  std::vector<size_t> in_degree(n_nodes, 0);
+  for (const TNode& jnode : nodes) {
+    for (size_t i : jnode.data) {
+      ++in_degree[i];
+    }
+    for (size_t i : jnode.fields) {
+      ++in_degree[i];
+    }
+  }
+  for (size_t i = 0; i < n_nodes; ++i) {
+    if (in_degree[i] == 0) {
+      topo_order.push_back(i);
+    }
+  }
+  for (size_t p = 0; p < topo_order.size(); ++p) {
+    const TNode& jnode = nodes[topo_order[p]];
+    for (size_t i : jnode.data) {
+      if (--in_degree[i] == 0) {
+        topo_order.push_back(i);
+      }
+    }
+    for (size_t i : jnode.fields) {
+      if (--in_degree[i] == 0) {
+        topo_order.push_back(i);
+      }
+    }
+  }
+  ICHECK_EQ(topo_order.size(), n_nodes) << "Cyclic reference detected in serialized graph";
+  std::reverse(std::begin(topo_order), std::end(topo_order));
+  return topo_order;
+}
+
 // json graph structure to store node
 struct JSONGraph {
   // the root of the graph
@@ -527,40 +573,7 @@ struct JSONGraph {
     return g;
   }
 
-  std::vector<size_t> TopoSort() const {
-    size_t n_nodes = nodes.size();
-    std::vector<size_t> topo_order;
-    std::vector<size_t> in_degree(n_nodes, 0);
-    for (const JSONNode& jnode : nodes) {
-      for (size_t i : jnode.data) {
-        ++in_degree[i];
-      }
-      for (size_t i : jnode.fields) {
-        ++in_degree[i];
-      }
-    }
-    for (size_t i = 0; i < n_nodes; ++i) {
-      if (in_degree[i] == 0) {
-        topo_order.push_back(i);
-      }
-    }
-    for (size_t p = 0; p < topo_order.size(); ++p) {
-      const JSONNode& jnode = nodes[topo_order[p]];
-      for (size_t i : jnode.data) {
-        if (--in_degree[i] == 0) {
-          topo_order.push_back(i);
-        }
-      }
-      for (size_t i : jnode.fields) {
-        if (--in_degree[i] == 0) {
-          topo_order.push_back(i);
-        }
-      }
-    }
-    ICHECK_EQ(topo_order.size(), n_nodes) << "Cyclic reference detected in JSON file";
-    std::reverse(std::begin(topo_order), std::end(topo_order));
-    return topo_order;
-  }
+  std::vector<size_t> TopoSort() const { return TopoSortNodes(nodes); }
 };
 
 std::string SaveJSON(const ObjectRef& n) {
@@ -622,7 +635,589 @@ ObjectRef LoadJSON(std::string json_str) {
   return ObjectRef(nodes.at(jgraph.root));
 }
 
+// Binary graph format.
+//
+//   uint64    kTVMIRBinaryMagic
+//   uint64    size of the index
+//   index     tvm version, root, type table, node table, tensor table
+//   padding   up to kBinaryTensorAlign
+//   tensors   each at a kBinaryTensorAlign aligned offset of the section
+//
+// The attributes of an object are typed values, in the order of the field
+// names its type has in the type table, so that loading matches them by name
+// like the json format does. The tensor section is raw data that a mapped
+// file can be read from in place.
+constexpr uint64_t kTVMIRBinaryMagic = 0x314E4252494D5654;  // "TVMIRBN1"
+constexpr uint64_t kBinaryTensorAlign = runtime::kAllocAlignment;
+
+/*! \brief How a node of the binary format is stored. */
+enum BinaryNodeKind : uint8_t {
+  kBinaryNone = 0,
+  kBinaryRepr = 1,
+  kBinaryArray = 2,
+  kBinaryStrMap = 3,
+  kBinaryMap = 4,
+  kBinaryObject = 5,
+};
+
+/*! \brief The type tags of the attribute values. */
+enum BinaryValueTag : uint8_t {
+  kBinaryFloat64 = 0,
+  kBinaryInt64 = 1,
+  kBinaryUInt64 = 2,
+  kBinaryInt = 3,
+  kBinaryBool = 4,
+  kBinaryString = 5,
+  kBinaryDataType = 6,
+  kBinaryNDArray = 7,
+  kBinaryObjectRef = 8,
+};
+
+/*! \brief An attribute value of the binary format. */
+struct BinaryValue {
+  uint8_t tag;
+  union {
+    double v_float64;
+    int64_t v_int64;
+    uint64_t v_uint64;
+  };
+  std::string v_str;
+
+  void Save(dmlc::Stream* strm) const {
+    strm->Write(tag);
+    switch (tag) {
+      case kBinaryFloat64:
+        strm->Write(v_float64);
+        break;
+      case kBinaryString:
+        strm->Write(v_str);
+        break;
+      case kBinaryUInt64:
+      case kBinaryDataType:
+      case kBinaryNDArray:
+      case kBinaryObjectRef:
+        strm->Write(v_uint64);
+        break;
+      default:
+        strm->Write(v_int64);
+    }
+  }
+
+  void Load(dmlc::Stream* strm) {
+    ICHECK(strm->Read(&tag)) << "Invalid binary IR format";
+    bool ok = false;
+    switch (tag) {
+      case kBinaryFloat64:
+        ok = strm->Read(&v_float64);
+        break;
+      case kBinaryString:
+        ok = strm->Read(&v_str);
+        break;
+      case kBinaryUInt64:
+      case kBinaryDataType:
+      case kBinaryNDArray:
+      case kBinaryObjectRef:
+        ok = strm->Read(&v_uint64);
+        break;
+      case kBinaryInt64:
+      case kBinaryInt:
+      case kBinaryBool:
+        ok = strm->Read(&v_int64);
+        break;
+      default:
+        LOG(FATAL) << "Invalid binary IR format: unknown value tag " << static_cast<int>(tag);
+    }
+    ICHECK(ok) << "Invalid binary IR format";
+  }
+};
+
+/*! \brief Node structure for binary format. */
+struct BinaryNode {
+  BinaryNodeKind kind{kBinaryNone};
+  /*! \brief The index of the type in the type table. */
+  uint32_t type{0};
+  /*! \brief The str repr representation. */
+  std::string repr_bytes;
+  /*! \brief keys of a map with string keys. */
+  std::vector<std::string> keys;
+  /*! \brief values of a map or array. */
+  std::vector<uint64_t> data;
+  /*! \brief the attribute values of an object. */
+  std::vector<BinaryValue> values;
+  /*!
+   * \brief field member dependency.
+   * NOTE: This is an auxiliary data structure for loading, and it won't be serialized.
+   */
+  std::vector<uint64_t> fields;
+
+  void Save(dmlc::Stream* strm) const {
+    strm->Write(static_cast<uint8_t>(kind));
+    if (kind == kBinaryNone) return;
+    strm->Write(type);
+    switch (kind) {
+      case kBinaryRepr:
+        strm->Write(repr_bytes);
+        break;
+      case kBinaryStrMap:
+        strm->Write(keys);
+        strm->Write(data);
+        break;
+      case kBinaryArray:
+      case kBinaryMap:
+        strm->Write(data);
+        break;
+      default:
+        strm->Write(static_cast<uint64_t>(values.size()));
+        for (const BinaryValue& value : values) {
+          value.Save(strm);
+        }
+    }
+  }
+
+  /*!
+   * \brief Load the node.
+   * \param strm The stream of the index.
+   * \param size The size of the index, which bounds the number of values.
+   */
+  void Load(dmlc::SeekStream* strm, size_t size) {
+    uint8_t kind_code;
+    ICHECK(strm->Read(&kind_code)) << "Invalid binary IR format";
+    ICHECK_LE(kind_code, kBinaryObject) << "Invalid binary IR format";
+    kind = static_cast<BinaryNodeKind>(kind_code);
+    if (kind == kBinaryNone) return;
+    ICHECK(strm->Read(&type)) << "Invalid binary IR format";
+    bool ok = true;
+    switch (kind) {
+      case kBinaryRepr:
+        ok = strm->Read(&repr_bytes);
+        break;
+      case kBinaryStrMap:
+        ok = strm->Read(&keys) && strm->Read(&data);
+        break;
+      case kBinaryArray:
+      case kBinaryMap:
+        ok = strm->Read(&data);
+        break;
+      default: {
+        uint64_t num_values;
+        ok = strm->Read(&num_values);
+        // every value takes a tag and at least eight bytes
+        ICHECK(ok && num_values <= (size - strm->Tell()) / (1 + sizeof(uint64_t)))
+            << "Invalid binary IR format";
+        values.resize(num_values);
+        for (BinaryValue& value : values) {
+          value.Load(strm);
+          if (value.tag == kBinaryObjectRef) {
+            fields.push_back(value.v_uint64);
+          }
+        }
+      }
+    }
+    ICHECK(ok) << "Invalid binary IR format";
+  }
+};
+
+/*! \brief Tensor entry of the binary format, the data is in the tensor section. */
+struct BinaryTensor {
+  DLDataType dtype;
+  std::vector<int64_t> shape;
+  /*! \brief The offset of the data in the tensor section. */
+  uint64_t offset;
+  uint64_t nbytes;
+
+  void Save(dmlc::Stream* strm) const {
+    strm->Write(dtype);
+    strm->Write(shape);
+    strm->Write(offset);
+    strm->Write(nbytes);
+  }
+
+  bool Load(dmlc::Stream* strm) {
+    return strm->Read(&dtype) && strm->Read(&shape) && strm->Read(&offset) && strm->Read(&nbytes);
+  }
+};
+
+// Helper class to populate the binary node
+// using the existing index.
+class BinaryAttrGetter : public AttrVisitor {
+ public:
+  const std::unordered_map<Object*, size_t>* node_index_;
+  const std::unordered_map<DLTensor*, size_t>* tensor_index_;
+  BinaryNode* node_;
+  /*! \brief The field names of the type, recorded by the first node of the type. */
+  std::vector<std::string>* field_names_;
+  bool record_names_;
+
+  void Visit(const char* key, double* value) final {
+    Push(key, kBinaryFloat64).v_float64 = *value;
+  }
+  void Visit(const char* key, int64_t* value) final { Push(key, kBinaryInt64).v_int64 = *value; }
+  void Visit(const char* key, uint64_t* value) final {
+    Push(key, kBinaryUInt64).v_uint64 = *value;
+  }
+  void Visit(const char* key, int* value) final { Push(key, kBinaryInt).v_int64 = *value; }
+  void Visit(const char* key, bool* value) final { Push(key, kBinaryBool).v_int64 = *value; }
+  void Visit(const char* key, std::string* value) final {
+    Push(key, kBinaryString).v_str = *value;
+  }
+  void Visit(const char* key, void** value) final {
+    LOG(FATAL) << "not allowed to serialize a pointer";
+  }
+  void Visit(const char* key, DataType* value) final {
+    DLDataType t = *value;
+    Push(key, kBinaryDataType).v_uint64 = static_cast<uint64_t>(t.code) |
+                                          (static_cast<uint64_t>(t.bits) << 8) |
+                                          (static_cast<uint64_t>(t.lanes) << 16);
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    Push(key, kBinaryNDArray).v_uint64 =
+        tensor_index_->at(const_cast<DLTensor*>((*value).operator->()));
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    Push(key, kBinaryObjectRef).v_uint64 = node_index_->at(const_cast<Object*>(value->get()));
+  }
+
+ private:
+  BinaryValue& Push(const char* key, BinaryValueTag tag) {
+    if (record_names_) {
+      field_names_->push_back(key);
+    } else {
+      ICHECK_LT(node_->values.size(), field_names_->size());
+      ICHECK_EQ((*field_names_)[node_->values.size()], key);
+    }
+    node_->values.emplace_back();
+    node_->values.back().tag = tag;
+    return node_->values.back();
+  }
+};
+
+// Helper class to set the attributes of a node
+// from given binary node.
+class BinaryAttrSetter : public AttrVisitor {
+ public:
+  const std::vector<ObjectPtr<Object>>* node_list_;
+  const std::vector<runtime::NDArray>* tensor_list_;
+  /*! \brief The position of the fields of the type of the node in its values. */
+  const std::unordered_map<std::string, size_t>* field_pos_;
+  BinaryNode* node_;
+
+  const BinaryValue& GetValue(const char* key, BinaryValueTag tag) const {
+    auto it = field_pos_->find(key);
+    if (it == field_pos_->end() || it->second >= node_->values.size()) {
+      LOG(FATAL) << "BinaryReader: cannot find field " << key;
+    }
+    const BinaryValue& value = node_->values[it->second];
+    ICHECK_EQ(value.tag, tag) << "Wrong value type for field " << key;
+    return value;
+  }
+
+  void Visit(const char* key, double* value) final {
+    *value = GetValue(key, kBinaryFloat64).v_float64;
+  }
+  void Visit(const char* key, int64_t* value) final {
+    *value = GetValue(key, kBinaryInt64).v_int64;
+  }
+  void Visit(const char* key, uint64_t* value) final {
+    *value = GetValue(key, kBinaryUInt64).v_uint64;
+  }
+  void Visit(const char* key, int* value) final {
+    *value = static_cast<int>(GetValue(key, kBinaryInt).v_int64);
+  }
+  void Visit(const char* key, bool* value) final {
+    *value = GetValue(key, kBinaryBool).v_int64 != 0;
+  }
+  void Visit(const char* key, std::string* value) final {
+    *value = GetValue(key, kBinaryString).v_str;
+  }
+  void Visit(const char* key, void** value) final {
+    LOG(FATAL) << "not allowed to deserialize a pointer";
+  }
+  void Visit(const char* key, DataType* value) final {
+    uint64_t v = GetValue(key, kBinaryDataType).v_uint64;
+    DLDataType t;
+    t.code = static_cast<uint8_t>(v & 0xFF);
+    t.bits = static_cast<uint8_t>((v >> 8) & 0xFF);
+    t.lanes = static_cast<uint16_t>((v >> 16) & 0xFFFF);
+    *value = DataType(t);
+  }
+  void Visit(const char* key, runtime::NDArray* value) final {
+    *value = tensor_list_->at(GetValue(key, kBinaryNDArray).v_uint64);
+  }
+  void Visit(const char* key, ObjectRef* value) final {
+    *value = ObjectRef(node_list_->at(GetValue(key, kBinaryObjectRef).v_uint64));
+  }
+  // set node to be current BinaryNode
+  void Set(ObjectPtr<Object>* node, BinaryNode* bnode) {
+    if (node->get() == nullptr || bnode->kind == kBinaryRepr) {
+      return;
+    }
+    if (bnode->kind == kBinaryArray) {
+      std::vector<ObjectRef> container;
+      for (auto index : bnode->data) {
+        container.push_back(ObjectRef(node_list_->at(index)));
+      }
+      Array<ObjectRef> array(container);
+      *node = runtime::ObjectInternal::MoveObjectPtr(&array);
+      return;
+    }
+    if (bnode->kind == kBinaryStrMap || bnode->kind == kBinaryMap) {
+      std::unordered_map<ObjectRef, ObjectRef, ObjectHash, ObjectEqual> container;
+      if (bnode->kind == kBinaryMap) {
+        ICHECK_EQ(bnode->data.size() % 2, 0U);
+        for (size_t i = 0; i < bnode->data.size(); i += 2) {
+          container[ObjectRef(node_list_->at(bnode->data[i]))] =
+              ObjectRef(node_list_->at(bnode->data[i + 1]));
+        }
+      } else {
+        ICHECK_EQ(bnode->data.size(), bnode->keys.size());
+        for (size_t i = 0; i < bnode->data.size(); ++i) {
+          container[String(bnode->keys[i])] = ObjectRef(node_list_->at(bnode->data[i]));
+        }
+      }
+      Map<ObjectRef, ObjectRef> map(container);
+      *node = runtime::ObjectInternal::MoveObjectPtr(&map);
+      return;
+    }
+    node_ = bnode;
+    ReflectionVTable::Global()->VisitAttrs(node->get(), this);
+  }
+};
+
+static uint64_t AlignBinaryOffset(uint64_t offset) {
+  return (offset + kBinaryTensorAlign - 1) / kBinaryTensorAlign * kBinaryTensorAlign;
+}
+
+std::string SaveBinary(const ObjectRef& n) {
+  ReflectionVTable* reflection = ReflectionVTable::Global();
+  NodeIndexer indexer;
+  indexer.MakeIndex(const_cast<Object*>(n.get()));
+
+  std::vector<std::string> type_keys;
+  std::vector<std::vector<std::string>> field_names;
+  std::unordered_map<uint32_t, uint32_t> type_table;
+  std::vector<BinaryNode> nodes(indexer.node_list_.size());
+  BinaryAttrGetter getter;
+  getter.node_index_ = &indexer.node_index_;
+  getter.tensor_index_ = &indexer.tensor_index_;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    Object* node = indexer.node_list_[i];
+    BinaryNode& bnode = nodes[i];
+    if (node == nullptr) continue;
+    auto it = type_table.find(node->type_index());
+    getter.record_names_ = it == type_table.end();
+    if (getter.record_names_) {
+      it = type_table.emplace(node->type_index(), type_keys.size()).first;
+      type_keys.push_back(node->GetTypeKey());
+      field_names.emplace_back();
+    }
+    bnode.type = it->second;
+    if (reflection->GetReprBytes(node, &bnode.repr_bytes)) {
+      bnode.kind = kBinaryRepr;
+    } else if (node->IsInstance<ArrayNode>()) {
+      bnode.kind = kBinaryArray;
+      for (const ObjectRef& item : *static_cast<ArrayNode*>(node)) {
+        bnode.data.push_back(indexer.node_index_.at(const_cast<Object*>(item.get())));
+      }
+    } else if (node->IsInstance<MapNode>()) {
+      MapNode* map = static_cast<MapNode*>(node);
+      bool is_str_map = std::all_of(map->begin(), map->end(), [](const auto& v) {
+        return v.first->template IsInstance<StringObj>();
+      });
+      bnode.kind = is_str_map ? kBinaryStrMap : kBinaryMap;
+      for (const auto& kv : *map) {
+        if (is_str_map) {
+          bnode.keys.push_back(Downcast<String>(kv.first));
+        } else {
+          bnode.data.push_back(indexer.node_index_.at(const_cast<Object*>(kv.first.get())));
+        }
+        bnode.data.push_back(indexer.node_index_.at(const_cast<Object*>(kv.second.get())));
+      }
+    } else {
+      bnode.kind = kBinaryObject;
+      getter.node_ = &bnode;
+      getter.field_names_ = &field_names[bnode.type];
+      reflection->VisitAttrs(node, &getter);
+      ICHECK_EQ(bnode.values.size(), getter.field_names_->size());
+    }
+  }
+
+  std::vector<BinaryTensor> tensors;
+  uint64_t section_size = 0;
+  for (DLTensor* tensor : indexer.tensor_list_) {
+    BinaryTensor entry;
+    entry.dtype = tensor->dtype;
+    entry.shape.assign(tensor->shape, tensor->shape + tensor->ndim);
+    entry.offset = section_size;
+    entry.nbytes = runtime::GetDataSize(*tensor);
+    section_size = AlignBinaryOffset(section_size + entry.nbytes);
+    tensors.push_back(std::move(entry));
+  }
+
+  std::string index;
+  {
+    dmlc::MemoryStringStream strm(&index);
+    strm.Write(std::string(TVM_VERSION));
+    strm.Write(static_cast<uint64_t>(indexer.node_index_.at(const_cast<Object*>(n.get()))));
+    strm.Write(type_keys);
+    strm.Write(field_names);
+    strm.Write(static_cast<uint64_t>(nodes.size()));
+    for (const BinaryNode& bnode : nodes) {
+      bnode.Save(&strm);
+    }
+    strm.Write(static_cast<uint64_t>(tensors.size()));
+    for (const BinaryTensor& entry : tensors) {
+      entry.Save(&strm);
+    }
+  }
+
+  uint64_t section_begin = AlignBinaryOffset(2 * sizeof(uint64_t) + index.size());
+  std::string blob;
+  blob.reserve(section_begin + section_size);
+  {
+    dmlc::MemoryStringStream strm(&blob);
+    strm.Write(kTVMIRBinaryMagic);
+    strm.Write(static_cast<uint64_t>(index.size()));
+  }
+  blob += index;
+  blob.resize(section_begin + section_size, '\0');
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    DLTensor* tensor = indexer.tensor_list_[i];
+    const BinaryTensor& entry = tensors[i];
+    char* dst = &blob[section_begin + entry.offset];
+    ICHECK_EQ(TVMArrayCopyToBytes(tensor, dst, entry.nbytes), 0) << TVMGetLastError();
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      size_t elem_bytes = (tensor->dtype.bits + 7) / 8;
+      dmlc::ByteSwap(dst, elem_bytes, entry.nbytes / elem_bytes);
+    }
+  }
+  return blob;
+}
+
+// Load the binary format from size bytes at data. The arrays are views into
+// the mapping when it is given, copies otherwise.
+static ObjectRef LoadBinary(const char* data, size_t size, const std::shared_ptr<char>& mapping) {
+  ReflectionVTable* reflection = ReflectionVTable::Global();
+  uint64_t magic = 0, index_size = 0;
+  {
+    dmlc::MemoryFixedSizeStream strm(const_cast<char*>(data), size);
+    ICHECK(strm.Read(&magic) && magic == kTVMIRBinaryMagic) << "Invalid binary IR format";
+    ICHECK(strm.Read(&index_size)) << "Invalid binary IR format";
+  }
+  uint64_t index_begin = 2 * sizeof(uint64_t);
+  ICHECK_LE(index_size, size - index_begin) << "Truncated binary IR";
+  uint64_t section_begin = AlignBinaryOffset(index_begin + index_size);
+
+  std::string version;
+  uint64_t root, n_nodes, n_tensors;
+  std::vector<std::string> type_keys;
+  std::vector<std::vector<std::string>> field_names;
+  std::vector<BinaryNode> bnodes;
+  std::vector<runtime::NDArray> tensors;
+  {
+    dmlc::MemoryFixedSizeStream strm(const_cast<char*>(data) + index_begin, index_size);
+    ICHECK(strm.Read(&version) && strm.Read(&root) && strm.Read(&type_keys) &&
+           strm.Read(&field_names) && strm.Read(&n_nodes))
+        << "Invalid binary IR format";
+    ICHECK_EQ(type_keys.size(), field_names.size()) << "Invalid binary IR format";
+    // every node takes at least its kind
+    ICHECK_LE(n_nodes, index_size - strm.Tell()) << "Invalid binary IR format";
+    bnodes.resize(n_nodes);
+    for (BinaryNode& bnode : bnodes) {
+      bnode.Load(&strm, index_size);
+      if (bnode.kind != kBinaryNone) {
+        ICHECK_LT(bnode.type, type_keys.size()) << "Invalid binary IR format";
+      }
+      for (uint64_t i : bnode.data) {
+        ICHECK_LT(i, n_nodes) << "Invalid binary IR format";
+      }
+      for (uint64_t i : bnode.fields) {
+        ICHECK_LT(i, n_nodes) << "Invalid binary IR format";
+      }
+    }
+    ICHECK_LT(root, n_nodes) << "Invalid binary IR format";
+    ICHECK(strm.Read(&n_tensors)) << "Invalid binary IR format";
+    for (uint64_t i = 0; i < n_tensors; ++i) {
+      BinaryTensor entry;
+      ICHECK(entry.Load(&strm)) << "Invalid binary IR format";
+      ICHECK(section_begin <= size && entry.offset <= size - section_begin &&
+             entry.nbytes <= size - section_begin - entry.offset)
+          << "Truncated binary IR";
+      if (mapping != nullptr && DMLC_IO_NO_ENDIAN_SWAP) {
+        runtime::NDArray tensor = runtime::MappedNDArray(
+            mapping, size, section_begin + entry.offset, entry.shape, entry.dtype);
+        ICHECK_EQ(runtime::GetDataSize(*tensor.operator->()), entry.nbytes)
+            << "Invalid binary IR format";
+        tensors.emplace_back(std::move(tensor));
+        continue;
+      }
+      runtime::NDArray tensor =
+          runtime::NDArray::Empty(runtime::ShapeTuple(entry.shape), entry.dtype, {kDLCPU, 0});
+      ICHECK_EQ(runtime::GetDataSize(*tensor.operator->()), entry.nbytes)
+          << "Invalid binary IR format";
+      std::memcpy(tensor->data, data + section_begin + entry.offset, entry.nbytes);
+      if (!DMLC_IO_NO_ENDIAN_SWAP) {
+        size_t elem_bytes = (entry.dtype.bits + 7) / 8;
+        dmlc::ByteSwap(tensor->data, elem_bytes, entry.nbytes / elem_bytes);
+      }
+      tensors.emplace_back(std::move(tensor));
+    }
+  }
+  // Pass 1: create all non-container objects
+  std::vector<ObjectPtr<Object>> nodes(n_nodes, nullptr);
+  for (size_t i = 0; i < n_nodes; ++i) {
+    if (bnodes[i].kind != kBinaryNone) {
+      nodes[i] = reflection->CreateInitObject(type_keys[bnodes[i].type], bnodes[i].repr_bytes);
+    }
+  }
+  // Pass 2: topo sort, the field dependency is found while loading
+  std::vector<size_t> topo_order = TopoSortNodes(bnodes);
+  // Pass 3: set all values
+  {
+    std::vector<std::unordered_map<std::string, size_t>> field_pos(field_names.size());
+    for (size_t t = 0; t < field_names.size(); ++t) {
+      for (size_t i = 0; i < field_names[t].size(); ++i) {
+        field_pos[t][field_names[t][i]] = i;
+      }
+    }
+    BinaryAttrSetter setter;
+    setter.node_list_ = &nodes;
+    setter.tensor_list_ = &tensors;
+    for (size_t i : topo_order) {
+      if (bnodes[i].kind == kBinaryNone) continue;
+      setter.field_pos_ = &field_pos[bnodes[i].type];
+      setter.Set(&nodes[i], &bnodes[i]);
+    }
+  }
+  return ObjectRef(nodes.at(root));
+}
+
+ObjectRef LoadBinary(const std::string& blob) {
+  return LoadBinary(blob.data(), blob.size(), nullptr);
+}
+
+ObjectRef LoadBinaryFile(const std::string& path) {
+  size_t size = 0;
+  std::shared_ptr<char> mapping = runtime::MapFile(path, &size);
+  return LoadBinary(mapping.get(), size, mapping);
+}
+
 TVM_REGISTER_GLOBAL("node.SaveJSON").set_body_typed(SaveJSON);
 
 TVM_REGISTER_GLOBAL("node.LoadJSON").set_body_typed(LoadJSON);
+
+TVM_REGISTER_GLOBAL("node.SaveBinary").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string blob = SaveBinary(args[0]);
+  TVMByteArray arr;
+  arr.data = blob.data();
+  arr.size = blob.size();
+  *rv = arr;
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinary").set_body_typed([](std::string blob) {
+  return LoadBinary(blob);
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinaryFile").set_body_typed([](std::string path) {
+  return LoadBinaryFile(path);
+});
 }  // namespace tvm
@@ -45,6 +45,36 @@ void ReflectionVTable::SHashReduce(const Object* self, SHashReducer reducer) con
   fshash_reduce_[tindex](self, reducer);
 }
 
+class StructuralHashMemo::Table {
+ public:
+  std::unordered_map<ObjectRef, size_t, ObjectPtrHash, ObjectPtrEqual> hashes;
+  size_t hits{0};
+  /*! \return The memo of the current thread, nullptr if there is none. */
+  static Table*& Current() {
+    static thread_local Table* current = nullptr;
+    return current;
+  }
+};
+
+StructuralHashMemo::StructuralHashMemo() {
+  table_ = Table::Current();
+  if (table_ == nullptr) {
+    owned_.reset(new Table());
+    table_ = owned_.get();
+    Table::Current() = table_;
+  }
+}
+
+StructuralHashMemo::~StructuralHashMemo() {
+  if (owned_ != nullptr) {
+    Table::Current() = nullptr;
+  }
+}
+
+size_t StructuralHashMemo::size() const { return table_->hashes.size(); }
+
+size_t StructuralHashMemo::hits() const { return table_->hits; }
+
 // Hash handler that handles free vars
 // by assigning an unique counter in the order of their ocurrence.
 //
@@ -72,21 +102,40 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     bool graph_node_hash{false};
     /*! \brief whether to map the free variables. */
     bool map_free_vars;
+    /*!
+     * \brief Whether the hash depends on where the object is visited,
+     *  i.e. on the free var and graph node counters.
+     */
+    bool context_dependent{false};
 
     Task() = default;
-    explicit Task(ObjectRef object, size_t reduced_hash, bool map_free_vars)
-        : object(object), reduced_hash(reduced_hash), map_free_vars(map_free_vars) {}
+    explicit Task(ObjectRef object, size_t reduced_hash, bool map_free_vars,
+                  bool context_dependent = false)
+        : object(object),
+          reduced_hash(reduced_hash),
+          map_free_vars(map_free_vars),
+          context_dependent(context_dependent) {}
+  };
+  /*! \brief The hash value of a finished task. */
+  struct Result {
+    size_t hash;
+    bool context_dependent;
   };
 
-  VarCountingSHashHandler() {}
+  VarCountingSHashHandler() : memo_(StructuralHashMemo::Table::Current()) {}
 
   void MarkGraphNode() final {
     // need to push to pending tasks in this case
     ICHECK(!allow_push_to_stack_ && !task_stack_.empty());
     task_stack_.back().graph_node_hash = true;
+    task_stack_.back().context_dependent = true;
   }
 
   bool LookupHashedValue(const ObjectRef& key, size_t* hash_value) final {
+    // the result depends on what has been visited so far.
+    if (!task_stack_.empty()) {
+      task_stack_.back().context_dependent = true;
+    }
     auto it = hash_memo_.find(key);
     if (it != hash_memo_.end()) {
       hash_value[0] = it->second;
@@ -104,11 +153,11 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     if (map_free_vars) {
       // use counter value.
       size_t value = std::hash<size_t>()(free_var_counter_++);
-      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), value, false));
+      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), value, false, true));
     } else {
       // use pointer hash
       size_t value = std::hash<const runtime::Object*>()(var);
-      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), value, false));
+      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), value, false, true));
     }
   }
 
@@ -120,9 +169,18 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
       pending_tasks_.emplace_back(Task(ObjectRef(nullptr), 0, false));
       return;
     }
+    if (memo_ != nullptr) {
+      auto it = memo_->hashes.find(object);
+      if (it != memo_->hashes.end()) {
+        memo_->hits++;
+        pending_tasks_.emplace_back(Task(ObjectRef(nullptr), it->second, false));
+        return;
+      }
+    }
     auto it = hash_memo_.find(object);
     if (it != hash_memo_.end()) {
-      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), it->second, false));
+      // context free objects are found in the memo above.
+      pending_tasks_.emplace_back(Task(ObjectRef(nullptr), it->second, false, true));
     } else {
       // Push a pending task with initial value.
       pending_tasks_.emplace_back(Task(object, object->GetTypeKeyHash(), map_free_vars));
@@ -143,7 +201,7 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
     this->RunTasks();
 
     ICHECK_EQ(result_stack_.size(), 1U);
-    size_t ret = result_stack_.back();
+    size_t ret = result_stack_.back().hash;
     result_stack_.pop_back();
     return ret;
   }
@@ -154,21 +212,22 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
    */
   void PopTaskStack() {
     const auto& entry = task_stack_.back();
-    result_stack_.push_back(entry.reduced_hash);
+    result_stack_.push_back(Result{entry.reduced_hash, entry.context_dependent});
     task_stack_.pop_back();
   }
   /*!
    * \brief Compute the reduced hash value for the task.
-   * \param task The indicated task.
+   * \param task The indicated task, marked context dependent if any of its children is.
    */
-  size_t ReduceHash(const Task& task) {
-    size_t stack_begin = task.result_stack_index;
+  size_t ReduceHash(Task* task) {
+    size_t stack_begin = task->result_stack_index;
     ICHECK_LE(stack_begin, result_stack_.size());
 
     // combine in the reverse order of the stack.
-    size_t reduced_hash = task.reduced_hash;
+    size_t reduced_hash = task->reduced_hash;
     for (size_t i = result_stack_.size(); i != stack_begin; --i) {
-      reduced_hash = support::HashCombine(reduced_hash, result_stack_[i - 1]);
+      reduced_hash = support::HashCombine(reduced_hash, result_stack_[i - 1].hash);
+      task->context_dependent |= result_stack_[i - 1].context_dependent;
     }
     result_stack_.resize(stack_begin);
     return reduced_hash;
@@ -180,7 +239,7 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
       auto& entry = task_stack_.back();
       if (entry.children_expanded) {
         // reduce hash
-        entry.reduced_hash = ReduceHash(entry);
+        entry.reduced_hash = ReduceHash(&entry);
         // When all the children has expanded and visited.
         // entry.reduced_hash contains the reduced hash result.
         auto it = hash_memo_.find(entry.object);
@@ -195,6 +254,9 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
                                                       std::hash<size_t>()(graph_node_counter_++));
           }
           hash_memo_[entry.object] = entry.reduced_hash;
+          if (memo_ != nullptr && !entry.context_dependent) {
+            memo_->hashes[entry.object] = entry.reduced_hash;
+          }
         }
         // send value to parent.
         this->PopTaskStack();
@@ -206,6 +268,7 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
         auto it = hash_memo_.find(entry.object);
         if (it != hash_memo_.end()) {
           entry.reduced_hash = it->second;
+          entry.context_dependent = memo_ == nullptr || !memo_->hashes.count(entry.object);
           this->PopTaskStack();
         } else {
           // NOTE: important to modify entry before visit.
@@ -246,11 +309,13 @@ class VarCountingSHashHandler : public SHashReducer::Handler {
   // Internal task stack to executed the task
   std::vector<Task> task_stack_;
   // Internal stack to store the result poped from the task stack.
-  std::vector<size_t> result_stack_;
+  std::vector<Result> result_stack_;
   // reflection vtable
   ReflectionVTable* vtable_ = ReflectionVTable::Global();
   // map from lhs to rhs
   std::unordered_map<ObjectRef, size_t, ObjectPtrHash, ObjectPtrEqual> hash_memo_;
+  // the memo shared across calls, nullptr if not enabled.
+  StructuralHashMemo::Table* memo_;
 };
 
 TVM_REGISTER_GLOBAL("node.StructuralHash")
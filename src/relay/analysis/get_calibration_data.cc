@@ -25,11 +25,26 @@
  * the tensor values (GetCalibrateModule). Second, we need to
  * generate the mapping between the values and the functions
  * (GetCalibrateOutputMap).
+ *
+ * For large datasets the values are not kept: CalibrationStats
+ * folds the outputs of every run into running statistics instead,
+ * and runs batches of samples on an executor pool in parallel.
  */
 
 #include <tvm/relay/analysis.h>
 #include <tvm/relay/expr.h>
 #include <tvm/relay/expr_functor.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/support/parallel_for.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "../quantize/quantize.h"
 
 namespace tvm {
 namespace relay {
@@ -191,6 +206,232 @@ Map<GlobalVar, Array<Integer>> GetCalibrateOutputMap(const IRModule& module) {
   return output_map;
 }
 
+/*!
+ * \brief Running statistics of one calibration tensor: min, max and a
+ *  histogram symmetric around zero whose range grows with the data.
+ */
+struct TensorStats {
+  double min{std::numeric_limits<double>::infinity()};
+  double max{-std::numeric_limits<double>::infinity()};
+  /*! \brief The histogram covers [-range, range], 0 until the first non zero value. */
+  double range{0};
+  std::vector<int64_t> hist;
+
+  /*!
+   * \brief Widen the histogram to cover [-new_range, new_range].
+   *
+   *  The range grows by an odd integer factor, so every old bin falls into
+   *  exactly one new bin and the counts stay exact.
+   */
+  void Grow(double new_range) {
+    int num_bins = hist.size();
+    int zero = num_bins / 2;
+    int64_t factor = static_cast<int64_t>(std::ceil(new_range / range));
+    if (factor % 2 == 0) factor++;
+    std::vector<int64_t> merged(num_bins, 0);
+    int64_t half = factor / 2;
+    for (int i = 0; i < num_bins; i++) {
+      int64_t offset = i - zero;
+      // floor division, offsets in [-half, half] land in the zero bin
+      int64_t shifted = offset + half;
+      int64_t bin = shifted >= 0 ? shifted / factor : -((-shifted + factor - 1) / factor);
+      merged[zero + bin] += hist[i];
+    }
+    hist.swap(merged);
+    range *= factor;
+  }
+
+  template <typename T>
+  void Update(const T* data, int64_t size) {
+    double lo = min, hi = max, abs_max = 0;
+    for (int64_t i = 0; i < size; i++) {
+      double v = static_cast<double>(data[i]);
+      lo = std::min(lo, v);
+      hi = std::max(hi, v);
+      if (std::isfinite(v)) abs_max = std::max(abs_max, std::abs(v));
+    }
+    min = lo;
+    max = hi;
+    if (abs_max > 0 && range == 0) {
+      range = abs_max;
+    } else if (abs_max > range) {
+      Grow(abs_max);
+    }
+    int num_bins = hist.size();
+    if (range == 0) {
+      hist[num_bins / 2] += size;
+      return;
+    }
+    double scale = num_bins / (2 * range);
+    for (int64_t i = 0; i < size; i++) {
+      double v = static_cast<double>(data[i]);
+      // inf and nan do not fit a histogram
+      if (!std::isfinite(v)) continue;
+      int bin = static_cast<int>((v + range) * scale);
+      hist[std::min(std::max(bin, 0), num_bins - 1)]++;
+    }
+  }
+};
+
+class CalibrationStatsNode : public Object {
+ public:
+  int num_bins;
+  std::vector<TensorStats> stats;
+
+  void VisitAttrs(AttrVisitor* v) { v->Visit("num_bins", &num_bins); }
+
+  /*!
+   * \brief Fold one run of the calibration module into the statistics.
+   * \param outputs The outputs of the run, one per tensor.
+   */
+  void Update(const Array<runtime::NDArray>& outputs) {
+    ICHECK_EQ(outputs.size(), stats.size()) << "Expect one output per calibration tensor";
+    // tensors are independent, each worker owns whole tensors
+    support::parallel_for(0, stats.size(), [&](int i) { UpdateTensor(i, outputs[i]); });
+  }
+
+  /*!
+   * \brief Run a batch of samples and fold every run into the statistics.
+   * \param pool The executor pool of the calibration module, one worker thread per executor.
+   * \param batch The inputs of each sample.
+   */
+  void Run(const runtime::Module& pool, const Array<Map<String, runtime::NDArray>>& batch) {
+    runtime::PackedFunc acquire = pool.GetFunction("acquire");
+    runtime::PackedFunc release = pool.GetFunction("release");
+    int num_instances = pool.GetFunction("get_num_instances")();
+    int num_workers = std::min<int>(num_instances, batch.size());
+    support::parallel_for_dynamic(0, batch.size(), num_workers, [&](int, int task_id) {
+      runtime::Module executor = acquire();
+      runtime::PackedFunc set_input = executor.GetFunction("set_input");
+      runtime::PackedFunc get_output = executor.GetFunction("get_output");
+      for (const auto& kv : batch[task_id]) {
+        set_input(kv.first, kv.second);
+      }
+      executor.GetFunction("run")();
+      // the outputs live in the executor, fold them before it is handed out again
+      for (size_t i = 0; i < stats.size(); i++) {
+        runtime::NDArray output = get_output(static_cast<int>(i));
+        std::lock_guard<std::mutex> lock(locks[i]);
+        UpdateTensor(i, output);
+      }
+      release(executor);
+    });
+  }
+
+  /*! \return The threshold of tensor i minimizing the KL divergence. */
+  double KLThreshold(int i, int num_quantized_bins) const {
+    const TensorStats& s = stats[i];
+    if (s.range == 0) {
+      return 0;
+    }
+    // MinimizeKL counts in int, rescale huge histograms into range
+    int64_t total = 0;
+    for (auto c : s.hist) total += c;
+    int64_t div = total / std::numeric_limits<int>::max() + 1;
+    std::vector<int> hist(num_bins);
+    std::vector<float> edges(num_bins + 1);
+    for (int j = 0; j < num_bins; j++) {
+      hist[j] = static_cast<int>(s.hist[j] / div);
+    }
+    for (int j = 0; j <= num_bins; j++) {
+      edges[j] = -s.range + 2 * s.range * j / num_bins;
+    }
+    return quantize::MinimizeKL(hist, edges, num_bins, num_quantized_bins);
+  }
+
+  /*! \brief Guards stats[i] when runs are folded concurrently. */
+  std::vector<std::mutex> locks;
+
+  static constexpr const char* _type_key = "relay.analysis.CalibrationStats";
+  TVM_DECLARE_FINAL_OBJECT_INFO(CalibrationStatsNode, Object);
+
+ private:
+  void UpdateTensor(int i, const runtime::NDArray& output) {
+    const DLTensor* t = output.operator->();
+    ICHECK_EQ(t->device.device_type, kDLCPU) << "Calibration outputs must be on the CPU";
+    int64_t size = runtime::GetDataSize(*t) / ((t->dtype.bits * t->dtype.lanes + 7) / 8);
+    const char* data = static_cast<const char*>(t->data) + t->byte_offset;
+    DLDataType dt = t->dtype;
+    if (dt.code == kDLFloat && dt.bits == 32) {
+      stats[i].Update(reinterpret_cast<const float*>(data), size);
+    } else if (dt.code == kDLFloat && dt.bits == 64) {
+      stats[i].Update(reinterpret_cast<const double*>(data), size);
+    } else if (dt.code == kDLInt && dt.bits == 32) {
+      stats[i].Update(reinterpret_cast<const int32_t*>(data), size);
+    } else if (dt.code == kDLInt && dt.bits == 64) {
+      stats[i].Update(reinterpret_cast<const int64_t*>(data), size);
+    } else if (dt.code == kDLInt && dt.bits == 8) {
+      stats[i].Update(reinterpret_cast<const int8_t*>(data), size);
+    } else if (dt.code == kDLUInt && dt.bits == 8) {
+      stats[i].Update(reinterpret_cast<const uint8_t*>(data), size);
+    } else {
+      LOG(FATAL) << "Unsupported calibration dtype " << runtime::DLDataType2String(dt);
+    }
+  }
+};
+
+class CalibrationStats : public ObjectRef {
+ public:
+  CalibrationStats(int num_tensors, int num_bins) {
+    ICHECK(num_bins > 0 && num_bins % 2 == 1) << "num_bins must be odd to have a zero bin";
+    auto n = make_object<CalibrationStatsNode>();
+    n->num_bins = num_bins;
+    n->stats.resize(num_tensors);
+    n->locks = std::vector<std::mutex>(num_tensors);
+    for (auto& s : n->stats) {
+      s.hist.resize(num_bins, 0);
+    }
+    data_ = std::move(n);
+  }
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(CalibrationStats, ObjectRef, CalibrationStatsNode);
+};
+
+TVM_REGISTER_NODE_TYPE(CalibrationStatsNode);
+
+TVM_REGISTER_GLOBAL("relay.analysis.CalibrationStats")
+    .set_body_typed([](int num_tensors, int num_bins) {
+      return CalibrationStats(num_tensors, num_bins);
+    });
+
+TVM_REGISTER_GLOBAL("relay.analysis.CalibrationStatsUpdate")
+    .set_body_typed([](CalibrationStats stats, Array<runtime::NDArray> outputs) {
+      stats->Update(outputs);
+    });
+
+TVM_REGISTER_GLOBAL("relay.analysis.CalibrationStatsRun")
+    .set_body_typed([](CalibrationStats stats, runtime::Module pool,
+                       Array<Map<String, runtime::NDArray>> batch) { stats->Run(pool, batch); });
+
+TVM_REGISTER_GLOBAL("relay.analysis.CalibrationStatsMinMax")
+    .set_body_typed([](CalibrationStats stats) {
+      Array<Array<FloatImm>> ret;
+      for (const auto& s : stats->stats) {
+        ret.push_back({FloatImm(DataType::Float(64), s.min), FloatImm(DataType::Float(64), s.max)});
+      }
+      return ret;
+    });
+
+TVM_REGISTER_GLOBAL("relay.analysis.CalibrationStatsKL")
+    .set_body_typed([](CalibrationStats stats, int num_quantized_bins) {
+      std::vector<double> thresholds(stats->stats.size());
+      support::parallel_for(0, stats->stats.size(), [&](int i) {
+        thresholds[i] = stats->KLThreshold(i, num_quantized_bins);
+      });
+      Array<FloatImm> ret;
+      for (auto t : thresholds) {
+        ret.push_back(FloatImm(DataType::Float(64), t));
+      }
+      return ret;
+    });
+
+TVM_REGISTER_GLOBAL("relay.analysis.CalibrationStatsHistogram")
+    .set_body_typed([](CalibrationStats stats, int index) {
+      const TensorStats& s = stats->stats.at(index);
+      auto hist = runtime::NDArray::Empty({stats->num_bins}, DataType::Int(64), {kDLCPU, 0});
+      hist.CopyFromBytes(s.hist.data(), s.hist.size() * sizeof(int64_t));
+      return Array<ObjectRef>({hist, FloatImm(DataType::Float(64), s.range)});
+    });
+
 TVM_REGISTER_GLOBAL("relay.analysis.get_calibrate_module").set_body_typed([](IRModule mod) {
   return GetCalibrateModule(mod);
 });
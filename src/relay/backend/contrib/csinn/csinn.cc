@@ -24,6 +24,7 @@
 
 #include "csinn.h"
 
+#include "../../../../runtime/hhb/hhb_params.h"
 #include "anole.h"
 #include "ch8601.h"
 #include "dp1k.h"
@@ -106,7 +107,7 @@ void CodegenCSINN::VisitExpr_(const TupleNode* op) {
         PushDeclLine(buf);
         buf << const_out_name << "->data = params_base + " << to_string(constant_offset);
         PushDeclLine(buf);
-        constant_offset += const_out.size;
+        AdvanceConstantOffset(const_out.size);
         SetDim(const_out_name, const_shape);
 
         buf_decl_.push_back(buf.str());
@@ -166,6 +167,9 @@ void CodegenCSINN::VisitExpr_(const CallNode* call) {
     output.call = call;
     output_list_.push_back(output);
   }
+  // the layers emitted from here on belong to this call, until its arguments are visited
+  const CallNode* parent_call = current_call_;
+  current_call_ = call;
   if (IsOp(call, "qnn.csi.abs")) {
     Unary(call, "abs");
   } else if (IsOp(call, "qnn.csi.acos")) {
@@ -382,6 +386,7 @@ void CodegenCSINN::VisitExpr_(const CallNode* call) {
   } else {
     LOG(FATAL) << "Unsupported op: " << AsText(call->op, false);
   }
+  current_call_ = parent_call;
 }
 
 string CodegenCSINN::replace(string a) {
@@ -1011,7 +1016,9 @@ void CodegenCSINN::CreateConstantTensorBase(string name, size_t size, std::vecto
   // if (shape.size() == 0) shape.push_back(1);
   t0 << name << "->layout = " << layout;
   PushDeclLine(t0);
-  constant_offset += size;
+  AdvanceConstantOffset(size);
+  tensor_bytes_[name] = size;
+  pending_io_[current_call_].reads.push_back(name);
 
   SetDim(name, shape);
 }
@@ -1053,7 +1060,7 @@ void CodegenCSINN::CreateConstantTensor(CSIConstant* data, string name, std::vec
     PushDeclLine(t0);
     t0 << name << "->quant_channel = " << double_to_string(quant_params.q_size);
     PushDeclLine(t0);
-    constant_offset += quant_params.q_size * sizeof(Qinfo);
+    AdvanceConstantOffset(quant_params.q_size * sizeof(Qinfo));
     quant_params.name = name;
     qinfo_list_.push_back(quant_params);
     flag_list_.push_back(QINFO);
@@ -1096,7 +1103,7 @@ void CodegenCSINN::CreateConstantTensor(CSIConstant* data, string name, std::vec
     PushDeclLine(t0);
     t0 << name << "->quant_channel = " << double_to_string(bias_quant_params.q_size);
     PushDeclLine(t0);
-    constant_offset += bias_quant_params.q_size * sizeof(Qinfo);
+    AdvanceConstantOffset(bias_quant_params.q_size * sizeof(Qinfo));
     bias_quant_params.name = name;
     qinfo_list_.push_back(bias_quant_params);
     flag_list_.push_back(QINFO);
@@ -1109,6 +1116,17 @@ void CodegenCSINN::CreateTensor(string name, string data, std::vector<int> shape
   t0 << "struct csi_tensor *" << name << " = csi_alloc_tensor(sess)";
   PushDeclLine(t0);
   tensor_data[name] = data;
+  size_t bytes = 1;
+  for (auto dim : shape) {
+    bytes *= dim;
+  }
+  if (dtype == "int32_t" || dtype == "float") {
+    bytes *= 4;
+  } else if (dtype == "float16" || dtype == "bfloat16" || dtype == "int16_t") {
+    bytes *= 2;
+  }
+  tensor_bytes_[name] = bytes;
+  pending_io_[current_call_].writes.push_back(name);
   t0 << name << "->name = "
      << "\"" << name << "\"";
   PushDeclLine(t0);
@@ -1122,7 +1140,8 @@ void CodegenCSINN::CreateTensor(string name, string data, std::vector<int> shape
   PushDeclLine(t0);
   t0 << name << "->quant_channel = " << to_string(quant_params.q_size);
   PushDeclLine(t0);
-  constant_offset += quant_params.q_size * sizeof(Qinfo);
+  AdvanceConstantOffset(quant_params.q_size * sizeof(Qinfo));
+  quant_params.name = name;
   qinfo_list_.push_back(quant_params);
   flag_list_.push_back(QINFO);
 }
@@ -1227,6 +1246,7 @@ string CodegenCSINN::InputTensorName(const CallNode* call, int input_index,
     CHECK(pre_call);
     input_name = InputTensorTupleItem(pre_call, quant_params, dtype);
   }
+  pending_io_[current_call_].reads.push_back(input_name);
   return input_name;
 }
 
@@ -1251,8 +1271,9 @@ void CodegenCSINN::params_common_setup(std::ostringstream& decl, const CallNode*
     t0 << params_name << "->base.layout = CSINN_LAYOUT_" << layout_;
     PushDeclLine(t0);
   }
+  last_layer_name_ = get_complete_layer_name(op_name, layer_name);
   t0 << params_name << "->base.name = "
-     << "\"" << get_complete_layer_name(op_name, layer_name) << "\"";
+     << "\"" << last_layer_name_ << "\"";
   params_idx_++;
   PushDeclLine(t0);
   setup_callback(decl, op_name, params_name);
@@ -1297,74 +1318,140 @@ string CodegenCSINN::DataConvertTensor(std::vector<int> shape, QuantParams quant
   return output_name;
 }
 
+void CodegenCSINN::DumpIndexedConstant() {
+  runtime::hhb::ParamsWriter writer(params_alignment_);
+  bool params_compress = params_compress_;
+  if (params_compress && !runtime::hhb::ParamsCompressionEnabled()) {
+    LOG(WARNING) << "params_compress needs TVM built with USE_CSINN_ZLIB, ignored.";
+    params_compress = false;
+  }
+  // the same constant may be stored more than once, the copies are numbered
+  std::unordered_map<string, int> name_count;
+  auto entry_name = [&name_count](const string& name) {
+    CHECK(!name.empty()) << "params entry without a name";
+    int count = name_count[name]++;
+    return count == 0 ? name : name + "#" + to_string(count);
+  };
+  int q_count = 0;
+  int c_count = 0;
+  size_t offset = 0;
+  CHECK(flag_list_.size() == qinfo_list_.size() + constant_list_.size());
+  for (uint i = 0; i < flag_list_.size(); i++) {
+    size_t size = 0;
+    if (flag_list_[i] == QINFO) {
+      QuantParams& q = qinfo_list_[q_count];
+      size = q.q_size * sizeof(Qinfo);
+      writer.Add(entry_name(q.name + ".qinfo"), runtime::hhb::kParamsQinfo, "qinfo", offset,
+                 q.qinfo, size, false);
+      q_count++;
+    } else if (flag_list_[i] == CONSTANT) {
+      CSIConstant& c = constant_list_[c_count];
+      size = c.size;
+      // only the low bit weights are worth deflating, float data barely shrinks
+      bool compress = params_compress &&
+                      (c.dtype == "int8_t" || c.dtype == "uint8_t" || c.dtype == "int4_t");
+      writer.Add(entry_name(c.name), runtime::hhb::kParamsConstant, c.dtype, offset, c.data_buf,
+                 size, compress);
+      c_count++;
+    }
+    offset = (offset + size + params_alignment_ - 1) & ~(params_alignment_ - 1);
+  }
+  CHECK_EQ(offset, constant_offset) << "params layout does not match the emitted offsets";
+  writer.Save(params_path_, constant_offset);
+}
+
 void CodegenCSINN::DumpConstant() {
+  if (params_format_ == "indexed") {
+    DumpIndexedConstant();
+  } else {
+    if (params_compress_) {
+      LOG(WARNING) << "params_compress needs the indexed params format, ignored.";
+    }
+    DumpRawConstant();
+  }
+  if (debug_level_ == "INFO") {
+    DumpDebugConstant();
+  }
+}
+
+void CodegenCSINN::DumpRawConstant() {
   std::ofstream params;
   params.open(params_path_, std::ios::out | std::ios::binary);
   int q_count = 0;
   int c_count = 0;
+  size_t offset = 0;
+  std::vector<char> padding(params_alignment_, 0);
   CHECK(flag_list_.size() == qinfo_list_.size() + constant_list_.size());
   for (uint i = 0; i < flag_list_.size(); i++) {
+    size_t size = 0;
     if (flag_list_[i] == QINFO) {
-      params.write(reinterpret_cast<char*>(qinfo_list_[q_count].qinfo),
-                   qinfo_list_[q_count].q_size * sizeof(Qinfo));
+      size = qinfo_list_[q_count].q_size * sizeof(Qinfo);
+      params.write(reinterpret_cast<char*>(qinfo_list_[q_count].qinfo), size);
       q_count++;
     } else if (flag_list_[i] == CONSTANT) {
-      params.write(reinterpret_cast<char*>(constant_list_[c_count].data_buf),
-                   constant_list_[c_count].size);
+      size = constant_list_[c_count].size;
+      params.write(reinterpret_cast<char*>(constant_list_[c_count].data_buf), size);
       c_count++;
     }
+    // pad to the same boundary AdvanceConstantOffset used for the emitted offsets
+    offset += size;
+    size_t pad = (params_alignment_ - offset % params_alignment_) % params_alignment_;
+    params.write(padding.data(), pad);
+    offset += pad;
   }
+  CHECK_EQ(offset, constant_offset) << "params layout does not match the emitted offsets";
   params.close();
-  if (debug_level_ == "INFO") {
-    std::ofstream qinfo_file;
-    std::ofstream const_file;
-    qinfo_file.open("./hhb_debug_qinfo.h", std::ios::out);
-    const_file.open("./hhb_debug_const.h", std::ios::out);
-    int q_count = 0;
-    int c_count = 0;
-    CHECK(flag_list_.size() == qinfo_list_.size() + constant_list_.size());
-    for (uint i = 0; i < flag_list_.size(); i++) {
-      if (flag_list_[i] == QINFO) {
-        qinfo_file << "qinfo " << qinfo_list_[q_count].name << " = {\n";
-        qinfo_file << "// size: " << qinfo_list_[q_count].q_size << "\n";
-        struct Qinfo* qinfo = qinfo_list_[q_count].qinfo;
-        for (int i = 0; i < qinfo_list_[q_count].q_size; i++) {
-          qinfo_file << "zero_point = " << qinfo[i].zero_point << ", ";
-          qinfo_file << "scale = " << qinfo[i].scale << ", ";
-          qinfo_file << "multiplier = " << qinfo[i].multiplier << ", ";
-          qinfo_file << "shift = " << qinfo[i].shift << ", ";
-          qinfo_file << "min = " << qinfo[i].min << ", ";
-          qinfo_file << "max = " << qinfo[i].max << "\n";
-        }
-        qinfo_file << "}\n";
-        q_count++;
-      } else if (flag_list_[i] == CONSTANT) {
-        const_file << "constant data " << constant_list_[c_count].name << " = {\n";
-
-        if (constant_list_[c_count].dtype == "float") {
-          float* data_buf = static_cast<float*>(constant_list_[c_count].data_buf);
-          for (uint i = 0; i < constant_list_[c_count].size / 4; i++) {
-            const_file << data_buf[i] << ", ";
-            if (i % 16 == 15) {
-              const_file << "\n";
-            }
+}
+
+void CodegenCSINN::DumpDebugConstant() {
+  std::ofstream qinfo_file;
+  std::ofstream const_file;
+  qinfo_file.open("./hhb_debug_qinfo.h", std::ios::out);
+  const_file.open("./hhb_debug_const.h", std::ios::out);
+  int q_count = 0;
+  int c_count = 0;
+  CHECK(flag_list_.size() == qinfo_list_.size() + constant_list_.size());
+  for (uint i = 0; i < flag_list_.size(); i++) {
+    if (flag_list_[i] == QINFO) {
+      qinfo_file << "qinfo " << qinfo_list_[q_count].name << " = {\n";
+      qinfo_file << "// size: " << qinfo_list_[q_count].q_size << "\n";
+      struct Qinfo* qinfo = qinfo_list_[q_count].qinfo;
+      for (int i = 0; i < qinfo_list_[q_count].q_size; i++) {
+        qinfo_file << "zero_point = " << qinfo[i].zero_point << ", ";
+        qinfo_file << "scale = " << qinfo[i].scale << ", ";
+        qinfo_file << "multiplier = " << qinfo[i].multiplier << ", ";
+        qinfo_file << "shift = " << qinfo[i].shift << ", ";
+        qinfo_file << "min = " << qinfo[i].min << ", ";
+        qinfo_file << "max = " << qinfo[i].max << "\n";
+      }
+      qinfo_file << "}\n";
+      q_count++;
+    } else if (flag_list_[i] == CONSTANT) {
+      const_file << "constant data " << constant_list_[c_count].name << " = {\n";
+
+      if (constant_list_[c_count].dtype == "float") {
+        float* data_buf = static_cast<float*>(constant_list_[c_count].data_buf);
+        for (uint i = 0; i < constant_list_[c_count].size / 4; i++) {
+          const_file << data_buf[i] << ", ";
+          if (i % 16 == 15) {
+            const_file << "\n";
           }
-        } else {
-          uint8_t* data_buf = static_cast<uint8_t*>(constant_list_[c_count].data_buf);
-          for (uint i = 0; i < constant_list_[c_count].size; i++) {
-            const_file << "0x" << std::hex << static_cast<int>(data_buf[i]) << ", ";
-            if (i % 16 == 15) {
-              const_file << "\n";
-            }
+        }
+      } else {
+        uint8_t* data_buf = static_cast<uint8_t*>(constant_list_[c_count].data_buf);
+        for (uint i = 0; i < constant_list_[c_count].size; i++) {
+          const_file << "0x" << std::hex << static_cast<int>(data_buf[i]) << ", ";
+          if (i % 16 == 15) {
+            const_file << "\n";
           }
         }
-        const_file << "}\n";
-        c_count++;
       }
+      const_file << "}\n";
+      c_count++;
     }
-    qinfo_file.close();
-    const_file.close();
   }
+  qinfo_file.close();
+  const_file.close();
 }
 
 int CodegenCSINN::CheckOutput(const CallNode* call) {
@@ -1631,6 +1718,7 @@ void CodegenCSINN::malloc_params(string struct_name, string params_name) {
   t0 << "struct " << struct_name << " *" << params_name << " = csi_alloc_params(sizeof(struct "
      << struct_name << "), sess)";
   PushDeclLine(t0);
+  pending_io_[current_call_].params.push_back(params_name);
 }
 
 void CodegenCSINN::Unary(const CallNode* call, string op_name) {
@@ -1919,12 +2007,20 @@ void CodegenCSINN::FreeTensor(const Expr& expr, string name) {
     }
     // Exclude input/output nodes
     if (io_nodes.find(name) == io_nodes.end()) {
-      ext_func_body.push_back("csi_mem_free(" + name + "->data);");
-      ext_func_body.push_back("csi_mem_free(" + name + ");");
+      size_t begin = ext_func_body.size();
+      FreeTensorData(name);
+      for (size_t i = begin; i < ext_func_body.size(); i++) {
+        freed_exprs_[i] = expr;
+      }
     }
   }
 }
 
+void CodegenCSINN::FreeTensorData(string name) {
+  ext_func_body.push_back("csi_mem_free(" + name + "->data);");
+  ext_func_body.push_back("csi_mem_free(" + name + ");");
+}
+
 std::shared_ptr<std::vector<float>> CodegenCSINN::FuseZpToBias(const CallNode* call,
                                                                QuantParams* q_params,
                                                                bool is_depthwise) {
@@ -2318,6 +2414,7 @@ void CodegenCSINN::Conv2d(const CallNode* call, string op_name) {
   auto kernel = constant_[0];
   string kernel_name = "kernel_" + to_string(buf_idx_);
 
+  size_t kernel_index = constant_list_.size();
   CreateHybridConstantTensor(&kernel, kernel_name, wshape, attr->q_params, 1, is_layer_hybrid,
                              depthwise_kernel);
 
@@ -2345,6 +2442,10 @@ void CodegenCSINN::Conv2d(const CallNode* call, string op_name) {
     t0 << params_name << "->conv_extra.fuse_zp2bias = true";
     PushDeclLine(t0);
   }
+  if (prepack_weights_ && !depthwise_kernel && attr->groups == 1 && !is_layer_hybrid &&
+      !is_weight_hybrid && layout_ == "NCHW" && kernel_index < constant_list_.size()) {
+    PrepackConv2dKernel(constant_list_[kernel_index], kernel_name, params_name, wshape);
+  }
   if (is_layer_hybrid) {
     PushOutput(output_name, call, hybrid_cfg->dtype_weight);
   } else {
@@ -2356,6 +2457,69 @@ void CodegenCSINN::Conv2d(const CallNode* call, string op_name) {
   FreeTensor(call->args[0], input_name);
 }
 
+/*!
+ * \brief Reorder a row major [m, k] matrix into blocks of n rows, then the tail
+ *  rows in blocks of n/2, ..., 1. Every block is stored column by column, so
+ *  the kernel loads one column of the block with a single vector load.
+ */
+static void PackRowBlocks(const char* src, char* dst, int m, int k, int n, size_t elem_size) {
+  char* out = dst;
+  int i = 0;
+  for (int block = n; block > 0; block /= 2) {
+    for (; i + block <= m; i += block) {
+      for (int p = 0; p < k; p++) {
+        for (int j = 0; j < block; j++) {
+          memcpy(out, src + (static_cast<size_t>(i + j) * k + p) * elem_size, elem_size);
+          out += elem_size;
+        }
+      }
+    }
+  }
+}
+
+void CodegenCSINN::PrepackConv2dKernel(const CSIConstant& kernel, string kernel_name,
+                                       string params_name, std::vector<int> wshape) {
+  int block = PrepackBlock(kernel.dtype);
+  if (block == 0 || wshape.size() != 4) {
+    return;
+  }
+  size_t elem_size = 0;
+  if (kernel.dtype == "float") {
+    elem_size = 4;
+  } else if (kernel.dtype == "float16") {
+    elem_size = 2;
+  } else {
+    return;
+  }
+  int m = wshape[0];
+  int k = wshape[1] * wshape[2] * wshape[3];
+  CHECK_EQ(kernel.size, static_cast<size_t>(m) * k * elem_size) << "Unexpected kernel size";
+
+  // the kernel keeps its OIHW data for the paths of the library that read it.
+  CSIConstant packed;
+  packed.name = kernel.name + "_tm";
+  packed.dtype = kernel.dtype;
+  packed.size = kernel.size;
+  packed.data_buf = malloc(packed.size);
+  PackRowBlocks(reinterpret_cast<const char*>(kernel.data_buf),
+                reinterpret_cast<char*>(packed.data_buf), m, k, block, elem_size);
+  constant_list_.push_back(packed);
+  flag_list_.push_back(CONSTANT);
+
+  string tm_name = kernel_name + "_tm";
+  CreateConstantTensorBase(tm_name, packed.size, wshape, cfg->dtype_weight,
+                           GetCSINNWeightLayout(wshape));
+  std::ostringstream t0;
+  t0 << tm_name << "->qinfo = " << kernel_name << "->qinfo";
+  PushDeclLine(t0);
+  t0 << tm_name << "->quant_channel = " << kernel_name << "->quant_channel";
+  PushDeclLine(t0);
+  t0 << params_name << "->conv_extra.kernel_tm = " << tm_name;
+  PushDeclLine(t0);
+  t0 << params_name << "->conv_extra.conv_mode = CSINN_GEMM";
+  PushDeclLine(t0);
+}
+
 void CodegenCSINN::Conv3d(const CallNode* call) {
   std::ostringstream decl;
   std::ostringstream buf;
@@ -3049,6 +3213,8 @@ void CodegenCSINN::Proposal(const CallNode* call) {
   auto im_info_shape = GetShape(call->args[2]->checked_type());
   string im_info_name = "im_info_" + to_string(buf_idx_);
   string layout = GetCSINNWeightLayout(im_info_shape);
+  constant_list_.push_back(im_info);
+  flag_list_.push_back(CONSTANT);
   CreateConstantTensorBase(im_info_name, im_info.size, im_info_shape, "int32_t", layout);
   t0 << im_info_name << "->dtype = CSINN_DTYPE_FLOAT32";
   PushDeclLine(t0);
@@ -3664,13 +3830,16 @@ void CodegenCSINN::Concat(const CallNode* call) {
       auto sub_input = GetRealInput(sub_input_node);
       CHECK(sub_input.need_copy == true);
       mem_stream << input_name << "[" << i << "] = " << sub_input.name << ";";
+      pending_io_[current_call_].reads.push_back(sub_input.name);
       free_tensor[i] = sub_input.name;
     } else if (auto sub_input_var_node = tuple->fields[i].as<tvm::relay::VarNode>()) {
       string var_name = InputTensorVar(sub_input_var_node, i, q_params[i], cfg->dtype_weight);
       mem_stream << input_name << "[" << i << "] = " << var_name << ";";
+      pending_io_[current_call_].reads.push_back(var_name);
     } else if (auto sub_input_item_node = tuple->fields[i].as<tvm::relay::TupleGetItemNode>()) {
       string item_name = InputTensorTupleItem(sub_input_item_node, q_params[i], cfg->dtype_weight);
       mem_stream << input_name << "[" << i << "] = " << item_name << ";";
+      pending_io_[current_call_].reads.push_back(item_name);
       free_tensor[i] = item_name;
     } else {
       auto sub_input_const_node = tuple->fields[i].as<tvm::relay::ConstantNode>();
@@ -4313,6 +4482,7 @@ void CodegenCSINN::Split(const CallNode* call) {
     alloc_idx_++;
     string output_name = "output_" + to_string(buf_idx_) + "_" + to_string(i);
     CreateTensor(output_name, out, out_shape, q_params[i + 1], cfg->dtype_weight);
+    BindTensorBuffer(output_name, out);
 
     t0 << out_name << "[" << to_string(i) << "] = " << output_name;
     PushDeclLine(t0);
@@ -172,6 +172,14 @@ struct CSINNConfigNode : public tvm::AttrsNode<CSINNConfigNode> {
   int h_max_kernel_size;
   bool h_contain_weight;
 
+  int params_alignment;
+  std::string params_format;
+  bool params_compress;
+  bool prepack_weights;
+  bool layer_profile;
+  bool static_memory_plan;
+  int parallel_layer_threads;
+
   TVM_DECLARE_ATTRS(CSINNConfigNode, "ext.attrs.CSINNConfigNode") {
     TVM_ATTR_FIELD(sid).set_default("csinn");
     TVM_ATTR_FIELD(target).set_default("ref");
@@ -220,6 +228,28 @@ struct CSINNConfigNode : public tvm::AttrsNode<CSINNConfigNode> {
     TVM_ATTR_FIELD(h_max_out_channel).set_default(0);
     TVM_ATTR_FIELD(h_max_kernel_size).set_default(0);
     TVM_ATTR_FIELD(h_contain_weight).set_default(false);
+    TVM_ATTR_FIELD(params_alignment)
+        .describe(
+            "Byte alignment of every entry in the dumped params file, 0 for the target default.")
+        .set_default(0);
+    TVM_ATTR_FIELD(params_format)
+        .describe("Layout of the params file, raw or indexed (see runtime/hhb/hhb_params.h).")
+        .set_default("raw");
+    TVM_ATTR_FIELD(params_compress)
+        .describe("Deflate the 8 and 4 bit weights of an indexed params file.")
+        .set_default(false);
+    TVM_ATTR_FIELD(prepack_weights)
+        .describe("Emit conv2d kernels already reordered for the GEMM kernels of the target.")
+        .set_default(false);
+    TVM_ATTR_FIELD(layer_profile)
+        .describe("Let the runtime time every layer, at the cost of one branch per layer.")
+        .set_default(false);
+    TVM_ATTR_FIELD(static_memory_plan)
+        .describe("Place all intermediate tensors in one arena planned at compile time.")
+        .set_default(false);
+    TVM_ATTR_FIELD(parallel_layer_threads)
+        .describe("Run independent layers concurrently on this many threads, 0 or 1 for none.")
+        .set_default(0);
   }
 };
 
@@ -251,11 +281,27 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
     this->layout_ = opt_cfg->layout;
     this->target_ = opt_cfg->target;
     this->params_path_ = opt_cfg->params_path;
+    this->params_alignment_ = opt_cfg->params_alignment;
+    if (params_alignment_ == 0) {
+      // only HHBRuntime, which runs the ref code, maps the params and uses them in place;
+      // the loaders of the other targets expect the entries packed back to back.
+      params_alignment_ = target_ == "ref" || target_ == "x86_ref" ? 64 : 1;
+    }
+    CHECK(params_alignment_ > 0 && (params_alignment_ & (params_alignment_ - 1)) == 0)
+        << "params_alignment must be a power of two";
+    this->params_format_ = opt_cfg->params_format;
+    CHECK(params_format_ == "raw" || params_format_ == "indexed")
+        << "Unsupport params format " << params_format_;
+    this->params_compress_ = opt_cfg->params_compress;
+    this->prepack_weights_ = opt_cfg->prepack_weights;
+    this->layer_profile_ = opt_cfg->layer_profile;
 
     this->output_dir_ = dirnameOf(this->params_path_);
 
     this->debug_level_ = opt_cfg->debug_level;
     this->multithread = opt_cfg->multi_thread;
+    this->static_memory_plan_ = opt_cfg->static_memory_plan;
+    this->parallel_layer_threads_ = opt_cfg->parallel_layer_threads;
     this->model_save = opt_cfg->model_save;
     this->trace_strategy_ = opt_cfg->trace_strategy;
     this->input_memory_type = __convert_list(opt_cfg->input_memory_type);
@@ -458,9 +504,16 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
                                    QuantParams quant_params, string dtype);
 
   virtual void DumpConstant();
+  /*! \brief Write the params as one blob, read by the generated code at the emitted offsets. */
+  void DumpRawConstant();
+  /*! \brief Write the params with a name/dtype/offset/CRC32 index, optionally deflated. */
+  void DumpIndexedConstant();
+  void DumpDebugConstant();
   virtual void SessionRunMode() {}
   virtual void ModelBinarySave() {}
   virtual void malloc_buf(string out, int out_size) = 0;
+  /*! \brief Record that the data of tensor is a buffer of malloc_buf, released with the tensor. */
+  virtual void BindTensorBuffer(string tensor, string buffer) {}
   virtual bool InOpList(const CallNode* call);
   virtual string OutputTensor(std::ostringstream& decl, const CallNode* call,
                               QuantParams quant_params, string dtype);
@@ -574,6 +627,19 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
 
   template <typename T>
   void SetupConv2dParams(string name, const T* attr);
+  /*!
+   * \brief Output channel block of the im2col GEMM kernels of the target.
+   * \param dtype The dtype of the emitted kernel constant.
+   * \return 0 if the target has no packed kernel layout for dtype.
+   */
+  virtual int PrepackBlock(string dtype) { return 0; }
+  /*!
+   * \brief Emit a copy of a conv2d kernel reordered offline into the GEMM layout
+   *  of the target and hand it over as conv_extra.kernel_tm, so the library does
+   *  not repack it at setup. The kernel itself is left as it is.
+   */
+  void PrepackConv2dKernel(const CSIConstant& kernel, string kernel_name, string params_name,
+                           std::vector<int> wshape);
 
   template <typename T>
   void SetupConv3dParams(string name, const T* attr);
@@ -601,6 +667,7 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
   virtual void EmitSessionRun(void);
   virtual void EmitNBGSetup(void);
   virtual void FreeTensor(const Expr& expr, string name);
+  virtual void FreeTensorData(string name);
 
   virtual Output* GetOutput(string name);
 
@@ -918,6 +985,12 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
     std::ostringstream func;
     func << "csi_" << name << decl.str() << ";";
 
+    layer_call_index_.push_back(ext_func_body.size());
+    layer_names_.push_back(last_layer_name_.empty() ? name : last_layer_name_);
+    last_layer_name_.clear();
+    layer_calls_.push_back(current_call_);
+    layer_io_.push_back(pending_io_[current_call_]);
+    pending_io_.erase(current_call_);
     ext_func_body.push_back(func.str());
     buf_idx_++;
   }
@@ -1090,6 +1163,15 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
     return false;
   }
 
+  /*!
+   * \brief Move the params offset past an entry of size bytes.
+   *  Every entry of the params file starts on a params_alignment_ boundary, with
+   *  an alignment of 1 the entries are packed back to back.
+   */
+  void AdvanceConstantOffset(size_t size) {
+    constant_offset = (constant_offset + size + params_alignment_ - 1) & ~(params_alignment_ - 1);
+  }
+
   string get_complete_layer_name(string op_name, string ori_layer_name) {
     string res = op_name + "_" + ori_layer_name + "_" + std::to_string(params_idx_);
     return res;
@@ -1109,6 +1191,36 @@ class CodegenCSINN : public ExprVisitor, public CodegenCBase {
  protected:
   size_t constant_offset{0};
   size_t qinfo_offset{0};
+  size_t params_alignment_{1};
+  string params_format_{"raw"};
+  bool params_compress_{false};
+  bool prepack_weights_{false};
+  bool static_memory_plan_{false};
+  int parallel_layer_threads_{0};
+  bool layer_profile_{false};
+  /*! \brief The index in ext_func_body of the call of each layer. */
+  std::vector<size_t> layer_call_index_;
+  /*! \brief The name of each layer, parallel to layer_call_index_. */
+  std::vector<string> layer_names_;
+  string last_layer_name_;
+  /*! \brief Byte size of the data of each emitted tensor. */
+  std::unordered_map<string, size_t> tensor_bytes_;
+  /*! \brief The tensors and params of a layer, as the codegen emits them. */
+  struct LayerIO {
+    std::vector<string> reads;
+    std::vector<string> writes;
+    std::vector<string> params;
+  };
+  /*! \brief The call being emitted, NULL outside of VisitExpr_(const CallNode*). */
+  const CallNode* current_call_{nullptr};
+  /*! \brief The io recorded for each call being emitted, until its layer is ended. */
+  std::unordered_map<const CallNode*, LayerIO> pending_io_;
+  /*! \brief The call emitting each layer, parallel to layer_call_index_. */
+  std::vector<const CallNode*> layer_calls_;
+  /*! \brief The io of each layer, parallel to layer_call_index_. */
+  std::vector<LayerIO> layer_io_;
+  /*! \brief The expression released by each free statement of ext_func_body. */
+  std::unordered_map<size_t, Expr> freed_exprs_;
 };
 
 }  // namespace contrib
@@ -61,6 +61,29 @@ class CodegenGref : public CodegenCSINN {
 
   void SessionRunMode() { PrintOneLine(code_stream_, "sess->base_run_mode = CSINN_RM_CPU_GRAPH;"); }
 
+  /*!
+   * \brief The c906/c908 GEMM kernels take the weights packn output channels at
+   *  a time, packn being the elements of dtype in one vector register.
+   */
+  int PrepackBlock(string dtype) {
+    int vlen = VectorBits();
+    if (dtype == "float") {
+      return vlen / 32;
+    } else if (dtype == "float16") {
+      return vlen / 16;
+    }
+    return 0;
+  }
+
+  /*! \return The width in bits of the vector registers of the target, 0 without RVV. */
+  int VectorBits() const {
+    // both cores implement RVV with VLEN 128.
+    if (target_ == "CSINN_C906" || target_ == "CSINN_C908") {
+      return 128;
+    }
+    return 0;
+  }
+
  private:
   string rmode_{""};
   string target_{""};
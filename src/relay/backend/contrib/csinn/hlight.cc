@@ -50,7 +50,8 @@ void CodegenHLight::CreateTensor(string name, string data, std::vector<int> shap
   PushDeclLine(t0);
   t0 << name << "->quant_channel = " << to_string(quant_params.q_size);
   PushDeclLine(t0);
-  constant_offset += quant_params.q_size * sizeof(Qinfo);
+  AdvanceConstantOffset(quant_params.q_size * sizeof(Qinfo));
+  quant_params.name = name;
   qinfo_list_.push_back(quant_params);
   flag_list_.push_back(QINFO);
 }
@@ -48,6 +48,9 @@ void CodegenI805::GenerateBackendCFunc(const string& func_name, const Array<Var>
   PrintOneLine(code_stream_, "char** inputs = (char**)(uintptr_t)arg_value[0];");
   PrintOneLine(code_stream_, "char** outputs = (char**)(uintptr_t)arg_value[1];");
   PrintOneLine(code_stream_, "char *params_base = (char *)(uintptr_t)arg_value[2];");
+  if (static_memory_plan_) {
+    PrintOneLine(code_stream_, "char *arena = (char *)(uintptr_t)arg_value[3];");
+  }
 
   string out_dtype = GetCSINNDtype(weight_dtype);
 
@@ -73,7 +76,11 @@ void CodegenI805::GenerateBackendCFunc(const string& func_name, const Array<Var>
   for (uint i = 0; i < output_list_.size(); i++) {
     t0 << "out_" << i << ", ";
   }
-  t0 << "params_base);\n";
+  t0 << "params_base";
+  if (static_memory_plan_) {
+    t0 << ", arena";
+  }
+  t0 << ");\n";
   PrintOneLine(code_stream_, t0);
   PrintOneLine(code_stream_, "return 0;");
   ExitScope();
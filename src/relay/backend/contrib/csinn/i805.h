@@ -25,6 +25,7 @@
 #define TVM_RELAY_BACKEND_CONTRIB_CSINN_I805_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "csinn.h"
@@ -36,11 +37,18 @@ namespace contrib {
 
 class CodegenI805 : public CodegenRef {
  public:
-  CodegenI805() : CodegenRef() {}
+  CodegenI805() : CodegenRef() {
+    // no POSIX clock on the bare metal i805
+    layer_profile_ = false;
+  }
   virtual ~CodegenI805() {}
 
   virtual void GenerateBackendCFunc(const string& func_name, const Array<Var>& args,
                                     const Output& out);
+  /*! \brief The i805 wrapper passes the inputs and outputs through unconverted. */
+  virtual std::vector<std::pair<string, int>> WrapperBuffers(const Array<Var>& args) {
+    return {};
+  }
 };
 
 }  // namespace contrib
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/backend/contrib/csinn/memory_plan.cc
+ * \brief Static arena planner for the intermediate tensors of CSINN generated code.
+ */
+
+#include "memory_plan.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace tvm {
+namespace relay {
+namespace contrib {
+
+void ArenaPlanner::Alloc(const std::string& name, size_t size, int step) {
+  CHECK(buffer_index_.find(name) == buffer_index_.end()) << "Buffer " << name << " allocated twice";
+  buffer_index_[name] = buffers_.size();
+  buffers_.push_back({name, size, step, std::numeric_limits<int>::max(), 0});
+}
+
+void ArenaPlanner::Free(const std::string& name, int step) {
+  auto it = buffer_index_.find(name);
+  CHECK(it != buffer_index_.end()) << "Free unknown buffer " << name;
+  Buffer& buf = buffers_[it->second];
+  CHECK_GE(step, buf.start);
+  buf.end = step;
+}
+
+void ArenaPlanner::RemapSteps(const std::vector<int>& step_map) {
+  for (auto& buf : buffers_) {
+    CHECK_LT(static_cast<size_t>(buf.start), step_map.size());
+    buf.start = step_map[buf.start];
+    if (buf.end != std::numeric_limits<int>::max()) {
+      CHECK_LT(static_cast<size_t>(buf.end), step_map.size());
+      buf.end = step_map[buf.end];
+    }
+    CHECK_GE(buf.end, buf.start);
+  }
+}
+
+size_t ArenaPlanner::Plan() {
+  std::vector<Buffer*> order;
+  for (auto& buf : buffers_) {
+    order.push_back(&buf);
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [](const Buffer* a, const Buffer* b) { return a->size > b->size; });
+
+  arena_size_ = 0;
+  std::vector<const Buffer*> placed;
+  for (Buffer* buf : order) {
+    // Collect the placed buffers that are alive at the same time, by offset.
+    std::vector<const Buffer*> conflicts;
+    for (const Buffer* other : placed) {
+      if (other->start <= buf->end && buf->start <= other->end) {
+        conflicts.push_back(other);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(),
+              [](const Buffer* a, const Buffer* b) { return a->offset < b->offset; });
+    // First gap between conflicting buffers that is large enough.
+    size_t offset = 0;
+    for (const Buffer* other : conflicts) {
+      if (offset + buf->size <= other->offset) {
+        break;
+      }
+      size_t other_end = other->offset + other->size;
+      offset = std::max(offset, (other_end + alignment_ - 1) / alignment_ * alignment_);
+    }
+    buf->offset = offset;
+    arena_size_ = std::max(arena_size_, offset + buf->size);
+    placed.push_back(buf);
+  }
+  arena_size_ = (arena_size_ + alignment_ - 1) / alignment_ * alignment_;
+  return arena_size_;
+}
+
+size_t ArenaPlanner::GetOffset(const std::string& name) const {
+  auto it = buffer_index_.find(name);
+  CHECK(it != buffer_index_.end()) << "Unknown buffer " << name;
+  return buffers_[it->second].offset;
+}
+
+size_t ArenaPlanner::TotalSize() const {
+  size_t total = 0;
+  for (const auto& buf : buffers_) {
+    total += buf.size;
+  }
+  return total;
+}
+
+}  // namespace contrib
+}  // namespace relay
+}  // namespace tvm
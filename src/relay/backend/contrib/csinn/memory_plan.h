@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relay/backend/contrib/csinn/memory_plan.h
+ * \brief Static arena planner for the intermediate tensors of CSINN generated code.
+ */
+#ifndef TVM_RELAY_BACKEND_CONTRIB_CSINN_MEMORY_PLAN_H_
+#define TVM_RELAY_BACKEND_CONTRIB_CSINN_MEMORY_PLAN_H_
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+namespace contrib {
+
+/*!
+ * \brief Assign every intermediate buffer an offset in one pre-allocated arena.
+ *
+ *  The codegen reports when a buffer is allocated and when its last consumer
+ *  has run, as positions in the emitted statement list. Buffers whose live
+ *  ranges overlap never share memory; the rest are packed greedily, biggest
+ *  first, into the lowest offset that fits. Buffers that are never released
+ *  live until the end of the graph.
+ */
+class ArenaPlanner {
+ public:
+  explicit ArenaPlanner(size_t alignment = 64) : alignment_(alignment) {}
+
+  /*!
+   * \brief Record a new buffer.
+   * \param name The name of the buffer in the generated code.
+   * \param size The size of the buffer in bytes.
+   * \param step The position where the buffer is first written.
+   */
+  void Alloc(const std::string& name, size_t size, int step);
+  /*!
+   * \brief Record the end of the live range of a buffer.
+   * \param name The name of the buffer in the generated code.
+   * \param step The position after which the buffer is no longer read.
+   */
+  void Free(const std::string& name, int step);
+  /*!
+   * \brief Move every recorded position, e.g. after the statements were reordered.
+   * \param step_map The new position of each old position.
+   */
+  void RemapSteps(const std::vector<int>& step_map);
+  /*!
+   * \brief Compute the offset of every buffer.
+   * \return The size of the arena in bytes.
+   */
+  size_t Plan();
+  /*!
+   * \brief Get the planned offset of a buffer, only valid after Plan.
+   * \param name The name of the buffer.
+   * \return The offset in bytes from the start of the arena.
+   */
+  size_t GetOffset(const std::string& name) const;
+  /*! \return The size of the arena in bytes, only valid after Plan. */
+  size_t ArenaSize() const { return arena_size_; }
+  /*! \return The sum of all buffer sizes, i.e. what the unplanned code allocates. */
+  size_t TotalSize() const;
+  /*! \return Whether any buffer was recorded. */
+  bool Empty() const { return buffers_.empty(); }
+
+ private:
+  struct Buffer {
+    std::string name;
+    size_t size;
+    int start;
+    int end;
+    size_t offset;
+  };
+
+  size_t alignment_;
+  size_t arena_size_{0};
+  std::vector<Buffer> buffers_;
+  std::unordered_map<std::string, size_t> buffer_index_;
+};
+
+}  // namespace contrib
+}  // namespace relay
+}  // namespace tvm
+#endif  // TVM_RELAY_BACKEND_CONTRIB_CSINN_MEMORY_PLAN_H_
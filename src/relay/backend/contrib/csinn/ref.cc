@@ -24,6 +24,12 @@
 
 #include "ref.h"
 
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
 using namespace tvm::relay::qnn;
 namespace tvm {
 namespace relay {
@@ -44,6 +50,7 @@ void CodegenRef::CreateTensorSessData() {
         out_shape.push_back(1);
       }
       CreateMallocBuf(data, out_shape, out->dtype);
+      tensor_buffer_[iter->first] = data;
       alloc_idx_++;
     } else if (data == "hybrid_alloc") {
       iter++;
@@ -78,9 +85,9 @@ void CodegenRef::CreateHybridTensorSessData(std::vector<int> shape, string dtype
         out_size *= 2;
       }
 
-      std::ostringstream t1;
-      t1 << dtype << " *" << data << " = (" << dtype << " *)csi_mem_alloc(" << out_size << ");";
-      ext_func_body.push_back(t1.str());
+      EmitBufferAlloc(data, dtype, out_size);
+      tensor_buffer_[item.first] = data;
+      hybrid_buffers_.push_back(data);
 
       alloc_idx_++;
     }
@@ -91,12 +98,588 @@ void CodegenRef::CreateHybridTensorSessData(std::vector<int> shape, string dtype
 }
 
 void CodegenRef::malloc_buf(string out, int out_size) {
+  EmitBufferAlloc(out, cfg->dtype_input, out_size);
+}
+
+void CodegenRef::EmitBufferAlloc(string name, string dtype, int size) {
   std::ostringstream t0;
-  t0 << cfg->dtype_input << " *" << out << " = (" << cfg->dtype_input << " *)csi_mem_alloc("
-     << out_size << ");";
+  t0 << dtype << " *" << name << " = (" << dtype << " *)";
+  if (static_memory_plan_) {
+    // the offset is appended by PlanArena once all live ranges are known
+    arena_planner_.Alloc(name, size, ext_func_body.size());
+    arena_lines_[name] = ext_func_body.size();
+    t0 << "(arena + ";
+  } else {
+    t0 << "csi_mem_alloc(" << size << ");";
+  }
   ext_func_body.push_back(t0.str());
 }
 
+void CodegenRef::BindTensorBuffer(string tensor, string buffer) { tensor_buffer_[tensor] = buffer; }
+
+void CodegenRef::FreeTensorData(string name) {
+  if (!static_memory_plan_) {
+    CodegenCSINN::FreeTensorData(name);
+    return;
+  }
+  auto iter = tensor_buffer_.find(name);
+  if (iter != tensor_buffer_.end()) {
+    arena_planner_.Free(iter->second, ext_func_body.size());
+  }
+  // the tensor is kept in the session state, the statement only marks where it dies
+  ext_func_body.push_back("/* " + name + " is no longer read */");
+}
+
+std::vector<CodegenRef::LayerGroup> CodegenRef::ScheduleLayers() {
+  std::vector<LayerGroup> groups;
+  if (parallel_layer_threads_ <= 1 || layer_call_index_.empty()) {
+    return groups;
+  }
+  size_t num_layers = layer_call_index_.size();
+
+  // A layer is its call plus the statements emitted since the previous call;
+  // frees are kept apart since they must wait for every reader of the tensor.
+  std::vector<std::vector<size_t>> layer_stmts(num_layers);
+  std::vector<std::pair<size_t, size_t>> frees;
+  std::vector<size_t> epilogue;
+  size_t layer = 0;
+  for (size_t i = 0; i < ext_func_body.size(); i++) {
+    while (layer < num_layers && layer_call_index_[layer] < i) {
+      layer++;
+    }
+    if (freed_exprs_.count(i)) {
+      frees.push_back({i, layer == 0 ? 0 : layer - 1});
+    } else if (layer == num_layers) {
+      epilogue.push_back(i);
+    } else {
+      layer_stmts[layer].push_back(i);
+    }
+  }
+
+  // The last layer of a call holds its outputs.
+  std::unordered_map<const Object*, size_t> call_layer;
+  for (size_t k = 0; k < num_layers; k++) {
+    if (layer_calls_[k]) {
+      call_layer[layer_calls_[k]] = k;
+    }
+  }
+  // The layers producing the value of an expression, looking through tuples
+  // and calls emitted without a layer of their own.
+  std::unordered_map<const Object*, std::vector<size_t>> memo;
+  std::function<std::vector<size_t>(const Expr&)> producers = [&](const Expr& expr) {
+    auto it = memo.find(expr.get());
+    if (it != memo.end()) {
+      return it->second;
+    }
+    std::vector<size_t> layers;
+    auto add = [&](const Expr& e) {
+      auto p = producers(e);
+      layers.insert(layers.end(), p.begin(), p.end());
+    };
+    if (const auto* call = expr.as<CallNode>()) {
+      auto layer_it = call_layer.find(call);
+      if (layer_it != call_layer.end()) {
+        layers.push_back(layer_it->second);
+      } else {
+        for (const auto& arg : call->args) {
+          add(arg);
+        }
+      }
+    } else if (const auto* tuple = expr.as<TupleNode>()) {
+      for (const auto& field : tuple->fields) {
+        add(field);
+      }
+    } else if (const auto* item = expr.as<TupleGetItemNode>()) {
+      add(item->tuple);
+    }
+    memo[expr.get()] = layers;
+    return layers;
+  };
+
+  // Depth of each layer in the dependency DAG of the graph, layers of equal depth are independent.
+  std::vector<int> level(num_layers, 0);
+  std::vector<int> last_read(num_layers, 0);
+  std::unordered_map<const CallNode*, size_t> prev_layer;
+  int max_level = 0;
+  for (size_t k = 0; k < num_layers; k++) {
+    const CallNode* call = layer_calls_[k];
+    std::vector<size_t> deps;
+    if (call) {
+      for (const auto& arg : call->args) {
+        auto p = producers(arg);
+        deps.insert(deps.end(), p.begin(), p.end());
+      }
+      // the layers of one call run in the order they are emitted
+      auto it = prev_layer.find(call);
+      if (it != prev_layer.end()) {
+        deps.push_back(it->second);
+      }
+      prev_layer[call] = k;
+    }
+    // a layer not traced to the graph runs in order with its neighbors
+    if (k > 0 && (!call || !layer_calls_[k - 1])) {
+      deps.push_back(k - 1);
+    }
+    for (auto dep : deps) {
+      // a layer emitted before an input of its call, e.g. a data convert, does not read it
+      if (dep < k) {
+        level[k] = std::max(level[k], level[dep] + 1);
+      }
+    }
+    max_level = std::max(max_level, level[k]);
+    for (auto dep : deps) {
+      if (dep < k) {
+        last_read[dep] = std::max(last_read[dep], level[k]);
+      }
+    }
+  }
+
+  groups.resize(max_level + 1);
+  for (size_t k = 0; k < num_layers; k++) {
+    groups[level[k]].layers.push_back(layer_stmts[k]);
+    groups[level[k]].ids.push_back(k);
+  }
+  for (auto item : frees) {
+    int free_level = level[item.second];
+    for (auto p : producers(freed_exprs_[item.first])) {
+      free_level = std::max(free_level, last_read[p]);
+    }
+    groups[free_level].tail.push_back(item.first);
+  }
+  for (auto i : epilogue) {
+    groups.back().tail.push_back(i);
+  }
+  for (auto& group : groups) {
+    std::sort(group.tail.begin(), group.tail.end());
+  }
+  return groups;
+}
+
+std::vector<int> CodegenRef::ScheduledSteps() {
+  std::vector<int> steps(ext_func_body.size());
+  if (layer_groups_.empty()) {
+    for (size_t i = 0; i < steps.size(); i++) {
+      steps[i] = i;
+    }
+    return steps;
+  }
+  int pos = 0;
+  for (const auto& group : layer_groups_) {
+    // everything in a concurrent group is live for the whole group
+    bool concurrent = group.layers.size() > 1;
+    int start = pos;
+    for (const auto& layer : group.layers) {
+      for (auto i : layer) {
+        steps[i] = concurrent ? start : pos;
+        pos++;
+      }
+    }
+    for (auto i : group.tail) {
+      steps[i] = pos++;
+    }
+  }
+  return steps;
+}
+
+void CodegenRef::EmitLayerGroups(const std::vector<string>& body) {
+  if (layer_groups_.empty()) {
+    for (auto stmt : body) {
+      PrintOneLine(code_stream_, stmt);
+    }
+    return;
+  }
+  std::ostringstream t0;
+  for (const auto& group : layer_groups_) {
+    if (group.layers.size() == 1) {
+      for (auto i : group.layers[0]) {
+        PrintOneLine(code_stream_, body[i]);
+      }
+    } else {
+      t0 << "#pragma omp parallel sections num_threads(" << parallel_layer_threads_ << ")";
+      PrintOneLine(code_stream_, t0);
+      PrintOneLine(code_stream_, "{");
+      EnterScope();
+      for (size_t j = 0; j < group.layers.size(); j++) {
+        PrintOneLine(code_stream_, "#pragma omp section");
+        PrintOneLine(code_stream_, "{");
+        EnterScope();
+        if (j > 0) {
+          // the other sections run on sessions of their own, see EmitSectionSessions
+          const LayerIO& io = layer_io_[group.ids[j]];
+          for (const auto& params : io.params) {
+            t0 << params << "->base.sess = sess_" << j << ";";
+            PrintOneLine(code_stream_, t0);
+          }
+          // the inputs may be read by other sections, only the outputs are the layer's own
+          for (const auto& tensor : io.writes) {
+            if (std::find(io.reads.begin(), io.reads.end(), tensor) == io.reads.end()) {
+              t0 << tensor << "->sess = sess_" << j << ";";
+              PrintOneLine(code_stream_, t0);
+            }
+          }
+        }
+        for (auto i : group.layers[j]) {
+          PrintOneLine(code_stream_, body[i]);
+        }
+        ExitScope();
+        PrintOneLine(code_stream_, "}");
+      }
+      ExitScope();
+      PrintOneLine(code_stream_, "}");
+    }
+    for (auto i : group.tail) {
+      PrintOneLine(code_stream_, body[i]);
+    }
+  }
+}
+
+size_t CodegenRef::NumSections() const {
+  size_t num_sections = 1;
+  for (const auto& group : layer_groups_) {
+    num_sections = std::max(num_sections, group.layers.size());
+  }
+  return num_sections;
+}
+
+void CodegenRef::EmitSectionSessions() {
+  std::ostringstream t0;
+  for (size_t j = 1; j < NumSections(); j++) {
+    string sess = "sess_" + to_string(j);
+    t0 << "struct csi_session *" << sess << " = csi_alloc_session();";
+    PrintOneLine(code_stream_, t0);
+    for (string field : {"base_dtype", "base_layout", "base_run_mode", "base_api"}) {
+      t0 << sess << "->" << field << " = sess->" << field << ";";
+      PrintOneLine(code_stream_, t0);
+    }
+  }
+}
+
+void CodegenRef::EmitSessions() {
+  PrintOneLine(code_stream_, "struct csi_session *sess = csi_alloc_session();");
+  std::ostringstream sess_dtype;
+  sess_dtype << "sess->base_dtype = " << GetCSINNDtype(cfg->dtype_weight) << ";";
+  PrintOneLine(code_stream_, sess_dtype);
+  PrintOneLine(code_stream_, "sess->base_layout = CSINN_LAYOUT_" + layout_ + ";");
+  PrintOneLine(code_stream_, "sess->base_run_mode = CSINN_RM_LAYER;");
+  PrintOneLine(code_stream_, "sess->base_api = " + target_name_ + ";");
+  if (debug_level_ == "INFO") {
+    PrintOneLine(code_stream_, "csi_debug_set_level(CSI_DEBUG_LEVEL_INFO);");
+  }
+  EmitSectionSessions();
+}
+
+std::vector<string> CodegenRef::SetupDecls(const std::vector<string>& buf_decl) {
+  state_vars_.clear();
+  state_vars_.push_back({"struct csi_session *", "sess"});
+  for (size_t j = 1; j < NumSections(); j++) {
+    state_vars_.push_back({"struct csi_session *", "sess_" + to_string(j)});
+  }
+  auto is_name = [](const string& s) {
+    return !s.empty() && !isdigit(s[0]) && std::all_of(s.begin(), s.end(), [](char c) {
+      return isalnum(c) || c == '_';
+    });
+  };
+  std::vector<string> decls;
+  for (const auto& line : buf_decl) {
+    // a declaration is "type name", "type *name" or "type name[N]", up to its initializer
+    size_t end = line.find(" = ");
+    string lhs = line.substr(0, end == string::npos ? line.size() - 1 : end);
+    size_t space = lhs.rfind(' ');
+    if (lhs.find_first_of("(\"") != string::npos || lhs.find("->") != string::npos ||
+        space == string::npos) {
+      decls.push_back(line);
+      continue;
+    }
+    string type = lhs.substr(0, space + 1);
+    string name = lhs.substr(space + 1);
+    size_t stars = name.find_first_not_of('*');
+    type += name.substr(0, stars);
+    name = name.substr(stars);
+    size_t bracket = name.find('[');
+    string count;
+    if (bracket != string::npos) {
+      count = name.substr(bracket + 1, name.size() - bracket - 2);
+      name = name.substr(0, bracket);
+    }
+    if (!is_name(name)) {
+      decls.push_back(line);
+    } else if (count.empty()) {
+      if (stars > 0) {
+        state_vars_.push_back({type, name});
+      }
+      decls.push_back(line);
+    } else if (stars > 0) {
+      // an array of pointers must outlive the setup, it is allocated instead
+      state_vars_.push_back({type + "*", name});
+      decls.push_back(type + "*" + name + " = csi_mem_alloc(" + count + " * sizeof(" + type +
+                      "));");
+    } else {
+      // params point into the value arrays, e.g. the block shape of space_to_batch_nd
+      decls.push_back("static " + line);
+    }
+  }
+  return decls;
+}
+
+void CodegenRef::EmitStateSetup(const string& func_name) {
+  std::ostringstream t0;
+  t0 << "struct " << func_name << "_state_ {";
+  PrintOneLine(code_stream_, t0);
+  EnterScope();
+  PrintOneLine(code_stream_, "char *params_base;");
+  for (const auto& var : state_vars_) {
+    PrintOneLine(code_stream_, var.first + var.second + ";");
+  }
+  ExitScope();
+  PrintOneLine(code_stream_, "};");
+  PrintNewLine(code_stream_);
+
+  t0 << "static void " << func_name << "_setup_(struct " << func_name
+     << "_state_ *state_, char *params_base) {";
+  PrintOneLine(code_stream_, t0);
+  EnterScope();
+  EmitSessions();
+  PrintNewLine(code_stream_);
+  for (const auto& decl : setup_decl_) {
+    PrintOneLine(code_stream_, decl);
+  }
+  PrintNewLine(code_stream_);
+  for (const auto& var : state_vars_) {
+    PrintOneLine(code_stream_, "state_->" + var.second + " = " + var.second + ";");
+  }
+  PrintOneLine(code_stream_, "state_->params_base = params_base;");
+  ExitScope();
+  PrintOneLine(code_stream_, "}");
+  PrintNewLine(code_stream_);
+}
+
+void CodegenRef::PlanArena() {
+  if (!static_memory_plan_) {
+    return;
+  }
+  // a converted input is only read by the layer it was converted for, the next call
+  for (const auto& name : hybrid_buffers_) {
+    auto call =
+        std::upper_bound(layer_call_index_.begin(), layer_call_index_.end(), arena_lines_[name]);
+    if (call != layer_call_index_.end()) {
+      arena_planner_.Free(name, *call);
+    }
+  }
+  arena_planner_.RemapSteps(ScheduledSteps());
+  // the wrapper buffers and the state of the session are kept across runs,
+  // every member of a state is a pointer and 8 bytes hold one on any target
+  auto wrapper_buffers = WrapperBuffers(ext_func_args_);
+  for (const auto& item : wrapper_buffers) {
+    arena_planner_.Alloc(item.first, item.second, 0);
+  }
+  if (!wrapper_buffers.empty()) {
+    arena_planner_.Alloc(ext_func_id_ + "_io_state_", 8 * (2 * wrapper_buffers.size() + 1), 0);
+  }
+  setup_decl_ = SetupDecls(buf_decl_);
+  arena_planner_.Alloc(ext_func_id_ + "_state_", 8 * (state_vars_.size() + 1), 0);
+  size_t arena_size = arena_planner_.Plan();
+  for (auto item : arena_lines_) {
+    ext_func_body[item.second] += to_string(arena_planner_.GetOffset(item.first)) + ");";
+  }
+  VLOG(1) << "CSINN arena size: " << arena_size << " bytes, "
+          << "unplanned intermediate size: " << arena_planner_.TotalSize() << " bytes";
+}
+
+void CodegenRef::EmitArenaSize(const string& func_name) {
+  if (!static_memory_plan_) {
+    return;
+  }
+  PrintNewLine(code_stream_);
+  std::ostringstream t0;
+  t0 << "int " << func_name << "_arena_size_(void* args, int* type_codes, int num_args, ";
+  t0 << "void* out_ret_value, int* out_ret_tcode, void* resource_handle) {";
+  PrintOneLine(code_stream_, t0);
+  EnterScope();
+  t0 << "*(int64_t*)out_ret_value = " << arena_planner_.ArenaSize() << ";";
+  PrintOneLine(code_stream_, t0);
+  // kDLInt
+  PrintOneLine(code_stream_, "*out_ret_tcode = 0;");
+  PrintOneLine(code_stream_, "return 0;");
+  ExitScope();
+  PrintOneLine(code_stream_, "}");
+}
+
+void CodegenRef::InstrumentLayers(const string& func_name) {
+  if (!layer_profile_) {
+    return;
+  }
+  // layer_time is the timing buffer of the caller, NULL when not profiling
+  string times = "layer_time";
+  for (size_t k = 0; k < layer_call_index_.size(); k++) {
+    size_t call = layer_call_index_[k];
+    // the tensors a layer creates and does not read are its outputs
+    const LayerIO& io = layer_io_[k];
+    std::unordered_set<string> read(io.reads.begin(), io.reads.end());
+    std::unordered_set<string> written;
+    for (const auto& name : io.writes) {
+      if (!read.count(name)) {
+        written.insert(name);
+      }
+    }
+    auto total_bytes = [this](const std::unordered_set<string>& names) {
+      size_t bytes = 0;
+      for (const auto& name : names) {
+        auto it = tensor_bytes_.find(name);
+        if (it != tensor_bytes_.end()) {
+          bytes += it->second;
+        }
+      }
+      return bytes;
+    };
+    layer_bytes_.push_back({total_bytes(read), total_bytes(written)});
+
+    std::ostringstream t0;
+    t0 << "{ int64_t start_ = " << times << " ? " << func_name << "_now_() : 0; ";
+    t0 << ext_func_body[call] << " ";
+    t0 << "if (" << times << ") " << times << "[" << k << "] += " << func_name
+       << "_now_() - start_; }";
+    ext_func_body[call] = t0.str();
+  }
+}
+
+void CodegenRef::EmitLayerProfile(const string& func_name) {
+  if (!layer_profile_) {
+    return;
+  }
+  string handle_args =
+      "(void* args, int* type_codes, int num_args, void* out_ret_value, int* out_ret_tcode, "
+      "void* resource_handle) {";
+  std::ostringstream t0;
+  PrintNewLine(code_stream_);
+  t0 << "static const char *" << func_name << "_layer_names_[] = {";
+  for (const auto& name : layer_names_) {
+    t0 << "\"" << name << "\", ";
+  }
+  t0 << "NULL};";
+  PrintOneLine(code_stream_, t0);
+  t0 << "static const int64_t " << func_name << "_layer_bytes_[][2] = {";
+  for (const auto& bytes : layer_bytes_) {
+    t0 << "{" << bytes.first << ", " << bytes.second << "}, ";
+  }
+  t0 << "{0, 0}};";
+  PrintOneLine(code_stream_, t0);
+
+  // () -> number of layers, (k, 0) -> name, (k, 1) -> bytes read, (k, 2) -> bytes written
+  PrintNewLine(code_stream_);
+  t0 << "int " << func_name << "_layer_info_" << handle_args;
+  PrintOneLine(code_stream_, t0);
+  EnterScope();
+  PrintOneLine(code_stream_, "int64_t *values = (int64_t *)args;");
+  PrintOneLine(code_stream_, "if (num_args < 2) {");
+  EnterScope();
+  t0 << "*(int64_t *)out_ret_value = " << layer_names_.size() << ";";
+  PrintOneLine(code_stream_, t0);
+  // kDLInt
+  PrintOneLine(code_stream_, "*out_ret_tcode = 0;");
+  ExitScope();
+  PrintOneLine(code_stream_, "} else if (values[1] == 0) {");
+  EnterScope();
+  t0 << "*(const char **)out_ret_value = " << func_name << "_layer_names_[values[0]];";
+  PrintOneLine(code_stream_, t0);
+  // kTVMOpaqueHandle
+  PrintOneLine(code_stream_, "*out_ret_tcode = 3;");
+  ExitScope();
+  PrintOneLine(code_stream_, "} else {");
+  EnterScope();
+  t0 << "*(int64_t *)out_ret_value = " << func_name << "_layer_bytes_[values[0]][values[1] - 1];";
+  PrintOneLine(code_stream_, t0);
+  PrintOneLine(code_stream_, "*out_ret_tcode = 0;");
+  ExitScope();
+  PrintOneLine(code_stream_, "}");
+  PrintOneLine(code_stream_, "return 0;");
+  ExitScope();
+  PrintOneLine(code_stream_, "}");
+}
+
+/*! \brief The DLPack dtype of a C dtype of the generated code. */
+static DataType CDtypeToDataType(const string& dtype) {
+  if (dtype == "float") {
+    return DataType::Float(32);
+  } else if (dtype == "float16") {
+    return DataType::Float(16);
+  } else if (dtype == "bfloat16") {
+    return DataType::BFloat(16);
+  } else if (dtype == "int32_t") {
+    return DataType::Int(32);
+  } else if (dtype == "int16_t") {
+    return DataType::Int(16);
+  } else if (dtype == "uint8_t") {
+    return DataType::UInt(8);
+  } else if (dtype == "int8_t" || dtype == "int4_t") {
+    return DataType::Int(8);
+  }
+  LOG(FATAL) << "Unsupported dtype " << dtype;
+  return DataType();
+}
+
+void CodegenRef::EmitIOInfo(const string& func_name, const Array<Var>& args) {
+  // {bytes, type code, bits} of every input, then of every output
+  std::vector<std::vector<int64_t>> io_info[2];
+  for (const auto& arg : args) {
+    auto ttype = arg->checked_type().as<TensorTypeNode>();
+    CHECK(ttype) << "Expect TensorTypeNode";
+    int64_t bytes = ttype->dtype.bytes();
+    for (auto dim : GetShape(arg->checked_type())) {
+      bytes *= dim;
+    }
+    io_info[0].push_back({bytes, ttype->dtype.code(), ttype->dtype.bits()});
+  }
+  for (const auto& out : output_list_) {
+    // quantized outputs are converted back to the dtype of the graph by the wrapper
+    DataType dtype = out.call != NULL ? GetType(out.call->checked_type())
+                                      : CDtypeToDataType(cfg->dtype_input);
+    io_info[1].push_back({static_cast<int64_t>(out.size) * dtype.bytes(), dtype.code(),
+                          dtype.bits()});
+  }
+
+  std::ostringstream t0;
+  PrintNewLine(code_stream_);
+  const char* kinds[2] = {"input", "output"};
+  for (int kind = 0; kind < 2; kind++) {
+    t0 << "static const int64_t " << func_name << "_" << kinds[kind] << "_info_[][3] = {";
+    for (const auto& info : io_info[kind]) {
+      t0 << "{" << info[0] << ", " << info[1] << ", " << info[2] << "}, ";
+    }
+    t0 << "{0, 0, 0}};";
+    PrintOneLine(code_stream_, t0);
+  }
+
+  // (kind) -> number of inputs (0) or outputs (1), (kind, i, field) -> bytes, type code, bits
+  PrintNewLine(code_stream_);
+  t0 << "int " << func_name << "_io_info_(void* args, int* type_codes, int num_args, ";
+  t0 << "void* out_ret_value, int* out_ret_tcode, void* resource_handle) {";
+  PrintOneLine(code_stream_, t0);
+  EnterScope();
+  PrintOneLine(code_stream_, "int64_t *values = (int64_t *)args;");
+  PrintOneLine(code_stream_, "if (num_args < 3) {");
+  EnterScope();
+  t0 << "*(int64_t *)out_ret_value = values[0] == 0 ? " << io_info[0].size() << " : "
+     << io_info[1].size() << ";";
+  PrintOneLine(code_stream_, t0);
+  ExitScope();
+  PrintOneLine(code_stream_, "} else if (values[0] == 0) {");
+  EnterScope();
+  t0 << "*(int64_t *)out_ret_value = " << func_name << "_input_info_[values[1]][values[2]];";
+  PrintOneLine(code_stream_, t0);
+  ExitScope();
+  PrintOneLine(code_stream_, "} else {");
+  EnterScope();
+  t0 << "*(int64_t *)out_ret_value = " << func_name << "_output_info_[values[1]][values[2]];";
+  PrintOneLine(code_stream_, t0);
+  ExitScope();
+  PrintOneLine(code_stream_, "}");
+  // kDLInt
+  PrintOneLine(code_stream_, "*out_ret_tcode = 0;");
+  PrintOneLine(code_stream_, "return 0;");
+  ExitScope();
+  PrintOneLine(code_stream_, "}");
+}
+
 void CodegenRef::CreateMallocBuf(string name, std::vector<int> shape, string dtype) {
   int out_size = 1;
   for (size_t i = 0; i < shape.size(); ++i) {
@@ -110,26 +693,64 @@ void CodegenRef::CreateMallocBuf(string name, std::vector<int> shape, string dty
   malloc_buf(name, out_size);
 }
 
+std::vector<std::pair<string, int>> CodegenRef::WrapperBuffers(const Array<Var>& args) {
+  std::vector<std::pair<string, int>> buffers;
+  string weight_dtype = cfg->dtype_weight;
+  for (const auto& arg : args) {
+    if (GetDtypeString(arg) != "float") {
+      continue;
+    }
+    int size = 1;
+    if (weight_dtype == "float16" || weight_dtype == "bfloat16" || weight_dtype == "int16_t") {
+      size = size * 2;
+    }
+    for (auto dim : GetShape(arg->checked_type())) {
+      size = size * dim;
+    }
+    buffers.push_back({"__" + replace(arg->name_hint()), size});
+  }
+  for (uint i = 0; i < output_list_.size(); i++) {
+    if (output_list_[i].call == NULL) {
+      continue;
+    }
+    int size = output_list_[i].size;
+    if (output_list_[i].dtype == "float" || output_list_[i].dtype == "int32_t") {
+      size *= 4;
+    } else if (output_list_[i].dtype == "float16" || output_list_[i].dtype == "bfloat16" ||
+               output_list_[i].dtype == "int16_t") {
+      size *= 2;
+    }
+    buffers.push_back({"out_q_" + to_string(i), size});
+  }
+  return buffers;
+}
+
 void CodegenRef::GenerateBackendCFunc(const string& func_name, const Array<Var>& args,
                                       const Output& out) {
   PrintNewLine(code_stream_);
   std::ostringstream t0;
   string in_dtype = cfg->dtype_input;
   string weight_dtype = cfg->dtype_weight;
-  PrintNewLine(code_stream_);
-  t0 << "int " << func_name << "_runtime_wrapper_(";
-  t0 << "int64_t* arg_value, ";
-  t0 << "int64_t* arg_type, ";
-  t0 << "int64_t* arg_size, ";
-  t0 << "int64_t* ret_vale, int64_t* ret_type_code" << args.size() << ") {";
-  PrintOneLine(code_stream_, t0);
-
-  EnterScope();
-  PrintOneLine(code_stream_, "char** inputs = (char**)arg_value[0];");
-  PrintOneLine(code_stream_, "char** outputs = (char**)arg_value[1];");
-  PrintOneLine(code_stream_, "char *params_base = (char *)arg_value[2];");
-
   string out_dtype = GetCSINNDtype(weight_dtype);
+  auto buffers = WrapperBuffers(args);
+  std::map<string, int> buffer_size(buffers.begin(), buffers.end());
+
+  // The conversion tensors are created once per session in the static memory
+  // plan, setup holds what they are created with and run what every run redoes.
+  std::vector<string> setup;
+  std::vector<string> run;
+  std::vector<string> io_tensors;
+  auto buffer_decl = [&](const string& dtype, const string& name) {
+    std::ostringstream decl;
+    decl << dtype << " *" << name << " = (" << dtype << " *)";
+    if (static_memory_plan_) {
+      decl << "(arena + " << arena_planner_.GetOffset(name) << ");";
+    } else {
+      decl << "malloc(" << buffer_size[name] << ");";
+    }
+    return decl.str();
+  };
+  std::vector<string> buffer_decls;
 
   for (uint i = 0; i < args.size(); i++) {
     const auto& dtype_str = GetDtypeString(args[i]);
@@ -140,69 +761,62 @@ void CodegenRef::GenerateBackendCFunc(const string& func_name, const Array<Var>&
     }
     QuantParams q_params = iter->second;
     auto ishape = GetShape(args[i]->checked_type());
-    int size = 1;
-    if (weight_dtype == "float16" || weight_dtype == "bfloat16" || weight_dtype == "int16_t") {
-      size = size * 2;
-    }
-    for (uint j = 0; j < ishape.size(); j++) {
-      size = size * ishape[j];
-    }
     if (dtype_str == "float") {
-      t0 << weight_dtype << "* __" << new_name << " = (" << weight_dtype << "*)malloc(" << size
-         << ");";
-      PrintOneLine(code_stream_, t0);
+      buffer_decls.push_back(buffer_decl(weight_dtype, "__" + new_name));
       string in_name = "(" + dtype_str + "*)inputs[" + to_string(i) + "]";
 
       string in_tensor = "input_" + to_string(i);
+      io_tensors.push_back(in_tensor);
       t0 << "struct csi_tensor *" << in_tensor << " = csi_alloc_tensor(NULL);";
-      PrintOneLine(code_stream_, t0);
-      t0 << in_tensor << "->data = " << in_name << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << in_tensor << "->dim_count = " << ishape.size() << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       for (uint j = 0; j < ishape.size(); j++) {
         t0 << in_tensor << "->dim[" << j << "] = " << ishape[j] << ";";
-        PrintOneLine(code_stream_, t0);
+        setup.push_back(t0.str());
+        t0.str("");
       }
 
       string qin_tensor = "qinput_" + to_string(i);
-      PrintOneLine(code_stream_, t0);
+      io_tensors.push_back(qin_tensor);
       t0 << "struct csi_tensor *" << qin_tensor << " = csi_alloc_tensor(NULL);";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << "csi_tensor_copy(" << qin_tensor << ", " << in_tensor << ");";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qin_tensor << "->data = __" << new_name << ";";
-      PrintOneLine(code_stream_, t0);
-
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qin_tensor << "->qinfo = (struct csi_quant_info *)(params_base + " << q_params.offset
          << ");";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qin_tensor << "->quant_channel =  " << q_params.q_size << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qin_tensor << "->dtype = " << out_dtype << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
+
+      t0 << in_tensor << "->data = " << in_name << ";";
+      run.push_back(t0.str());
+      t0.str("");
       t0 << "csi_ref_nn_init(" << in_tensor << ", " << qin_tensor << ");";
-      PrintNewLine(t0);
-      PrintOneLine(code_stream_, t0);
+      run.push_back(t0.str());
+      t0.str("");
     } else if (dtype_str == "uint8_t" || dtype_str == "int8_t") {
       t0 << weight_dtype << "* __" << new_name
          << " = (" + weight_dtype + "*)inputs[" + to_string(i) + "];";
-      PrintOneLine(code_stream_, t0);
+      run.push_back(t0.str());
+      t0.str("");
     }
   }
 
   for (uint i = 0; i < output_list_.size(); i++) {
-    // if (weight_dtype == "float16" || weight_dtype == "bfloat16") {
-    //   size = size * 2;
-    // }
     uint out_dim_count = output_list_[i].shape.size();
-    int size = output_list_[i].size;
-    if (output_list_[i].dtype == "float" || output_list_[i].dtype == "int32_t") {
-      size *= 4;
-    } else if (output_list_[i].dtype == "float16" || output_list_[i].dtype == "bfloat16" ||
-               output_list_[i].dtype == "int16_t") {
-      size *= 2;
-    }
     if (output_list_[i].call != NULL) {
       auto iter = io_nodes.find(output_list_[i].name);
       if (iter == io_nodes.end()) {
@@ -210,56 +824,131 @@ void CodegenRef::GenerateBackendCFunc(const string& func_name, const Array<Var>&
       }
       QuantParams q_params = iter->second;
 
-      t0 << output_list_[i].dtype << "* out_q_" << i << " = (" << output_list_[i].dtype
-         << " *)malloc(" << size << ");";
-      PrintNewLine(t0);
-      PrintOneLine(code_stream_, t0);
+      buffer_decls.push_back(buffer_decl(output_list_[i].dtype, "out_q_" + to_string(i)));
       auto out_dtype = DType2String(GetType(output_list_[i].call->checked_type()));
       string out_tensor = "output_" + to_string(i);
+      io_tensors.push_back(out_tensor);
       t0 << "struct csi_tensor *" << out_tensor << " = csi_alloc_tensor(NULL);";
-      PrintOneLine(code_stream_, t0);
-      t0 << out_tensor << "->data = "
-         << "outputs[" << i << "];";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << out_tensor << "->dtype = " << GetCSINNDtype(out_dtype) << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << out_tensor << "->layout = " << GetCSINNActLayout(q_params.shape) << ";";
-      PrintNewLine(t0);
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
 
       string qout_tensor = "qoutput_" + to_string(i);
+      io_tensors.push_back(qout_tensor);
       t0 << "struct csi_tensor *" << qout_tensor << " = csi_alloc_tensor(NULL);";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qout_tensor << "->data = out_q_" << i << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       uint dim_count = out_dim_count == 0 ? 1 : out_dim_count;
       t0 << qout_tensor << "->dim_count = " << dim_count << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       if (out_dim_count == 0) {
         t0 << qout_tensor << "->dim[" << 0 << "] = 1;";
-        PrintOneLine(code_stream_, t0);
+        setup.push_back(t0.str());
+        t0.str("");
       }
       for (uint j = 0; j < out_dim_count; j++) {
         t0 << qout_tensor << "->dim[" << j << "] = " << output_list_[i].shape[j] << ";";
-        PrintOneLine(code_stream_, t0);
+        setup.push_back(t0.str());
+        t0.str("");
       }
       t0 << qout_tensor << "->qinfo = (struct csi_quant_info *)(params_base + " << q_params.offset
          << ");";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qout_tensor << "->quant_channel = " << q_params.q_size << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qout_tensor << "->dtype = " << GetCSINNDtype(output_list_[i].dtype) << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
       t0 << qout_tensor << "->layout = " << GetCSINNActLayout(q_params.shape) << ";";
-      PrintOneLine(code_stream_, t0);
+      setup.push_back(t0.str());
+      t0.str("");
+
+      t0 << out_tensor << "->data = "
+         << "outputs[" << i << "];";
+      run.push_back(t0.str());
+      t0.str("");
     } else {
       t0 << in_dtype << " *out_" << i << " = (" << in_dtype << " *)outputs[" << i << "];";
-      PrintOneLine(code_stream_, t0);
+      run.push_back(t0.str());
+      t0.str("");
     }
+  }
+
+  string io_state = func_name + "_io_state_";
+  if (static_memory_plan_ && !io_tensors.empty()) {
+    t0 << "struct " << io_state << " {";
+    PrintOneLine(code_stream_, t0);
+    EnterScope();
+    PrintOneLine(code_stream_, "char *params_base;");
+    for (const auto& tensor : io_tensors) {
+      PrintOneLine(code_stream_, "struct csi_tensor *" + tensor + ";");
+    }
+    ExitScope();
+    PrintOneLine(code_stream_, "};");
+    PrintNewLine(code_stream_);
+  }
+
+  t0 << "int " << func_name << "_runtime_wrapper_(";
+  t0 << "int64_t* arg_value, ";
+  t0 << "int64_t* arg_type, ";
+  t0 << "int64_t* arg_size, ";
+  t0 << "int64_t* ret_vale, int64_t* ret_type_code" << args.size() << ") {";
+  PrintOneLine(code_stream_, t0);
+
+  EnterScope();
+  PrintOneLine(code_stream_, "char** inputs = (char**)arg_value[0];");
+  PrintOneLine(code_stream_, "char** outputs = (char**)arg_value[1];");
+  PrintOneLine(code_stream_, "char *params_base = (char *)arg_value[2];");
+  if (static_memory_plan_) {
+    PrintOneLine(code_stream_, "char *arena = (char *)arg_value[3];");
+  }
+  if (layer_profile_) {
+    // the time of layer k in ns is accumulated into layer_time[k], NULL to not profile
+    PrintOneLine(code_stream_, "int64_t *layer_time = (int64_t *)arg_value[4];");
+  }
+  for (const auto& decl : buffer_decls) {
+    PrintOneLine(code_stream_, decl);
+  }
+  PrintNewLine(code_stream_);
 
-    PrintNewLine(t0);
+  if (static_memory_plan_ && !io_tensors.empty()) {
+    t0 << "struct " << io_state << " *io_state_ = (struct " << io_state << " *)(arena + "
+       << arena_planner_.GetOffset(io_state) << ");";
     PrintOneLine(code_stream_, t0);
+    PrintOneLine(code_stream_, "if (io_state_->params_base != params_base) {");
+    EnterScope();
+    for (const auto& line : setup) {
+      PrintOneLine(code_stream_, line);
+    }
+    for (const auto& tensor : io_tensors) {
+      PrintOneLine(code_stream_, "io_state_->" + tensor + " = " + tensor + ";");
+    }
+    PrintOneLine(code_stream_, "io_state_->params_base = params_base;");
+    ExitScope();
+    PrintOneLine(code_stream_, "}");
+    for (const auto& tensor : io_tensors) {
+      PrintOneLine(code_stream_, "struct csi_tensor *" + tensor + " = io_state_->" + tensor + ";");
+    }
+  } else {
+    for (const auto& line : setup) {
+      PrintOneLine(code_stream_, line);
+    }
+  }
+  for (const auto& line : run) {
+    PrintOneLine(code_stream_, line);
   }
+  PrintNewLine(code_stream_);
 
   t0 << func_name << "_(";
   for (const auto& arg : args) {
@@ -274,7 +963,14 @@ void CodegenRef::GenerateBackendCFunc(const string& func_name, const Array<Var>&
       t0 << "out_" << i << ", ";
     }
   }
-  t0 << "params_base);\n";
+  t0 << "params_base";
+  if (static_memory_plan_) {
+    t0 << ", arena";
+  }
+  if (layer_profile_) {
+    t0 << ", layer_time";
+  }
+  t0 << ");\n";
 
   for (uint i = 0; i < output_list_.size(); i++) {
     auto out_node = output_list_[i].call;
@@ -282,7 +978,9 @@ void CodegenRef::GenerateBackendCFunc(const string& func_name, const Array<Var>&
       t0 << "  csi_tensor_data_convert("
          << "output_" << i << ", "
          << "qoutput_" << i << ");\n";
-      t0 << "  csi_mem_free(out_q_" << i << ");\n";
+      if (!static_memory_plan_) {
+        t0 << "  csi_mem_free(out_q_" << i << ");\n";
+      }
     }
   }
 
@@ -311,7 +1009,6 @@ string CodegenRef::JitImpl(const string& ext_func_id, const Array<Var>& args,
                            const std::vector<Output>& out) {
   string in_dtype = cfg->dtype_weight;
   string hybrid_in_dtype = hybrid_cfg->dtype_weight;
-  string base_dtype = GetCSINNDtype(in_dtype);
 
   // Create headers
   code_stream_ << "#include <csi_ref.h>\n\n";
@@ -323,6 +1020,21 @@ string CodegenRef::JitImpl(const string& ext_func_id, const Array<Var>& args,
     code_stream_ << "#define int4_t int8_t\n\n";
   }
   std::ostringstream t0;
+  if (layer_profile_) {
+    code_stream_ << "#include <time.h>\n\n";
+    t0 << "static int64_t " << ext_func_id << "_now_(void) {";
+    PrintOneLine(code_stream_, t0);
+    EnterScope();
+    PrintOneLine(code_stream_, "struct timespec ts;");
+    PrintOneLine(code_stream_, "clock_gettime(CLOCK_MONOTONIC, &ts);");
+    PrintOneLine(code_stream_, "return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;");
+    ExitScope();
+    PrintOneLine(code_stream_, "}");
+    PrintNewLine(code_stream_);
+  }
+  if (static_memory_plan_) {
+    EmitStateSetup(ext_func_id);
+  }
   t0 << "void *" << ext_func_id << "_(";
 
   CHECK_EQ(out.size(), 1U) << "Internal error: only single output is support.";
@@ -336,36 +1048,53 @@ string CodegenRef::JitImpl(const string& ext_func_id, const Array<Var>& args,
     t0 << output_list_[i].dtype << "* out_" << i << ", ";
   }
 
-  t0 << "char *params_base) {";
+  t0 << "char *params_base";
+  if (static_memory_plan_) {
+    t0 << ", char *arena";
+  }
+  if (layer_profile_) {
+    t0 << ", int64_t *layer_time";
+  }
+  t0 << ") {";
   PrintOneLine(code_stream_, t0);
   EnterScope();
 
-  PrintOneLine(code_stream_, "struct csi_session *sess = csi_alloc_session();");
-  std::ostringstream sess_dtype;
-  sess_dtype << "sess->base_dtype = " << base_dtype << ";";
-  PrintOneLine(code_stream_, sess_dtype);
-  PrintOneLine(code_stream_, "sess->base_layout = CSINN_LAYOUT_" + layout_ + ";");
-  PrintOneLine(code_stream_, "sess->base_run_mode = CSINN_RM_LAYER;");
-  PrintOneLine(code_stream_, "sess->base_api = " + target_name_ + ";");
-  if (debug_level_ == "INFO") {
-    PrintOneLine(code_stream_, "csi_debug_set_level(CSI_DEBUG_LEVEL_INFO);");
-  }
+  if (static_memory_plan_) {
+    t0 << "/* arena size: " << arena_planner_.ArenaSize() << " bytes */";
+    PrintOneLine(code_stream_, t0);
+    // the sessions, tensors and params are created on the first run, and
+    // again if the params move, e.g. after load_params
+    string state_type = "struct " + ext_func_id + "_state_";
+    t0 << state_type << " *state_ = (" << state_type << " *)(arena + "
+       << arena_planner_.GetOffset(ext_func_id + "_state_") << ");";
+    PrintOneLine(code_stream_, t0);
+    PrintOneLine(code_stream_, "if (state_->params_base != params_base) {");
+    EnterScope();
+    PrintOneLine(code_stream_, ext_func_id + "_setup_(state_, params_base);");
+    ExitScope();
+    PrintOneLine(code_stream_, "}");
+    for (const auto& var : state_vars_) {
+      PrintOneLine(code_stream_, var.first + var.second + " = state_->" + var.second + ";");
+    }
+  } else {
+    EmitSessions();
 
-  // Function body
-  PrintNewLine(code_stream_);
-  for (auto decl : buf_decl) {
-    PrintOneLine(code_stream_, decl);
+    // Function body
+    PrintNewLine(code_stream_);
+    for (auto decl : buf_decl) {
+      PrintOneLine(code_stream_, decl);
+    }
   }
 
   PrintNewLine(code_stream_);
-  for (auto stmt : body) {
-    PrintOneLine(code_stream_, stmt);
-  }
+  EmitLayerGroups(body);
 
   // free hybrid buffer
   for (auto item : hybrid_buffer_name_) {
-    PrintOneLine(code_stream_, "csi_mem_free(" + item + "->data);");
-    PrintOneLine(code_stream_, "csi_mem_free(" + item + ");");
+    if (!static_memory_plan_) {
+      PrintOneLine(code_stream_, "csi_mem_free(" + item + "->data);");
+      PrintOneLine(code_stream_, "csi_mem_free(" + item + ");");
+    }
   }
 
   PrintNewLine(code_stream_);
@@ -382,7 +1111,7 @@ string CodegenRef::JitImpl(const string& ext_func_id, const Array<Var>& args,
        << "out_" << i << ", " << output_list_[i].name << "->data, " << out_size << ");";
 
     PrintOneLine(code_stream_, t0);
-    if (!output_list_[i].is_const) {
+    if (!output_list_[i].is_const && !static_memory_plan_) {
       t0 << "csi_mem_free(" << output_list_[i].name << "->data);";
       PrintOneLine(code_stream_, t0);
     }
@@ -392,6 +1121,9 @@ string CodegenRef::JitImpl(const string& ext_func_id, const Array<Var>& args,
   ExitScope();
   PrintOneLine(code_stream_, "}");
 
+  EmitArenaSize(ext_func_id);
+  EmitLayerProfile(ext_func_id);
+  EmitIOInfo(ext_func_id, args);
   this->GenerateBackendCFunc(ext_func_id, args, out[0]);
 
   DumpConstant();
@@ -400,6 +1132,9 @@ string CodegenRef::JitImpl(const string& ext_func_id, const Array<Var>& args,
 }
 
 string CodegenRef::JIT(const std::vector<Output>& out) {
+  layer_groups_ = ScheduleLayers();
+  PlanArena();
+  InstrumentLayers(ext_func_id_);
   return JitImpl(ext_func_id_, ext_func_args_, buf_decl_, ext_func_body, out);
 }
 
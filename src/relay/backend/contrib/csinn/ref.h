@@ -24,10 +24,13 @@
 #ifndef TVM_RELAY_BACKEND_CONTRIB_CSINN_REF_H_
 #define TVM_RELAY_BACKEND_CONTRIB_CSINN_REF_H_
 
+#include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "csinn.h"
+#include "memory_plan.h"
 
 namespace tvm {
 namespace relay {
@@ -50,6 +53,82 @@ class CodegenRef : public CodegenCSINN {
   void CreateMallocBuf(string name, std::vector<int> shape, string dtype);
   void CreateTensorSessData();
   void CreateHybridTensorSessData(std::vector<int> shape, string dtype);
+  void FreeTensorData(string name);
+  void BindTensorBuffer(string tensor, string buffer);
+
+ protected:
+  /*! \brief Emit the allocation of a data buffer, from the arena if static_memory_plan_. */
+  void EmitBufferAlloc(string name, string dtype, int size);
+  /*! \brief Layers without dependencies between each other, run concurrently. */
+  struct LayerGroup {
+    /*! \brief Statement indices of each layer of the group. */
+    std::vector<std::vector<size_t>> layers;
+    /*! \brief The index of each layer of the group, as in layer_call_index_. */
+    std::vector<size_t> ids;
+    /*! \brief Statements run once every layer of the group is done, e.g. frees. */
+    std::vector<size_t> tail;
+  };
+  /*!
+   * \brief Split ext_func_body into layers and group them by their depth in the graph.
+   * \return The groups in execution order, empty to run the body as emitted.
+   */
+  std::vector<LayerGroup> ScheduleLayers();
+  /*! \brief The position of each statement of ext_func_body once scheduled. */
+  std::vector<int> ScheduledSteps();
+  /*! \brief Print the body following layer_groups_. */
+  void EmitLayerGroups(const std::vector<string>& body);
+  /*!
+   * \brief Emit a session for every concurrent section past the first, the
+   *  layers of a section are rebound to its session before they run.
+   */
+  void EmitSectionSessions();
+  /*! \brief Emit the session of the graph, then those of the sections. */
+  void EmitSessions();
+  /*! \brief The number of concurrent sections of the widest layer group. */
+  size_t NumSections() const;
+  /*! \brief Plan the arena and patch the offsets into the emitted allocations. */
+  void PlanArena();
+  /*! \brief Emit the packed function reporting the arena size to the runtime. */
+  void EmitArenaSize(const string& func_name);
+  /*!
+   * \brief Rewrite buf_decl into the body of the one-time setup of a session
+   *  and record the variables it declares into state_vars_.
+   */
+  std::vector<string> SetupDecls(const std::vector<string>& buf_decl);
+  /*!
+   * \brief Emit the state of a session and the function filling it, which
+   *  creates the sessions, tensors and params the runs reuse.
+   */
+  void EmitStateSetup(const string& func_name);
+  /*!
+   * \brief The buffers the wrapper converts the inputs and outputs in, with
+   *  their size in bytes, taken from the arena in the static memory plan.
+   */
+  virtual std::vector<std::pair<string, int>> WrapperBuffers(const Array<Var>& args);
+  /*!
+   * \brief Wrap every layer call with timing into the buffer set by the
+   *  runtime, and record the bytes each layer reads and writes.
+   */
+  void InstrumentLayers(const string& func_name);
+  /*! \brief Emit the packed functions the runtime profiles the layers with. */
+  void EmitLayerProfile(const string& func_name);
+  /*! \brief Emit the packed function reporting the dtype and size of every input and output. */
+  void EmitIOInfo(const string& func_name, const Array<Var>& args);
+
+  std::vector<LayerGroup> layer_groups_;
+  ArenaPlanner arena_planner_;
+  /*! \brief The data buffer of each tensor. */
+  std::map<string, string> tensor_buffer_;
+  /*! \brief The statement of ext_func_body allocating each buffer. */
+  std::map<string, size_t> arena_lines_;
+  /*! \brief The buffers of inputs converted for hybrid quantization. */
+  std::vector<string> hybrid_buffers_;
+  /*! \brief Bytes read and written by each layer, for the layer profile. */
+  std::vector<std::pair<size_t, size_t>> layer_bytes_;
+  /*! \brief buf_decl rewritten by SetupDecls. */
+  std::vector<string> setup_decl_;
+  /*! \brief The type and name of every variable kept in the session state. */
+  std::vector<std::pair<string, string>> state_vars_;
 };
 
 }  // namespace contrib
@@ -31,13 +31,16 @@
 #include <tvm/relay/op.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/te/schedule.h>
 #include <tvm/te/schedule_pass.h>
 #include <tvm/topi/tags.h>
 
 #include <functional>
 #include <limits>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -47,6 +50,7 @@
 #include "../op/call/call.h"
 #include "../transforms/device_aware_visitors.h"
 #include "./te_compiler_cache.h"
+#include "./te_compiler_disk_cache.h"
 #include "./utils.h"
 
 namespace tvm {
@@ -73,6 +77,51 @@ class TECompilerImpl : public TECompilerNode {
     return Lower(key, mangle_fn);
   }
 
+  void LowerBatch(const std::vector<CCacheKey>& keys, const String mod_name,
+                  int num_threads) final {
+    auto mangle_fn = [mod_name](String name) { return runtime::get_name_mangled(mod_name, name); };
+    struct Pending {
+      CCacheKey key;
+      CCacheValue value;
+      CachedFunc cfunc;
+      std::string name;
+    };
+    // Building the schedules may call back into the frontend, so it stays on this thread.
+    std::vector<Pending> pending;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (const auto& key : keys) {
+        if (key->source_func->GetAttr<String>(attr::kCompiler).defined() || cache_.count(key)) {
+          continue;
+        }
+        // Lower counts the use.
+        CCacheValue value(make_object<CCacheValueNode>());
+        value->use_count = 0;
+        cache_[key] = value;
+        cur_ccache_key_ = key;
+        std::string name;
+        CachedFunc cfunc = ScheduleInternal(key, value, mangle_fn, &name);
+        if (cfunc.defined()) {
+          pending.push_back({key, value, cfunc, name});
+        }
+      }
+    }
+    std::vector<IRModule> lowered(pending.size());
+    PassContext pass_ctx = PassContext::Current();
+    int num_pending = static_cast<int>(pending.size());
+    support::parallel_for_dynamic(0, num_pending, num_threads, [&](int /*thread_id*/, int i) {
+      With<PassContext> pass_ctx_scope(pass_ctx);
+      With<Target> target_scope(pending[i].cfunc->target);
+      lowered[i] = LowerCachedSchedule(pending[i].cfunc);
+    });
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < pending.size(); ++i) {
+      pending[i].cfunc->funcs->Update(lowered[i]);
+      pending[i].value->cached_func = pending[i].cfunc;
+      StoreToDiskCache(pending[i].key, pending[i].name, pending[i].cfunc);
+    }
+  }
+
   // For now, build one module per function.
   PackedFunc JIT(const CCacheKey& key) final {
     auto mangle_fn = [](String name) { return name; };
@@ -177,7 +226,10 @@ class TECompilerImpl : public TECompilerNode {
     return ret;
   }
 
-  void Clear() final { cache_.clear(); }
+  void Clear() final {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
+  }
 
   // List all items in the cache.
   Array<ObjectRef> ListItems() {
@@ -213,6 +265,26 @@ class TECompilerImpl : public TECompilerNode {
     }
     cur_ccache_key_ = key;
 
+    std::string name;
+    CachedFunc cfunc = ScheduleInternal(key, value, mangle_fn, &name);
+    if (cfunc.defined()) {
+      // Enforce use the target.
+      With<Target> target_scope(key->target);
+      cfunc->funcs->Update(LowerCachedSchedule(cfunc));
+      value->cached_func = cfunc;
+      StoreToDiskCache(key, name, cfunc);
+    }
+    return value;
+  }
+
+  /*!
+   * \brief Build the schedule of a function, the caller holds mutex_.
+   * \param name Set to the name of the function before mangling.
+   * \return The cached function whose schedule remains to be lowered, or an undefined one
+   *  when value->cached_func is already complete.
+   */
+  CachedFunc ScheduleInternal(const CCacheKey& key, const CCacheValue& value,
+                              std::function<String(String)> mangle_fn, std::string* name) {
     // No need to lower external functions for now. We will invoke the external
     // codegen tool once and lower all functions together.
     if (key->source_func->GetAttr<String>(attr::kCompiler).defined()) {
@@ -226,15 +298,31 @@ class TECompilerImpl : public TECompilerNode {
       ir_module->Add(global_var, key->source_func);
       value->cached_func = CachedFunc(target, global_var, {}, {}, te::Schedule{nullptr},
                                       tir::PrimFunc{nullptr}, {}, ir_module);
-      return value;
+      return CachedFunc();
+    }
+
+    if (const DiskCache* disk_cache = GetDiskCache()) {
+      tir::PrimFunc func = disk_cache->Load(key, name);
+      if (func.defined()) {
+        auto func_name = GetUniqueName(mangle_fn(*name), &name_map_);
+        auto prim_fn_var = GlobalVar(func_name);
+        prim_fn_var->checked_type_ = key->source_func->checked_type();
+        IRModule funcs;
+        funcs->Add(GlobalVar(func_name),
+                   WithAttr(std::move(func), tvm::attr::kGlobalSymbol, String(func_name)));
+        value->cached_func = CachedFunc(key->target, prim_fn_var, {}, {}, te::Schedule{nullptr},
+                                        tir::PrimFunc{nullptr}, {}, funcs);
+        return CachedFunc();
+      }
     }
 
     // Enforce use the target.
     With<Target> target_scope(key->target);
 
     ICHECK(!value->cached_func.defined());
-    auto cfunc = PrimFuncFor(key->source_func, key->target, [&](std::string name) {
-      auto mangled = mangle_fn(name);
+    auto cfunc = PrimFuncFor(key->source_func, key->target, [&](std::string candidate) {
+      *name = candidate;
+      auto mangled = mangle_fn(candidate);
       return GetUniqueName(mangled, &name_map_);
     });
 
@@ -243,24 +331,52 @@ class TECompilerImpl : public TECompilerNode {
     if (const CallNode* call_node = body.as<CallNode>()) {
       if (call_node->attrs.as<DeviceCopyAttrs>()) {
         value->cached_func = cfunc;
-        return value;
+        return CachedFunc();
       }
     }
     if (cfunc->prim_func.defined()) {
       cfunc->funcs->Update(cfunc->prim_fn_var, cfunc->prim_func.value());
-    } else {
-      // NOTE: array will copy on write.
-      Array<te::Tensor> all_args = Array<te::Tensor>(cfunc->inputs);
-      for (te::Tensor arg : cfunc->outputs) {
-        all_args.push_back(arg);
-      }
-      // lower the function
-      std::unordered_map<te::Tensor, tir::Buffer> binds;
-      auto func_name = cfunc->prim_fn_var->name_hint;
-      cfunc->funcs->Update(tvm::LowerSchedule(cfunc->schedule, all_args, func_name, binds));
+      value->cached_func = cfunc;
+      return CachedFunc();
+    }
+    return cfunc;
+  }
+
+  // the disk cache of the current PassContext, nullptr when disabled.
+  const DiskCache* GetDiskCache() {
+    PassContext pass_ctx = PassContext::Current();
+    if (!disk_cache_ctx_.same_as(pass_ctx)) {
+      disk_cache_ = DiskCache::Create(pass_ctx);
+      disk_cache_ctx_ = pass_ctx;
+    }
+    // the AutoTVM context may change within one PassContext.
+    if (disk_cache_ == nullptr || DiskCache::UsingTunedConfigs()) {
+      return nullptr;
+    }
+    return disk_cache_.get();
+  }
+
+  // add the function lowered from a schedule to the disk cache.
+  void StoreToDiskCache(const CCacheKey& key, const std::string& name, const CachedFunc& cfunc) {
+    const DiskCache* disk_cache = GetDiskCache();
+    if (disk_cache == nullptr || cfunc->funcs->functions.size() != 1) {
+      return;
+    }
+    if (const auto* func = (*cfunc->funcs->functions.begin()).second.as<tir::PrimFuncNode>()) {
+      disk_cache->Store(key, name, GetRef<tir::PrimFunc>(func));
     }
-    value->cached_func = cfunc;
-    return value;
+  }
+
+  // lower the schedule of a function, only reads cfunc so it can run on any thread.
+  static IRModule LowerCachedSchedule(const CachedFunc& cfunc) {
+    // NOTE: array will copy on write.
+    Array<te::Tensor> all_args = Array<te::Tensor>(cfunc->inputs);
+    for (te::Tensor arg : cfunc->outputs) {
+      all_args.push_back(arg);
+    }
+    std::unordered_map<te::Tensor, tir::Buffer> binds;
+    auto func_name = cfunc->prim_fn_var->name_hint;
+    return tvm::LowerSchedule(cfunc->schedule, all_args, func_name, binds);
   }
 
   // implement lowered shape func
@@ -312,6 +428,9 @@ class TECompilerImpl : public TECompilerNode {
   std::unordered_map<CCacheKey, CCacheValue> shape_func_cache_;
   /*! \brief the cache key of the function that is being lowered currently*/
   CCacheKey cur_ccache_key_;
+  /*! \brief the persistent cache, created for disk_cache_ctx_ */
+  std::unique_ptr<DiskCache> disk_cache_;
+  PassContext disk_cache_ctx_;
 };
 
 TECompiler::TECompiler() {
@@ -456,6 +575,12 @@ class LowerTensorExprMutator : public DeviceAwareExprMutator {
     return Function();
   }
 
+  /*!
+   * \brief Only record the cache keys of the primitive functions in \p keys, in the order they
+   *  are lowered, without lowering anything or calling process_fn.
+   */
+  void CollectKeysOnly(std::vector<CCacheKey>* keys) { collected_keys_ = keys; }
+
   /*!
    * \brief Lowers the primitive function \p func to TIR for ultimate execution
    * on a device with configuration \p target. Returns the global var bound
@@ -464,6 +589,10 @@ class LowerTensorExprMutator : public DeviceAwareExprMutator {
    */
   Expr MakeLoweredCall(Function func, Array<Expr> visited_args, Array<Type> type_args, Span span,
                        Target target) {
+    if (collected_keys_ != nullptr) {
+      collected_keys_->push_back(CCacheKey(func, target));
+      return Call(func, visited_args, Attrs(), type_args, span);
+    }
     if (func->GetAttr<String>(attr::kCompiler).defined()) {
       // BYOC flow.
       CCacheKey key = CCacheKey(func, target);
@@ -611,7 +740,9 @@ class LowerTensorExprMutator : public DeviceAwareExprMutator {
     if (!prim_func.defined()) {
       // Not a call_node to a primitive function.
       if (const FunctionNode* fn = call_node->op.as<FunctionNode>()) {
-        this->process_fn_(GetRef<Function>(fn));
+        if (collected_keys_ == nullptr) {
+          this->process_fn_(GetRef<Function>(fn));
+        }
       }
       return ExprMutator::VisitExpr_(call_node);
     }
@@ -663,6 +794,8 @@ class LowerTensorExprMutator : public DeviceAwareExprMutator {
   TECompiler compiler_;
   // Cache ops that need to be frequently used later to reduce lookup overhead.
   const Op& debug_op_;
+  // Where the keys are recorded when only collecting them.
+  std::vector<CCacheKey>* collected_keys_ = nullptr;
 };
 
 Target GetTargetFromInteger(DLDeviceType dev_type, tec::TargetMap targets) {
@@ -699,6 +832,20 @@ Pass LowerTensorExpr(TargetMap targets, const String& module_name, TECompiler co
                      std::function<void(Function)> process_fn) {
   runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
       [=](Function func, IRModule module, PassContext ctx) {
+        // The primitive functions are hashed for their cache keys over and over, memoize the
+        // types, attributes and constants they are made of.
+        StructuralHashMemo hash_memo;
+        // Extra lowering passes may be written in the frontend, keep them on this thread.
+        int num_threads = GetNumBuildThreads();
+        if (num_threads > 1 && !ctx->config.count("tir.add_lower_pass")) {
+          // Lower all the primitive functions up front so that their schedules are lowered
+          // to TIR in parallel, the rewrite below then finds them in the cache.
+          std::vector<CCacheKey> keys;
+          LowerTensorExprMutator collector(module, targets, process_fn, module_name, compiler);
+          collector.CollectKeysOnly(&keys);
+          collector.Mutate(func);
+          compiler->LowerBatch(keys, module_name, num_threads);
+        }
         LowerTensorExprMutator lower_te(module, targets, process_fn, module_name, compiler);
         return Downcast<Function>(lower_te.Mutate(func));
       };
@@ -87,6 +87,17 @@ class TECompilerNode : public Object {
    */
   virtual CachedFunc Lower(const CCacheKey& key, const String mod_name) = 0;
 
+  /*!
+   * \brief Lower a batch of functions ahead of Lower, which then finds them in the cache.
+   *  The schedules are built in order on the calling thread and lowered to TIR on
+   *  num_threads threads.
+   * \param keys The keys of the functions, in the order Lower will see them.
+   * \param mod_name The module name used to mangle the function names.
+   * \param num_threads The number of threads.
+   */
+  virtual void LowerBatch(const std::vector<CCacheKey>& keys, const String mod_name,
+                          int num_threads) = 0;
+
   /* Return all functions which have been lowered by the compiler in an IRModule, annotated with
    * their target. */
   virtual IRModule GetLoweredFunctions() = 0;
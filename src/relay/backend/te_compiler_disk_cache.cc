@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/te_compiler_disk_cache.cc
+ * \brief A directory of lowered primitive functions shared by builds.
+ */
+#include "./te_compiler_disk_cache.h"
+
+#include <dmlc/common.h>
+#include <sys/stat.h>
+#include <tvm/node/serialization.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/registry.h>
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relay {
+namespace tec {
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.backend.compile_cache_dir", String);
+
+std::unique_ptr<DiskCache> DiskCache::Create(const transform::PassContext& pass_ctx) {
+  Optional<String> dir = pass_ctx->GetConfig<String>("relay.backend.compile_cache_dir");
+  if (!dir.defined() || dir.value().empty()) {
+    return nullptr;
+  }
+  if (pass_ctx->GetConfig<Bool>("relay.backend.use_auto_scheduler", Bool(false)).value() ||
+      pass_ctx->GetConfig<Bool>("relay.backend.use_meta_schedule", Bool(false)).value()) {
+    return nullptr;
+  }
+  std::ostringstream context;
+  context << TVM_VERSION << ";opt_level=" << pass_ctx->opt_level;
+  for (const String& name : pass_ctx->required_pass) {
+    context << ";+" << name;
+  }
+  for (const String& name : pass_ctx->disabled_pass) {
+    context << ";-" << name;
+  }
+  // the options that do not change the lowered functions are left out.
+  std::vector<std::pair<std::string, ObjectRef>> config;
+  for (const auto& kv : pass_ctx->config) {
+    if (kv.first != "relay.backend.compile_cache_dir" && kv.first != "tir.num_build_threads") {
+      config.emplace_back(kv.first, kv.second);
+    }
+  }
+  std::sort(config.begin(), config.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+  for (const auto& kv : config) {
+    context << ";" << kv.first << "=" << SaveJSON(kv.second);
+  }
+
+#if defined(_WIN32)
+  _mkdir(dir.value().c_str());
+#else
+  mkdir(dir.value().c_str(), 0755);
+#endif
+  return std::unique_ptr<DiskCache>(new DiskCache(dir.value(), context.str()));
+}
+
+bool DiskCache::UsingTunedConfigs() {
+  // registered by tvm.autotvm, not loaded without the python frontend
+  const runtime::PackedFunc* f = runtime::Registry::Get("autotvm.using_tuned_configs");
+  return f != nullptr && (*f)().operator bool();
+}
+
+std::string DiskCache::GetPath(const CCacheKey& key) const {
+  size_t hash = dmlc::HashCombine(key->Hash(), std::hash<std::string>()(context_));
+  std::ostringstream os;
+  os << dir_ << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+  return os.str();
+}
+
+tir::PrimFunc DiskCache::Load(const CCacheKey& key, std::string* name) const {
+  std::ifstream fs(GetPath(key), std::ios::in | std::ios::binary);
+  if (!fs) {
+    return tir::PrimFunc();
+  }
+  std::string blob((std::istreambuf_iterator<char>(fs)), std::istreambuf_iterator<char>());
+  try {
+    auto entry = Downcast<Map<String, ObjectRef>>(LoadBinary(blob));
+    if (Downcast<String>(entry["context"]) != context_ ||
+        Downcast<String>(entry["target"]) != key->target->str() ||
+        !StructuralEqual()(entry["source_func"], key->source_func)) {
+      return tir::PrimFunc();
+    }
+    *name = Downcast<String>(entry["name"]);
+    return Downcast<tir::PrimFunc>(entry["func"]);
+  } catch (const Error& e) {
+    LOG(WARNING) << "Ignore the corrupted compile cache entry " << GetPath(key) << ": "
+                 << e.what();
+    return tir::PrimFunc();
+  }
+}
+
+void DiskCache::Store(const CCacheKey& key, const std::string& name,
+                      const tir::PrimFunc& func) const {
+  Map<String, ObjectRef> entry;
+  entry.Set("context", String(context_));
+  entry.Set("target", String(key->target->str()));
+  entry.Set("source_func", key->source_func);
+  entry.Set("name", String(name));
+  entry.Set("func", func);
+  std::string path = GetPath(key);
+  // other builds may read the entry meanwhile, publish it with a rename.
+  std::ostringstream tmp;
+  tmp << path << ".tmp" << std::hash<std::thread::id>()(std::this_thread::get_id()) << "_"
+      << std::chrono::steady_clock::now().time_since_epoch().count();
+  {
+    std::ofstream fs(tmp.str(), std::ios::out | std::ios::binary);
+    fs << SaveBinary(entry);
+    if (fs.fail()) {
+      LOG(WARNING) << "Cannot write the compile cache entry " << tmp.str();
+      std::remove(tmp.str().c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp.str().c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Cannot write the compile cache entry " << path;
+    std::remove(tmp.str().c_str());
+  }
+}
+
+}  // namespace tec
+}  // namespace relay
+}  // namespace tvm
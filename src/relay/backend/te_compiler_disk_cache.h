@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/te_compiler_disk_cache.h
+ * \brief A directory of lowered primitive functions shared by builds.
+ */
+#ifndef TVM_RELAY_BACKEND_TE_COMPILER_DISK_CACHE_H_
+#define TVM_RELAY_BACKEND_TE_COMPILER_DISK_CACHE_H_
+
+#include <tvm/ir/transform.h>
+#include <tvm/tir/function.h>
+
+#include <memory>
+#include <string>
+
+#include "./te_compiler_cache.h"
+
+namespace tvm {
+namespace relay {
+namespace tec {
+
+/*!
+ * \brief A content addressed cache of the TIR lowered for primitive functions, kept in the
+ *  directory set by the "relay.backend.compile_cache_dir" PassContext option.
+ *
+ *  An entry is addressed by the structural hash of the primitive function, the target, the
+ *  PassContext and the TVM version, and holds the function itself so that hash collisions
+ *  are misses. Entries are written to a temporary file and renamed, so builds may share the
+ *  directory.
+ *
+ * \note Tuning records are not part of the address. The cache is disabled along with the
+ *  auto scheduler and meta schedule, and while an AutoTVM dispatch context other than the
+ *  fallback one is active.
+ */
+class DiskCache {
+ public:
+  /*!
+   * \brief Create the cache of a PassContext.
+   * \param pass_ctx The PassContext.
+   * \return The cache, nullptr when it is disabled.
+   */
+  static std::unique_ptr<DiskCache> Create(const transform::PassContext& pass_ctx);
+  /*!
+   * \return Whether the AutoTVM templates take their configs from tuning records or a
+   *  tuner, which the cache does not tell apart.
+   */
+  static bool UsingTunedConfigs();
+  /*!
+   * \brief Look a function up.
+   * \param key The key of the function.
+   * \param name Set to the name of the function before mangling.
+   * \return The lowered function, undefined on miss.
+   */
+  tir::PrimFunc Load(const CCacheKey& key, std::string* name) const;
+  /*!
+   * \brief Add a function, errors are logged and ignored.
+   * \param key The key of the function.
+   * \param name The name of the function before mangling.
+   * \param func The lowered function.
+   */
+  void Store(const CCacheKey& key, const std::string& name, const tir::PrimFunc& func) const;
+
+ private:
+  DiskCache(std::string dir, std::string context) : dir_(dir), context_(context) {}
+  /*! \return The path of the entry of key. */
+  std::string GetPath(const CCacheKey& key) const;
+
+  /*! \brief The cache directory. */
+  std::string dir_;
+  /*! \brief The options of the PassContext that change the lowering, and the TVM version. */
+  std::string context_;
+};
+
+}  // namespace tec
+}  // namespace relay
+}  // namespace tvm
+
+#endif  // TVM_RELAY_BACKEND_TE_COMPILER_DISK_CACHE_H_
@@ -60,6 +60,7 @@ namespace transform {
 Pass LambdaLift();
 Pass InlinePrimitives();
 Pass LabelOps();
+Pass StaticMemoryPlan();
 
 Pass MemoryPlan() {
   auto f = tvm::runtime::Registry::Get("relay.transform.MemoryPlan");
@@ -1001,6 +1002,14 @@ transform::Sequential MemoryOpt(tvm::Target host_target, tvm::TargetMap targets)
   // // Perform memory planning in order to coalesce/reduce allocations.
   // pass_seqs.push_back(transform::MemoryPlan());
 
+  // Pack the statically sized allocations into arenas, reusing dead storages.
+  bool static_memory_plan = transform::PassContext::Current()
+                                ->GetConfig<Bool>("relay.vm.static_memory_plan", Bool(false))
+                                .value();
+  if (static_memory_plan) {
+    pass_seqs.push_back(transform::StaticMemoryPlan());
+  }
+
   // Compute away constant computation introduced by coalescing allocations.
   pass_seqs.push_back(transform::FoldConstant());
 
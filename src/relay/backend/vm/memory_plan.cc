@@ -0,0 +1,362 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/relay/backend/vm/memory_plan.cc
+ * \brief Plan the static allocations of the VM into arenas at compile time.
+ */
+
+#include <tvm/relay/analysis.h>
+#include <tvm/relay/attrs/memory.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/expr_functor.h>
+#include <tvm/relay/transform.h>
+#include <tvm/runtime/logging.h>
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../../op/annotation/annotation.h"
+#include "../../op/memory/device_copy.h"
+#include "../../op/memory/memory.h"
+#include "../../transforms/pattern_utils.h"
+
+using namespace tvm::runtime;
+
+namespace tvm {
+namespace relay {
+namespace vm {
+
+/* After ManifestAlloc every static tensor gets its own storage:
+ *
+ * let %storage_0 = memory.alloc_storage(64, 64, ...);
+ * let %tensor_0 = memory.alloc_tensor(%storage_0, 0, [4, 4], ...);
+ * let %x = vm.invoke_tvm_op(fn, (%in), (%tensor_0));
+ * ...
+ *
+ * Within one let block, this pass computes how long every storage of constant
+ * size is alive and packs them into a single arena per device, reusing the
+ * bytes of the storages which died already:
+ *
+ * let %arena = memory.alloc_storage(128, 64, ...);
+ * let %tensor_0 = memory.alloc_tensor(%arena, 0, [4, 4], ...);
+ * let %tensor_1 = memory.alloc_tensor(%arena, 64, [4, 4], ...);
+ *
+ * A storage is only planned when its tensors are read or written by kernels
+ * (or reshaped into views which are), so nothing that can outlive the block
+ * ends up in the arena. Dynamically sized storages and regions under control
+ * flow keep their own allocations.
+ */
+class StaticMemoryPlanner : public ExprMutator {
+ public:
+  Expr VisitExpr_(const FunctionNode* func) final {
+    if (func->HasNonzeroAttr(attr::kPrimitive)) {
+      return GetRef<Function>(func);
+    }
+    return ExprMutator::VisitExpr_(func);
+  }
+
+  Expr VisitExpr_(const LetNode* let_node) final {
+    std::vector<std::pair<Var, Expr>> bindings;
+    Expr body = GetRef<Let>(let_node);
+    while (const auto* node = body.as<LetNode>()) {
+      bindings.emplace_back(node->var, VisitExpr(node->value));
+      body = node->body;
+    }
+    body = VisitExpr(body);
+    PlanBlock(&bindings, body);
+    for (auto it = bindings.rbegin(); it != bindings.rend(); ++it) {
+      body = Let(it->first, it->second, body);
+    }
+    return body;
+  }
+
+  /*! \brief The bytes allocated before and after planning, for logging. */
+  int64_t bytes_before = 0;
+  int64_t bytes_after = 0;
+
+ private:
+  struct StorageInfo {
+    /*! \brief The binding allocating the storage and the last binding using it. */
+    size_t def;
+    size_t last_use;
+    int64_t size;
+    int64_t alignment;
+    Device device;
+    bool escaped{false};
+    int64_t offset{0};
+  };
+
+  static int64_t AlignUp(int64_t value, int64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  static bool ConstInt(const Expr& expr, int64_t* value) {
+    const auto* constant = AsIgnoringOnDevice<ConstantNode>(expr);
+    if (constant == nullptr || !constant->is_scalar()) {
+      return false;
+    }
+    DataType dtype(constant->data->dtype);
+    if (!dtype.is_int()) {
+      return false;
+    }
+    *value = static_cast<int64_t>(ToScalar(constant->data));
+    return true;
+  }
+
+  void PlanBlock(std::vector<std::pair<Var, Expr>>* bindings, const Expr& body) {
+    static const Op& alloc_storage_op = Op::Get("memory.alloc_storage");
+    static const Op& alloc_tensor_op = Op::Get("memory.alloc_tensor");
+    static const Op& invoke_tvm_op = Op::Get("vm.invoke_tvm_op");
+    static const Op& shape_of_op = Op::Get("vm.shape_of");
+    static const Op& reshape_tensor_op = Op::Get("vm.reshape_tensor");
+
+    std::vector<StorageInfo> storages;
+    // storage vars and the tensors (or views) allocated from them
+    std::unordered_map<const VarNode*, size_t> storage_of;
+    auto use = [&](const Expr& expr, size_t index) {
+      const auto* var = IgnoreOnDevice(expr).as<VarNode>();
+      auto it = var != nullptr ? storage_of.find(var) : storage_of.end();
+      if (it == storage_of.end()) {
+        return false;
+      }
+      storages[it->second].last_use = index;
+      return true;
+    };
+    auto escape = [&](const Expr& expr) {
+      for (const Var& var : FreeVars(expr)) {
+        auto it = storage_of.find(var.get());
+        if (it != storage_of.end()) {
+          storages[it->second].escaped = true;
+        }
+      }
+    };
+
+    for (size_t i = 0; i < bindings->size(); ++i) {
+      const Var& var = (*bindings)[i].first;
+      Expr value = IgnoreOnDevice((*bindings)[i].second);
+      const auto* call = value.as<CallNode>();
+      if (call != nullptr && call->op == alloc_storage_op) {
+        const auto* attrs = call->attrs.as<AllocStorageAttrs>();
+        StorageInfo info;
+        if (ConstInt(call->args[0], &info.size) && ConstInt(call->args[1], &info.alignment) &&
+            info.alignment > 0) {
+          info.def = i;
+          info.last_use = i;
+          info.device = Device{static_cast<DLDeviceType>(attrs->device_type), attrs->device_id};
+          storage_of[var.get()] = storages.size();
+          storages.push_back(info);
+          continue;
+        }
+      } else if (call != nullptr && call->op == alloc_tensor_op) {
+        int64_t offset;
+        if (ConstInt(call->args[1], &offset) && offset == 0 && use(call->args[0], i)) {
+          storage_of[var.get()] = storage_of[IgnoreOnDevice(call->args[0]).as<VarNode>()];
+          escape(call->args[2]);
+          continue;
+        }
+      } else if (call != nullptr && call->op == reshape_tensor_op) {
+        // a view of the same storage
+        if (use(call->args[0], i)) {
+          storage_of[var.get()] = storage_of[IgnoreOnDevice(call->args[0]).as<VarNode>()];
+          escape(call->args[1]);
+          continue;
+        }
+      } else if (call != nullptr && call->op == invoke_tvm_op) {
+        for (size_t k = 1; k < call->args.size(); ++k) {
+          const auto* tuple = call->args[k].as<TupleNode>();
+          if (tuple == nullptr) {
+            escape(call->args[k]);
+            continue;
+          }
+          for (const Expr& field : tuple->fields) {
+            if (!use(field, i)) {
+              escape(field);
+            }
+          }
+        }
+        continue;
+      } else if (call != nullptr && (call->op == shape_of_op || call->op == DeviceCopyOp())) {
+        // read into a new tensor
+        if (call->args.size() == 1 && use(call->args[0], i)) {
+          continue;
+        }
+      } else if (const auto* alias = value.as<VarNode>()) {
+        auto it = storage_of.find(alias);
+        if (it != storage_of.end()) {
+          storage_of[var.get()] = it->second;
+          storages[it->second].last_use = i;
+          continue;
+        }
+      }
+      escape((*bindings)[i].second);
+    }
+    escape(body);
+
+    // Group the plannable storages by device, each group becomes one arena.
+    std::map<std::pair<int, int>, std::vector<size_t>> groups;
+    for (size_t s = 0; s < storages.size(); ++s) {
+      if (!storages[s].escaped) {
+        groups[{storages[s].device.device_type, storages[s].device.device_id}].push_back(s);
+      }
+    }
+
+    // the binding index each arena is allocated before
+    std::unordered_map<size_t, Var> arena_of_def;
+    std::vector<bool> planned(storages.size(), false);
+    std::vector<Var> arena_of(storages.size());
+    for (auto& group : groups) {
+      std::vector<size_t>& members = group.second;
+      if (members.size() < 2) continue;
+      int64_t arena_size = PackGroup(&storages, members);
+      int64_t alignment = 1;
+      size_t first_def = bindings->size();
+      for (size_t s : members) {
+        alignment = std::max(alignment, storages[s].alignment);
+        first_def = std::min(first_def, storages[s].def);
+        bytes_before += storages[s].size;
+        planned[s] = true;
+      }
+      bytes_after += arena_size;
+      Var arena("arena_" + std::to_string(arena_count_++), Type(nullptr));
+      for (size_t s : members) {
+        arena_of[s] = arena;
+      }
+      const Device& dev = storages[members[0]].device;
+      Expr size = OnDevice(MakeConstantScalar(DataType::Int(64), arena_size), kDLCPU,
+                           /*is_fixed=*/true);
+      Expr value = OnDevice(AllocStorage(size, MakeConstantScalar(DataType::Int(64), alignment),
+                                         dev, DataType::UInt(8)),
+                            dev.device_type, /*is_fixed=*/true);
+      arena_of_def[first_def] = arena;
+      arena_values_[arena.get()] = value;
+    }
+    if (arena_of_def.empty()) {
+      return;
+    }
+
+    // Rewrite the block: the arenas replace the storages, tensors get offsets.
+    std::vector<std::pair<Var, Expr>> rewritten;
+    for (size_t i = 0; i < bindings->size(); ++i) {
+      auto arena_it = arena_of_def.find(i);
+      if (arena_it != arena_of_def.end()) {
+        const Var& arena = arena_it->second;
+        rewritten.emplace_back(arena, arena_values_[arena.get()]);
+      }
+      const Var& var = (*bindings)[i].first;
+      const Expr& value = (*bindings)[i].second;
+      OnDeviceProps props = GetOnDeviceProps(value);
+      const auto* call = IgnoreOnDevice(value).as<CallNode>();
+      auto it = storage_of.find(var.get());
+      if (it != storage_of.end() && planned[it->second] && call != nullptr) {
+        const StorageInfo& info = storages[it->second];
+        if (call->op == alloc_storage_op) {
+          continue;
+        }
+        if (call->op == alloc_tensor_op) {
+          Expr offset = OnDevice(MakeConstantScalar(DataType::Int(64), info.offset), kDLCPU,
+                                 /*is_fixed=*/true);
+          Expr new_call =
+              Call(call->op, {arena_of[it->second], offset, call->args[2]}, call->attrs);
+          if (props.body.defined()) {
+            new_call = OnDevice(new_call, props.device_type, props.is_fixed);
+          }
+          rewritten.emplace_back(var, new_call);
+          continue;
+        }
+      }
+      rewritten.emplace_back(var, value);
+    }
+    *bindings = std::move(rewritten);
+  }
+
+  /*!
+   * \brief Assign offsets to storages whose lifetimes do not overlap, largest
+   *  first, each at the lowest offset that fits between the storages placed
+   *  already and alive at the same time.
+   * \return The size of the arena.
+   */
+  static int64_t PackGroup(std::vector<StorageInfo>* storages, std::vector<size_t> members) {
+    std::stable_sort(members.begin(), members.end(), [&](size_t a, size_t b) {
+      return (*storages)[a].size > (*storages)[b].size;
+    });
+    std::vector<size_t> placed;
+    int64_t total = 0;
+    for (size_t s : members) {
+      StorageInfo& info = (*storages)[s];
+      std::vector<size_t> live;
+      for (size_t p : placed) {
+        const StorageInfo& other = (*storages)[p];
+        if (!(other.last_use < info.def || info.last_use < other.def)) {
+          live.push_back(p);
+        }
+      }
+      std::sort(live.begin(), live.end(),
+                [&](size_t a, size_t b) { return (*storages)[a].offset < (*storages)[b].offset; });
+      int64_t offset = 0;
+      for (size_t p : live) {
+        const StorageInfo& other = (*storages)[p];
+        if (AlignUp(offset, info.alignment) + info.size <= other.offset) {
+          break;
+        }
+        offset = std::max(offset, other.offset + other.size);
+      }
+      info.offset = AlignUp(offset, info.alignment);
+      total = std::max(total, info.offset + info.size);
+      placed.push_back(s);
+    }
+    return total;
+  }
+
+  size_t arena_count_ = 0;
+  std::unordered_map<const VarNode*, Expr> arena_values_;
+};
+
+}  // namespace vm
+
+namespace transform {
+
+Pass StaticMemoryPlan() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        if (f->HasNonzeroAttr(attr::kPrimitive) || f->GetAttr<String>(attr::kCompiler).defined()) {
+          return f;
+        }
+        vm::StaticMemoryPlanner planner;
+        auto ret = Downcast<Function>(planner.VisitExpr(f));
+        if (planner.bytes_before > 0) {
+          VLOG(1) << "Planned " << planner.bytes_before << " bytes of static storages into "
+                  << planner.bytes_after << " bytes of arenas";
+        }
+        return ret;
+      };
+  return CreateFunctionPass(pass_func, 0, "StaticMemoryPlan", {});
+}
+
+TVM_REGISTER_GLOBAL("relay._transform.StaticMemoryPlan").set_body_typed(StaticMemoryPlan);
+
+TVM_REGISTER_PASS_CONFIG_OPTION("relay.vm.static_memory_plan", Bool);
+
+}  // namespace transform
+
+}  // namespace relay
+}  // namespace tvm
@@ -28,6 +28,7 @@
 #include <tvm/relay/op.h>
 
 #include <string>
+#include <vector>
 
 #include "../transforms/pattern_utils.h"
 
@@ -150,6 +151,18 @@ struct QConfigContext {
   ~QConfigContext() { QConfig::ExitQConfigScope(); }
 };
 
+/*!
+ * \brief Find the threshold of a histogram symmetric around zero that minimizes the
+ *  KL divergence between the original and the quantized distribution.
+ * \param hist The histogram, num_bins counts.
+ * \param hist_edges The num_bins + 1 bin edges.
+ * \param num_bins The number of bins.
+ * \param num_quantized_bins The number of quantized levels.
+ * \return The threshold.
+ */
+float MinimizeKL(const std::vector<int>& hist, const std::vector<float>& hist_edges, int num_bins,
+                 int num_quantized_bins);
+
 }  // namespace quantize
 }  // namespace relay
 }  // namespace tvm
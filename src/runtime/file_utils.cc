@@ -24,14 +24,24 @@
 
 #include <dmlc/json.h>
 #include <dmlc/memory_io.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
+#include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
 
 #include <fstream>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace tvm {
 namespace runtime {
 
@@ -216,6 +226,175 @@ std::string SaveParams(const Map<String, NDArray>& params) {
   return bytes;
 }
 
+void SaveParamsMapped(const std::string& file_name, const Map<String, NDArray>& params) {
+  ICHECK(DMLC_IO_NO_ENDIAN_SWAP) << "Mapped parameters are only supported on little endian hosts";
+  std::vector<std::string> names;
+  std::vector<NDArray> arrays;
+  std::vector<uint64_t> offsets;
+  uint64_t data_size = 0;
+  for (const auto& p : params) {
+    NDArray array = p.second;
+    if (array->device.device_type != kDLCPU) {
+      array = array.CopyTo(Device{kDLCPU, 0});
+    }
+    ICHECK(array.IsContiguous()) << "Parameter " << p.first << " is not contiguous";
+    names.push_back(p.first);
+    arrays.push_back(array);
+    offsets.push_back(data_size);
+    data_size += (GetDataSize(*array.operator->()) + kAllocAlignment - 1) / kAllocAlignment *
+                 kAllocAlignment;
+  }
+
+  // the index, the data section starts at the next aligned offset after it.
+  std::string index;
+  dmlc::MemoryStringStream strm(&index);
+  uint64_t header = kTVMMappedNDArrayListMagic, alignment = kAllocAlignment;
+  strm.Write(header);
+  strm.Write(alignment);
+  strm.Write(names);
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const DLTensor* tensor = arrays[i].operator->();
+    strm.Write(offsets[i]);
+    strm.Write(tensor->dtype);
+    strm.Write(tensor->ndim);
+    strm.WriteArray(tensor->shape, tensor->ndim);
+  }
+  index.resize((index.size() + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment, '\0');
+
+  std::ofstream fs(file_name, std::ios::out | std::ios::binary);
+  ICHECK(!fs.fail()) << "Cannot open " << file_name;
+  fs.write(index.data(), index.size());
+  std::vector<char> padding(kAllocAlignment, 0);
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    size_t size = GetDataSize(*arrays[i].operator->());
+    fs.write(static_cast<const char*>(arrays[i]->data) + arrays[i]->byte_offset, size);
+    fs.write(padding.data(), (kAllocAlignment - size % kAllocAlignment) % kAllocAlignment);
+  }
+  ICHECK(!fs.fail()) << "Cannot write " << file_name;
+}
+
+namespace {
+/*! \brief The most dimensions a parameter of a mapped file may have. */
+constexpr int kMaxDims = 32;
+
+/*! \brief Keeps the mapping of a parameter file alive for the arrays pointing into it. */
+struct MappedTensor {
+  DLManagedTensor managed;
+  std::vector<int64_t> shape;
+  std::shared_ptr<char> mapping;
+};
+}  // namespace
+
+std::shared_ptr<char> MapFile(const std::string& file_name, size_t* size, bool writable) {
+#if defined(_WIN32)
+  LOG(FATAL) << "Mapping files is not supported on Windows";
+  return nullptr;
+#else
+  int fd = open(file_name.c_str(), O_RDONLY);
+  ICHECK_GE(fd, 0) << "Cannot open " << file_name;
+  struct stat st;
+  ICHECK_EQ(fstat(fd, &st), 0) << "Cannot stat " << file_name;
+  size_t file_size = static_cast<size_t>(st.st_size);
+  ICHECK_GT(file_size, 0U) << "Cannot map the empty file " << file_name;
+  // private: written pages are copied, the file is never modified.
+  int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* addr = mmap(nullptr, file_size, prot, MAP_PRIVATE, fd, 0);
+  close(fd);
+  ICHECK(addr != MAP_FAILED) << "Cannot map " << file_name;
+  *size = file_size;
+  return std::shared_ptr<char>(static_cast<char*>(addr),
+                               [file_size](char* ptr) { munmap(ptr, file_size); });
+#endif
+}
+
+NDArray MappedNDArray(const std::shared_ptr<char>& mapping, size_t size, size_t offset,
+                      std::vector<int64_t> shape, DLDataType dtype) {
+  auto* tensor = new MappedTensor();
+  tensor->shape = std::move(shape);
+  tensor->mapping = mapping;
+  DLTensor& dl_tensor = tensor->managed.dl_tensor;
+  dl_tensor.data = mapping.get() + offset;
+  dl_tensor.device = Device{kDLCPU, 0};
+  dl_tensor.ndim = static_cast<int>(tensor->shape.size());
+  dl_tensor.dtype = dtype;
+  dl_tensor.shape = tensor->shape.data();
+  dl_tensor.strides = nullptr;
+  dl_tensor.byte_offset = 0;
+  if (offset > size || GetDataSize(dl_tensor) > size - offset) {
+    delete tensor;
+    LOG(FATAL) << "The array is out of the bounds of the mapped file";
+  }
+  tensor->managed.manager_ctx = tensor;
+  tensor->managed.deleter = [](DLManagedTensor* self) {
+    delete static_cast<MappedTensor*>(self->manager_ctx);
+  };
+  return NDArray::FromDLPack(&tensor->managed);
+}
+
+Map<String, NDArray> LoadParamsMapped(const std::string& file_name) {
+  ICHECK(DMLC_IO_NO_ENDIAN_SWAP) << "Mapped parameters are only supported on little endian hosts";
+  size_t file_size = 0;
+  // writable, set_input writes into the params a graph executor uses in place
+  std::shared_ptr<char> mapping = MapFile(file_name, &file_size, true);
+  ICHECK_GE(file_size, 2 * sizeof(uint64_t)) << "Invalid parameters file format";
+
+  dmlc::MemoryFixedSizeStream strm(mapping.get(), file_size);
+  uint64_t header, alignment;
+  ICHECK(strm.Read(&header)) << "Invalid parameters file format";
+  ICHECK(header == kTVMMappedNDArrayListMagic) << "Invalid parameters file format";
+  ICHECK(strm.Read(&alignment)) << "Invalid parameters file format";
+  ICHECK(alignment > 0 && alignment <= file_size) << "Invalid parameters file format";
+  ICHECK_EQ(alignment & (alignment - 1), 0U)
+      << "The alignment " << alignment << " is not a power of two";
+  std::vector<std::string> names;
+  ICHECK(strm.Read(&names)) << "Invalid parameters file format";
+  std::vector<uint64_t> offsets(names.size());
+  std::vector<DLDataType> dtypes(names.size());
+  std::vector<std::vector<int64_t>> shapes(names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    int ndim;
+    ICHECK(strm.Read(&offsets[i])) << "Invalid parameters file format";
+    ICHECK(strm.Read(&dtypes[i])) << "Invalid parameters file format";
+    ICHECK(strm.Read(&ndim)) << "Invalid parameters file format";
+    ICHECK(ndim >= 0 && ndim <= kMaxDims) << "Invalid ndim " << ndim << " of " << names[i];
+    shapes[i].resize(ndim);
+    ICHECK(strm.ReadArray(shapes[i].data(), ndim)) << "Invalid parameters file format";
+    for (int64_t dim : shapes[i]) {
+      ICHECK_GE(dim, 0) << "Invalid shape of " << names[i];
+    }
+  }
+  size_t data_offset = (strm.Tell() + alignment - 1) / alignment * alignment;
+  ICHECK_LE(data_offset, file_size) << "Invalid parameters file format";
+
+  Map<String, NDArray> params;
+  for (size_t i = 0; i < names.size(); ++i) {
+    // compared against what is left so that a corrupt offset cannot overflow
+    size_t avail = file_size - data_offset;
+    ICHECK_LE(offsets[i], avail) << "The data of " << names[i] << " is out of the bounds of "
+                                 << file_name;
+    avail -= offsets[i];
+    size_t bytes = (dtypes[i].bits * dtypes[i].lanes + 7) / 8;
+    for (int64_t dim : shapes[i]) {
+      ICHECK(dim == 0 || bytes <= avail / static_cast<size_t>(dim))
+          << "The data of " << names[i] << " is out of the bounds of " << file_name;
+      bytes *= static_cast<size_t>(dim);
+    }
+    ICHECK_LE(bytes, avail) << "The data of " << names[i] << " is out of the bounds of "
+                            << file_name;
+    params.Set(names[i], MappedNDArray(mapping, file_size, data_offset + offsets[i],
+                                       std::move(shapes[i]), dtypes[i]));
+  }
+  return params;
+}
+
+TVM_REGISTER_GLOBAL("runtime.SaveParamsMapped")
+    .set_body_typed([](const String& file_name, const Map<String, NDArray>& params) {
+      ::tvm::runtime::SaveParamsMapped(file_name, params);
+    });
+TVM_REGISTER_GLOBAL("runtime.LoadParamsMapped").set_body_typed([](const String& file_name) {
+  return ::tvm::runtime::LoadParamsMapped(file_name);
+});
+
 TVM_REGISTER_GLOBAL("runtime.SaveParams").set_body_typed([](const Map<String, NDArray>& params) {
   std::string s = ::tvm::runtime::SaveParams(params);
   // copy return array so it is owned by the ret value
@@ -27,8 +27,10 @@
 #include <tvm/runtime/container/map.h>
 #include <tvm/runtime/container/string.h>
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "meta_data.h"
 
@@ -121,6 +123,49 @@ std::string SaveParams(const Map<String, NDArray>& params);
  * \param params Parameters to save.
  */
 void SaveParams(dmlc::Stream* strm, const Map<String, NDArray>& params);
+
+constexpr uint64_t kTVMMappedNDArrayListMagic = 0xF7E58D4F05049CB8;
+/*!
+ * \brief Save parameters to a file that LoadParamsMapped can map.
+ *
+ *  The file holds the names, dtypes and shapes of the parameters, followed by
+ *  their data with every tensor aligned to kAllocAlignment.
+ * \param file_name The file to write.
+ * \param params Parameters to save.
+ */
+void SaveParamsMapped(const std::string& file_name, const Map<String, NDArray>& params);
+/*!
+ * \brief Map a parameter file written by SaveParamsMapped.
+ *
+ *  The parameters are CPU arrays pointing into a private mapping of the file:
+ *  pages are read on first access, shared with the other processes mapping the
+ *  same file, and copied only when written to. The mapping lives as long as any
+ *  of the arrays.
+ * \param file_name The file to map.
+ * \return Map of parameter name to parameter value.
+ */
+Map<String, NDArray> LoadParamsMapped(const std::string& file_name);
+/*!
+ * \brief Map a whole file privately: pages are read on first access and, if
+ *  writable, copied only when written to. The file itself is never modified.
+ * \param file_name The file to map.
+ * \param size The size of the file.
+ * \param writable Whether the mapping may be written to, a write to a
+ *  read-only mapping faults.
+ * \return The mapping, unmapped when the last reference is released.
+ */
+std::shared_ptr<char> MapFile(const std::string& file_name, size_t* size, bool writable = false);
+/*!
+ * \brief Create a CPU array pointing into a mapping, which it keeps alive.
+ * \param mapping The mapping returned by MapFile.
+ * \param size The size of the mapping.
+ * \param offset The offset of the data in the mapping.
+ * \param shape The shape of the array.
+ * \param dtype The data type of the array.
+ * \return The array, the data must lie within the mapping.
+ */
+NDArray MappedNDArray(const std::shared_ptr<char>& mapping, size_t size, size_t offset,
+                      std::vector<int64_t> shape, DLDataType dtype);
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_FILE_UTILS_H_
@@ -22,6 +22,7 @@
  */
 #include "graph_executor.h"
 
+#include <tvm/runtime/bound_packed_call.h>
 #include <tvm/runtime/container/map.h>
 #include <tvm/runtime/container/string.h>
 #include <tvm/runtime/device_api.h>
@@ -30,12 +31,18 @@
 #include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
+#include <thread>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -52,16 +59,175 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
 }
 }  // namespace details
 
+/*!
+ * \brief Runs the nodes of the graph on a set of threads.
+ *
+ *  A node is queued once all the nodes it depends on finished. The thread that
+ *  finishes a node goes on with one of the nodes it made ready, so a chain of
+ *  nodes stays on one thread, and queues the others for the idle threads.
+ */
+class GraphExecutor::InterOpScheduler {
+ public:
+  InterOpScheduler(GraphExecutor* exec, int num_threads, int intra_op_threads)
+      : exec_(exec), remaining_(new std::atomic<uint32_t>[exec->op_execs_.size()]) {
+    for (uint32_t nid = 0; nid < exec->op_execs_.size(); ++nid) {
+      if (!exec->op_execs_[nid]) continue;
+      num_ops_++;
+      if (exec->op_num_deps_[nid] == 0) roots_.push_back(nid);
+    }
+    for (int i = 0; i < num_threads; ++i) {
+      threads_.emplace_back([this, i, intra_op_threads]() { WorkerLoop(i, intra_op_threads); });
+    }
+  }
+
+  ~InterOpScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      exit_now_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Run() {
+    if (num_ops_ == 0) return;
+    for (uint32_t nid = 0; nid < exec_->op_num_deps_.size(); ++nid) {
+      remaining_[nid].store(exec_->op_num_deps_[nid], std::memory_order_relaxed);
+    }
+    num_pending_.store(num_ops_, std::memory_order_relaxed);
+    failed_.store(false, std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.insert(ready_.end(), roots_.rbegin(), roots_.rend());
+    }
+    cv_.notify_all();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_cv_.wait(lock, [this]() { return num_pending_.load() == 0; });
+    }
+    if (failed_.load()) {
+      LOG(FATAL) << error_;
+    }
+  }
+
+ private:
+  void WorkerLoop(int worker, int intra_op_threads) {
+    if (intra_op_threads > 0) {
+      // the kernels launched from this thread use its own thread pool, bound to
+      // a slice of the cores no other worker uses and with one thread per core
+      // of the slice, this thread included.
+      const PackedFunc* config = Registry::Get("runtime.config_threadpool");
+      ICHECK(config != nullptr);
+      int num_cores = threading::MaxConcurrency();
+      std::vector<TVMValue> values(2 + intra_op_threads);
+      std::vector<int> type_codes(values.size());
+      TVMArgsSetter setter(values.data(), type_codes.data());
+      setter(0, static_cast<int>(threading::ThreadGroup::kSpecifyOneCorePerThread));
+      setter(1, intra_op_threads);
+      for (int i = 0; i < intra_op_threads; ++i) {
+        setter(2 + i, (worker * intra_op_threads + i) % num_cores);
+      }
+      TVMRetValue rv;
+      config->CallPacked(TVMArgs(values.data(), type_codes.data(), values.size()), &rv);
+    }
+    while (true) {
+      uint32_t nid;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return exit_now_ || !ready_.empty(); });
+        if (exit_now_) return;
+        nid = ready_.back();
+        ready_.pop_back();
+      }
+      RunChain(nid);
+    }
+  }
+
+  void RunChain(uint32_t nid) {
+    while (true) {
+      // after a failure the remaining nodes are only counted down.
+      if (!failed_.load(std::memory_order_relaxed)) {
+        try {
+          exec_->op_execs_[nid]();
+        } catch (const std::exception& e) {
+          std::lock_guard<std::mutex> lock(mutex_);
+          if (!failed_.load()) {
+            error_ = e.what();
+            failed_.store(true);
+          }
+        }
+      }
+      int64_t next = -1;
+      for (uint32_t consumer : exec_->op_consumers_[nid]) {
+        if (remaining_[consumer].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+        if (next < 0) {
+          next = consumer;
+        } else {
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ready_.push_back(consumer);
+          }
+          cv_.notify_one();
+        }
+      }
+      if (num_pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        { std::lock_guard<std::mutex> lock(mutex_); }
+        done_cv_.notify_one();
+      }
+      if (next < 0) return;
+      nid = static_cast<uint32_t>(next);
+    }
+  }
+
+  GraphExecutor* exec_;
+  /*! \brief The number of nodes with an executor. */
+  uint32_t num_ops_{0};
+  /*! \brief The nodes that depend on no other node. */
+  std::vector<uint32_t> roots_;
+  /*! \brief The number of unfinished dependencies of each node in this run. */
+  std::unique_ptr<std::atomic<uint32_t>[]> remaining_;
+  std::atomic<uint32_t> num_pending_{0};
+  std::atomic<bool> failed_{false};
+  std::string error_;
+  std::vector<uint32_t> ready_;
+  bool exit_now_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::thread> threads_;
+};
+
+GraphExecutor::~GraphExecutor() {}
+
 /*!
  * \brief Run all the operations one by one.
  */
 void GraphExecutor::Run() {
+  if (inter_op_scheduler_ != nullptr) {
+    inter_op_scheduler_->Run();
+    return;
+  }
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
     if (op_execs_[i]) op_execs_[i]();
   }
 }
 
+void GraphExecutor::ConfigInterOpParallel(int inter_op_threads, int intra_op_threads) {
+  inter_op_scheduler_.reset();
+  if (inter_op_threads <= 1) return;
+  for (const Device& dev : devices_) {
+    CHECK_EQ(dev.device_type, kDLCPU) << "Inter-op parallelism only supports graphs on the CPU";
+  }
+  if (intra_op_threads <= 0) {
+    // split the cores evenly, so the workers do not oversubscribe them
+    intra_op_threads = std::max(1, threading::MaxConcurrency() / inter_op_threads);
+  }
+  inter_op_scheduler_.reset(new InterOpScheduler(this, inter_op_threads, intra_op_threads));
+}
+
 /*!
  * \brief Initialize the graph executor with graph and device.
  * \param graph_json The execution graph.
@@ -86,6 +252,7 @@ void GraphExecutor::Init(const std::string& graph_json, tvm::runtime::Module mod
   }
   this->SetupStorage();
   this->SetupOpExecs();
+  this->SetupOpDependency();
   for (size_t i = 0; i < input_nodes_.size(); i++) {
     const uint32_t nid = input_nodes_[i];
     std::string& name = nodes_[nid].name;
@@ -96,6 +263,15 @@ void GraphExecutor::Init(const std::string& graph_json, tvm::runtime::Module mod
     std::string& name = nodes_[nid].name;
     output_map_[name] = i;
   }
+  const char* inter_op = getenv("TVM_GRAPH_EXECUTOR_INTER_OP_THREADS");
+  if (inter_op != nullptr) {
+    bool on_cpu = std::all_of(devices_.begin(), devices_.end(),
+                              [](const Device& dev) { return dev.device_type == kDLCPU; });
+    const char* intra_op = getenv("TVM_GRAPH_EXECUTOR_INTRA_OP_THREADS");
+    if (on_cpu) {
+      this->ConfigInterOpParallel(atoi(inter_op), intra_op != nullptr ? atoi(intra_op) : 0);
+    }
+  }
 }
 /*!
  * \brief Get the input index given the name of input.
@@ -284,6 +460,60 @@ void GraphExecutor::ShareParams(const GraphExecutor& other, dmlc::Stream* strm)
   this->SetupOpExecs();
 }
 
+void GraphExecutor::BindSharedParams(const GraphExecutor& other,
+                                     const std::vector<std::string>& names) {
+  std::unordered_map<uint32_t, NDArray> arrays;
+  for (size_t i = 0; i < names.size(); ++i) {
+    int in_idx = GetInputIndex(names[i]);
+    if (in_idx < 0) continue;
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    ICHECK_LT(eid, data_entry_.size());
+    ICHECK_EQ(data_entry_[eid].use_count(), 1);
+    arrays[eid] = other.GetInput(in_idx);
+  }
+  this->BindInputEntries(arrays);
+}
+
+void GraphExecutor::LoadParamsMapped(const std::string& file_name) {
+  Map<String, NDArray> params = ::tvm::runtime::LoadParamsMapped(file_name);
+  std::unordered_map<uint32_t, NDArray> arrays;
+  for (const auto& p : params) {
+    int in_idx = GetInputIndex(p.first);
+    if (in_idx < 0) continue;
+    uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
+    const DLTensor* entry = data_entry_[eid].operator->();
+    const DLTensor* param = p.second.operator->();
+    bool same_layout = entry->ndim == param->ndim &&
+                       std::equal(entry->shape, entry->shape + entry->ndim, param->shape) &&
+                       entry->dtype.code == param->dtype.code &&
+                       entry->dtype.bits == param->dtype.bits &&
+                       entry->dtype.lanes == param->dtype.lanes;
+    if (entry->device.device_type == kDLCPU && same_layout && data_entry_[eid].use_count() == 1) {
+      // use the mapped tensor in place.
+      arrays[eid] = p.second;
+    } else {
+      data_entry_[eid].CopyFrom(p.second);
+    }
+  }
+  this->BindInputEntries(arrays);
+}
+
+void GraphExecutor::BindInputEntries(const std::unordered_map<uint32_t, NDArray>& arrays) {
+  for (const auto& kv : arrays) {
+    data_entry_[kv.first] = kv.second;
+    data_alignment_[kv.first] = details::GetDataAlignment(*kv.second.operator->());
+  }
+  // Drop the storage that only backed the replaced entries, so that the params are held once.
+  std::vector<bool> in_use(storage_pool_.size(), false);
+  for (uint32_t eid = 0; eid < data_entry_.size(); ++eid) {
+    if (arrays.count(eid) == 0) in_use[attrs_.storage_id[eid]] = true;
+  }
+  for (size_t sid = 0; sid < storage_pool_.size(); ++sid) {
+    if (!in_use[sid]) storage_pool_[sid] = NDArray();
+  }
+  this->SetupOpExecs();
+}
+
 void GraphExecutor::LinkedNDArrayDeleter(Object* container) {
   // container is the NDArray::Container which needs to get deleted.
   // The data member points to global const memory, so it does not need deleting.
@@ -461,6 +691,41 @@ void GraphExecutor::SetupOpExecs() {
   }
 }
 
+void GraphExecutor::SetupOpDependency() {
+  uint32_t num_nodes = this->GetNumOfNodes();
+  op_consumers_.assign(num_nodes, {});
+  op_num_deps_.assign(num_nodes, 0);
+  std::vector<std::unordered_set<uint32_t>> deps(num_nodes);
+  auto add_dep = [&](uint32_t from, uint32_t to) {
+    if (from != to && deps[to].insert(from).second) {
+      op_consumers_[from].push_back(to);
+      op_num_deps_[to]++;
+    }
+  };
+  // Storage is shared by entries that do not live at the same time, so besides its
+  // inputs a node waits for the readers of the previous entry in the storage it writes.
+  std::unordered_map<int, uint32_t> last_writer;
+  std::unordered_map<int, std::vector<uint32_t>> readers;
+  for (uint32_t nid = 0; nid < num_nodes; ++nid) {
+    if (!op_execs_[nid]) continue;
+    const auto& inode = nodes_[nid];
+    for (const auto& e : inode.inputs) {
+      int sid = attrs_.storage_id[this->entry_id(e)];
+      auto it = last_writer.find(sid);
+      if (it != last_writer.end()) add_dep(it->second, nid);
+      readers[sid].push_back(nid);
+    }
+    for (uint32_t index = 0; index < inode.param.num_outputs; ++index) {
+      int sid = attrs_.storage_id[this->entry_id(nid, index)];
+      for (uint32_t reader : readers[sid]) add_dep(reader, nid);
+      auto it = last_writer.find(sid);
+      if (it != last_writer.end()) add_dep(it->second, nid);
+      last_writer[sid] = nid;
+      readers[sid].clear();
+    }
+  }
+}
+
 std::pair<std::function<void()>, std::shared_ptr<GraphExecutor::OpArgs> >
 GraphExecutor::CreateTVMOp(const TVMOpParam& param, const std::vector<DLTensor>& args) {
   std::shared_ptr<GraphExecutor::OpArgs> arg_ptr = std::make_shared<GraphExecutor::OpArgs>();
@@ -501,12 +766,12 @@ GraphExecutor::CreateTVMOp(const TVMOpParam& param, const std::vector<DLTensor>&
   tvm::runtime::PackedFunc pf = module_.GetFunction(param.func_name, true);
   ICHECK(pf != nullptr) << "no such function in module: " << param.func_name;
 
-  auto fexec = [arg_ptr, pf]() {
-    TVMRetValue rv;
-    TVMArgs targs(arg_ptr->arg_values.data(), arg_ptr->arg_tcodes.data(),
-                  static_cast<int>(arg_ptr->arg_values.size()));
-    pf.CallPacked(targs, &rv);
-  };
+  // The tensors are refreshed in place, so the arguments are packed only once.
+  auto call = std::make_shared<BoundPackedCall>(pf, static_cast<int>(arg_ptr->args.size()));
+  for (size_t i = 0; i < arg_ptr->args.size(); ++i) {
+    call->Set(i, &arg_ptr->args[i]);
+  }
+  auto fexec = [arg_ptr, call]() { call->Run(); };
   return {fexec, arg_ptr};
 }
 
@@ -596,10 +861,46 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
           }
           *rv = outputs;
         });
+  } else if (name == "run_from_bytes") {
+    // Set the inputs, run and fetch the outputs in a single call, so a remote
+    // executor costs one round trip per inference.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(args.size() % 2 == 0)
+          << "Number of arguments to run_from_bytes must be an even number of key-value pairs";
+      for (int i = 0; i < args.size(); i += 2) {
+        int in_idx = 0;
+        if (String::CanConvertFrom(args[i])) {
+          in_idx = this->GetInputIndex(args[i].operator String());
+          CHECK_GE(in_idx, 0) << args[i].operator String() << " is not a valid input name";
+        } else {
+          in_idx = args[i];
+        }
+        CHECK_EQ(args[i + 1].type_code(), kTVMBytes) << "Input " << i / 2 << " must be bytes";
+        auto* data = static_cast<TVMByteArray*>(args[i + 1].value().v_handle);
+        this->GetInput(in_idx).CopyFromBytes(data->data, data->size);
+      }
+      this->Run();
+      std::string outputs;
+      for (int i = 0; i < this->NumOutputs(); i++) {
+        NDArray out = this->GetOutput(i);
+        size_t offset = outputs.size();
+        size_t nbytes = GetDataSize(*out.operator->());
+        outputs.resize(offset + nbytes);
+        out.CopyToBytes(&outputs[offset], nbytes);
+      }
+      TVMByteArray arr;
+      arr.data = outputs.data();
+      arr.size = outputs.size();
+      *rv = arr;
+    });
   } else if (name == "load_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       this->LoadParams(args[0].operator std::string());
     });
+  } else if (name == "load_params_mapped") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadParamsMapped(args[0].operator std::string());
+    });
   } else if (name == "share_params") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       const auto& module = args[0].operator Module();
@@ -613,6 +914,11 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
       CHECK(String::CanConvertFrom(args[0])) << "Input key is not a string";
       *rv = this->GetInputIndex(args[0].operator String());
     });
+  } else if (name == "config_inter_op_parallel") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int intra_op_threads = args.num_args > 1 ? args[1].operator int() : 0;
+      this->ConfigInterOpParallel(args[0], intra_op_threads);
+    });
   } else {
     return PackedFunc();
   }
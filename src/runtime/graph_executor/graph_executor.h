@@ -85,6 +85,17 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   const char* type_key() const final { return "GraphExecutor"; }
   void Run();
 
+  ~GraphExecutor();
+
+  /*!
+   * \brief Run the independent nodes of the graph concurrently.
+   * \param inter_op_threads The number of threads running nodes, 1 runs all nodes in
+   *  order on the calling thread.
+   * \param intra_op_threads The number of threads each of those threads launches kernels
+   *  with, on cores of its own. 0 splits the cores evenly among them.
+   */
+  void ConfigInterOpParallel(int inter_op_threads, int intra_op_threads);
+
   /*!
    * \brief Initialize the graph executor with graph and device.
    * \param graph_json The execution graph.
@@ -174,6 +185,14 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param param_blob A binary blob of parameter.
    */
   void LoadParams(const std::string& param_blob);
+  /*!
+   * \brief Load parameters from a file written by SaveParamsMapped.
+   *
+   *  Parameters of CPU inputs are used in place where the file is mapped, the
+   *  others are copied to their device.
+   * \param file_name The parameter file.
+   */
+  void LoadParamsMapped(const std::string& file_name);
 
   /*!
    * \brief Share parameters from pre-existing GraphExecutor instance.
@@ -182,6 +201,14 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param strm The input stream.
    */
   void ShareParams(const GraphExecutor& other, dmlc::Stream* strm);
+  /*!
+   * \brief Share the named inputs with another GraphExecutor instance of the same graph,
+   *  and free the storage they had in this one, which ShareParams keeps. Used by the
+   *  executor pool, so that its weights are held once.
+   * \param other The GraphExecutor holding the params.
+   * \param names The input names to share, unknown names are skipped.
+   */
+  void BindSharedParams(const GraphExecutor& other, const std::vector<std::string>& names);
 
   /*!
    * \brief Get total number of nodes.
@@ -393,6 +420,13 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   void SetupStorage();
   /*! \brief Setup the executors. */
   void SetupOpExecs();
+  /*!
+   * \brief Point input entries at other arrays and free the storage they leave unused.
+   * \param arrays The arrays, keyed by entry id.
+   */
+  void BindInputEntries(const std::unordered_map<uint32_t, NDArray>& arrays);
+  /*! \brief Setup the dependencies between the nodes, used by inter-op parallel runs. */
+  void SetupOpDependency();
   /*!
    * \brief Check the legality of external DLTensor*.
    * \param external The external DLTensor*.
@@ -454,6 +488,13 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * When the module does not include linked parmeters, module_lookup_linked_param_ will be nullptr.
    */
   bool module_lookup_linked_param_valid_;
+  /*! \brief The nodes that wait for each node. */
+  std::vector<std::vector<uint32_t>> op_consumers_;
+  /*! \brief The number of nodes each node waits for. */
+  std::vector<uint32_t> op_num_deps_;
+  class InterOpScheduler;
+  /*! \brief Runs the nodes concurrently when set, declared last to stop before the rest. */
+  std::unique_ptr<InterOpScheduler> inter_op_scheduler_;
 };
 
 std::vector<Device> GetAllDevice(const TVMArgs& args, int dev_start_arg);
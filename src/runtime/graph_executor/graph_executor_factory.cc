@@ -28,7 +28,9 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/registry.h>
 
+#include <algorithm>
 #include <iterator>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -76,6 +78,15 @@ PackedFunc GraphExecutorFactory::GetFunction(
       exec->Import(this->imports_[0]);
       *rv = Module(exec);
     });
+  } else if (name == "create_pool") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_GE(args.size(), 2);
+      std::vector<Device> devices;
+      for (int i = 1; i < args.num_args; ++i) {
+        devices.emplace_back(args[i].operator Device());
+      }
+      *rv = this->ExecutorPoolCreate(devices, args[0]);
+    });
   } else if (name == "cuda_graph_create") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::vector<Device> devices;
@@ -167,6 +178,86 @@ Module GraphExecutorFactory::CudaGraphExecutorCreate(const std::vector<Device>&
   return mod;
 }
 
+Module GraphExecutorFactory::ExecutorPoolCreate(const std::vector<Device>& devs,
+                                                int num_instances) {
+  ICHECK_GT(num_instances, 0) << "The executor pool needs at least one instance";
+  std::vector<Module> instances;
+  instances.push_back(this->ExecutorCreate(devs));
+  const GraphExecutor* owner = instances[0].as<GraphExecutor>();
+  std::vector<std::string> names;
+  for (const auto& p : this->params_) {
+    names.emplace_back(p.first);
+  }
+  for (int i = 1; i < num_instances; ++i) {
+    auto exec = make_object<GraphExecutor>();
+    exec->Init(this->graph_json_, this->imports_[0], devs, PackedFunc());
+    exec->BindSharedParams(*owner, names);
+    instances.push_back(Module(exec));
+  }
+  return Module(make_object<GraphExecutorPool>(std::move(instances)));
+}
+
+GraphExecutorPool::GraphExecutorPool(std::vector<Module> instances)
+    : instances_(std::move(instances)) {
+  // hand out the first executor first, it is the one whose params are warm.
+  for (size_t i = instances_.size(); i > 0; --i) {
+    idle_.push_back(i - 1);
+  }
+}
+
+Module GraphExecutorPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [this]() { return !idle_.empty(); });
+  size_t index = idle_.back();
+  idle_.pop_back();
+  return instances_[index];
+}
+
+void GraphExecutorPool::Release(const Module& instance) {
+  auto it = std::find_if(instances_.begin(), instances_.end(), [&instance](const Module& m) {
+    return m.operator->() == instance.operator->();
+  });
+  ICHECK(it != instances_.end()) << "The executor does not belong to this pool";
+  size_t index = std::distance(instances_.begin(), it);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ICHECK(std::find(idle_.begin(), idle_.end(), index) == idle_.end())
+        << "The executor is released twice";
+    idle_.push_back(index);
+  }
+  cv_.notify_one();
+}
+
+PackedFunc GraphExecutorPool::GetFunction(const std::string& name,
+                                          const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "acquire") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Acquire(); });
+  } else if (name == "release") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->Release(args[0].operator Module());
+    });
+  } else if (name == "get_num_instances") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = static_cast<int>(this->instances_.size());
+    });
+  } else if (name == "run_from_inputs") {
+    // Same arguments as GraphExecutor.run_from_inputs, on whichever executor is idle.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      Module instance = this->Acquire();
+      try {
+        instance.GetFunction("run_from_inputs").CallPacked(args, rv);
+      } catch (...) {
+        this->Release(instance);
+        throw;
+      }
+      this->Release(instance);
+    });
+  } else {
+    return PackedFunc();
+  }
+}
+
 Module GraphExecutorFactoryModuleLoadBinary(void* strm) {
   dmlc::Stream* stream = static_cast<dmlc::Stream*>(strm);
   std::string graph_json;
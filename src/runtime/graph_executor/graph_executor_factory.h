@@ -31,7 +31,9 @@
 #include <tvm/runtime/packed_func.h>
 
 #include <algorithm>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -97,6 +99,15 @@ class TVM_DLL GraphExecutorFactory : public runtime::ModuleNode {
    */
   Module CudaGraphExecutorCreate(const std::vector<Device>& devs);
 
+  /*!
+   * \brief Create a pool of executors sharing the params, each with its own storage.
+   * \param devs The device of the host and devices where graph nodes will be
+   *  executed on.
+   * \param num_instances The number of executors in the pool.
+   * \return created executor pool module
+   */
+  Module ExecutorPoolCreate(const std::vector<Device>& devs, int num_instances);
+
   /*!
    * \brief Set params.
    * \param graph_executor The graph executor we want to set the params into.
@@ -133,6 +144,55 @@ class TVM_DLL GraphExecutorFactory : public runtime::ModuleNode {
   std::string module_name_;
 };
 
+/*!
+ * \brief A fixed set of graph executors of the same graph.
+ *
+ *  The executors share the params and the compiled module, and each of them owns
+ *  its activation storage. An executor is used by one thread at a time: threads
+ *  acquire one, drive it like any GraphExecutor and release it.
+ */
+class TVM_DLL GraphExecutorPool : public runtime::ModuleNode {
+ public:
+  /*!
+   * \brief Construct the pool.
+   * \param instances The executors, the first one holds the params.
+   */
+  explicit GraphExecutorPool(std::vector<Module> instances);
+
+  /*!
+   * \brief Get member function to front-end
+   * \param name The name of the function.
+   * \param sptr_to_self The pointer to the module node.
+   * \return The corresponding member function.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  /*!
+   * \return The type key of the executor.
+   */
+  const char* type_key() const final { return "GraphExecutorPool"; }
+
+  /*!
+   * \brief Take an idle executor, waits while all of them are in use.
+   * \return The executor module.
+   */
+  Module Acquire();
+
+  /*!
+   * \brief Give an executor back to the pool.
+   * \param instance An executor returned by Acquire.
+   */
+  void Release(const Module& instance);
+
+ private:
+  /*! \brief The executors. */
+  std::vector<Module> instances_;
+  /*! \brief The indices of the idle executors. */
+  std::vector<size_t> idle_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
 }  // namespace runtime
 }  // namespace tvm
 
@@ -0,0 +1,265 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file hhb_params.cc
+ */
+#include "hhb_params.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <tvm/runtime/logging.h>
+#ifdef USE_CSINN_ZLIB
+#include <zlib.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+
+namespace tvm {
+namespace runtime {
+namespace hhb {
+
+#ifdef USE_CSINN_ZLIB
+static uint32_t Checksum(const void* data, size_t size) {
+  uLong crc = crc32(0L, Z_NULL, 0);
+  return static_cast<uint32_t>(crc32(crc, static_cast<const Bytef*>(data), size));
+}
+#else
+/*! \brief The CRC32 of zlib, bit by bit over a byte table. */
+static uint32_t Checksum(const void* data, size_t size) {
+  static const std::vector<uint32_t> table = [] {
+    std::vector<uint32_t> t(256);
+    for (uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; k++) {
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      }
+      t[i] = c;
+    }
+    return t;
+  }();
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint32_t crc = 0xFFFFFFFFu;
+  for (size_t i = 0; i < size; i++) {
+    crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFFu;
+}
+#endif
+
+bool ParamsCompressionEnabled() {
+#ifdef USE_CSINN_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+void ParamsWriter::Add(const std::string& name, ParamsKind kind, const std::string& dtype,
+                       uint64_t offset, const void* data, size_t size, bool compress) {
+  ICHECK(!name.empty()) << "params entries need a name";
+  ICHECK(names_seen_.insert(name).second) << "duplicate params entry " << name;
+  ParamsEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.offset = offset;
+  entry.size = size;
+  entry.kind = kind;
+  entry.codec = kCodecNone;
+  entry.checksum = Checksum(data, size);
+  entry.name_offset = names_.size();
+  entry.name_size = name.size();
+  strncpy(entry.dtype, dtype.c_str(), sizeof(entry.dtype) - 1);
+  names_ += name;
+
+  const char* bytes = static_cast<const char*>(data);
+  std::vector<char> blob(bytes, bytes + size);
+  if (compress && size > 0) {
+#ifdef USE_CSINN_ZLIB
+    uLongf packed_size = compressBound(size);
+    std::vector<char> packed(packed_size);
+    int ret = compress2(reinterpret_cast<Bytef*>(packed.data()), &packed_size,
+                        reinterpret_cast<const Bytef*>(bytes), size, Z_BEST_COMPRESSION);
+    ICHECK_EQ(ret, Z_OK) << "Cannot compress params " << name;
+    if (packed_size < size) {
+      packed.resize(packed_size);
+      blob.swap(packed);
+      entry.codec = kCodecDeflate;
+      packed_ = true;
+    }
+#else
+    LOG(FATAL) << "Cannot compress params " << name << ", TVM is built without USE_CSINN_ZLIB";
+#endif
+  }
+  entry.stored_size = blob.size();
+  entries_.push_back(entry);
+  blobs_.push_back(std::move(blob));
+}
+
+void ParamsWriter::Save(const std::string& path, uint64_t data_size) {
+  ParamsHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kParamsMagic, sizeof(kParamsMagic));
+  header.version = kParamsVersion;
+  header.num_entries = entries_.size();
+  header.alignment = alignment_;
+  header.flags = packed_ ? kParamsFlagPacked : 0;
+  header.names_size = names_.size();
+  uint64_t index_end =
+      sizeof(ParamsHeader) + entries_.size() * sizeof(ParamsEntry) + header.names_size;
+  header.data_offset = AlignUp(index_end, alignment_);
+  header.data_size = data_size;
+
+  // unpacked entries sit at their own offsets, packed ones back to back
+  uint64_t cursor = 0;
+  for (auto& entry : entries_) {
+    if (packed_) {
+      entry.file_offset = header.data_offset + cursor;
+      cursor += entry.stored_size;
+    } else {
+      ICHECK_LE(entry.offset + entry.size, data_size);
+      entry.file_offset = header.data_offset + entry.offset;
+    }
+  }
+
+  std::ofstream fs(path, std::ios::out | std::ios::binary);
+  ICHECK(!fs.fail()) << "Cannot open " << path;
+  fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  fs.write(reinterpret_cast<const char*>(entries_.data()), entries_.size() * sizeof(ParamsEntry));
+  fs.write(names_.data(), names_.size());
+  std::vector<char> padding(alignment_, 0);
+  fs.write(padding.data(), header.data_offset - index_end);
+
+  uint64_t written = header.data_offset;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    ICHECK_LE(written, entries_[i].file_offset) << "params entries must be added in offset order";
+    while (written < entries_[i].file_offset) {
+      uint64_t pad = std::min<uint64_t>(entries_[i].file_offset - written, padding.size());
+      fs.write(padding.data(), pad);
+      written += pad;
+    }
+    fs.write(blobs_[i].data(), blobs_[i].size());
+    written += blobs_[i].size();
+  }
+  if (!packed_) {
+    while (written < header.data_offset + data_size) {
+      uint64_t pad = std::min<uint64_t>(header.data_offset + data_size - written, padding.size());
+      fs.write(padding.data(), pad);
+      written += pad;
+    }
+  }
+  ICHECK(!fs.fail()) << "Cannot write " << path;
+}
+
+int ParamsIndex::Find(const std::string& name) const {
+  for (size_t i = 0; i < names.size(); i++) {
+    if (names[i] == name) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool IsIndexedParams(const char* data, size_t size) {
+  return size >= sizeof(ParamsHeader) && memcmp(data, kParamsMagic, sizeof(kParamsMagic)) == 0;
+}
+
+static std::shared_ptr<char> AllocAligned(size_t size, size_t alignment) {
+  void* ptr = nullptr;
+#if defined(_WIN32)
+  ptr = _aligned_malloc(size, alignment);
+  ICHECK(ptr != nullptr) << "Cannot allocate " << size << " bytes for params";
+  return std::shared_ptr<char>(static_cast<char*>(ptr), _aligned_free);
+#else
+  ICHECK_EQ(posix_memalign(&ptr, alignment, size), 0)
+      << "Cannot allocate " << size << " bytes for params";
+  return std::shared_ptr<char>(static_cast<char*>(ptr), free);
+#endif
+}
+
+std::shared_ptr<char> LoadIndexedParams(std::shared_ptr<char> file, size_t size, bool verify,
+                                        ParamsIndex* index) {
+  ICHECK(IsIndexedParams(file.get(), size)) << "Not an indexed params file";
+  ParamsHeader header;
+  memcpy(&header, file.get(), sizeof(header));
+  ICHECK_EQ(header.version, kParamsVersion) << "Unsupported params version " << header.version;
+  uint64_t names_begin = sizeof(ParamsHeader) + header.num_entries * sizeof(ParamsEntry);
+  ICHECK_LE(names_begin + header.names_size, header.data_offset) << "Corrupted params index";
+  ICHECK_LE(header.data_offset, size) << "Truncated params file";
+
+  index->entries.resize(header.num_entries);
+  index->names.resize(header.num_entries);
+  memcpy(index->entries.data(), file.get() + sizeof(ParamsHeader),
+         header.num_entries * sizeof(ParamsEntry));
+  for (uint32_t i = 0; i < header.num_entries; i++) {
+    const ParamsEntry& entry = index->entries[i];
+    ICHECK_LE(entry.name_offset + entry.name_size, header.names_size) << "Corrupted params index";
+    ICHECK_LE(entry.file_offset + entry.stored_size, size) << "Truncated params file";
+    ICHECK_LE(entry.offset + entry.size, header.data_size) << "Corrupted params index";
+    index->names[i] = std::string(file.get() + names_begin + entry.name_offset, entry.name_size);
+  }
+
+  if (!(header.flags & kParamsFlagPacked)) {
+    ICHECK_LE(header.data_offset + header.data_size, size) << "Truncated params file";
+    if (verify) {
+      for (uint32_t i = 0; i < header.num_entries; i++) {
+        const ParamsEntry& entry = index->entries[i];
+        ICHECK_EQ(Checksum(file.get() + entry.file_offset, entry.size), entry.checksum)
+            << "Checksum mismatch of params " << index->names[i];
+      }
+    }
+    // share ownership of the file, pointing at its data section
+    return std::shared_ptr<char>(file, file.get() + header.data_offset);
+  }
+
+  std::shared_ptr<char> data = AllocAligned(std::max<uint64_t>(header.data_size, 1),
+                                            std::max<uint32_t>(header.alignment, sizeof(void*)));
+  memset(data.get(), 0, header.data_size);
+  for (uint32_t i = 0; i < header.num_entries; i++) {
+    const ParamsEntry& entry = index->entries[i];
+    char* dst = data.get() + entry.offset;
+    const char* src = file.get() + entry.file_offset;
+    if (entry.codec == kCodecDeflate) {
+#ifdef USE_CSINN_ZLIB
+      uLongf dst_size = entry.size;
+      int ret = uncompress(reinterpret_cast<Bytef*>(dst), &dst_size,
+                           reinterpret_cast<const Bytef*>(src), entry.stored_size);
+      ICHECK(ret == Z_OK && dst_size == entry.size)
+          << "Cannot decompress params " << index->names[i];
+#else
+      LOG(FATAL) << "Cannot decompress params " << index->names[i]
+                 << ", TVM is built without USE_CSINN_ZLIB";
+#endif
+    } else {
+      ICHECK_EQ(entry.codec, kCodecNone) << "Unknown params codec " << entry.codec;
+      memcpy(dst, src, entry.size);
+    }
+    ICHECK_EQ(Checksum(dst, entry.size), entry.checksum)
+        << "Checksum mismatch of params " << index->names[i];
+  }
+  return data;
+}
+
+}  // namespace hhb
+}  // namespace runtime
+}  // namespace tvm
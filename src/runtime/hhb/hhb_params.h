@@ -0,0 +1,158 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \brief Indexed params file shared by the CSINN codegen and HHBRuntime.
+ * \file hhb_params.h
+ *
+ *  Layout of the file:
+ *
+ *    ParamsHeader | ParamsEntry x num_entries | names | pad | data
+ *
+ *  The data section is what the generated code addresses through its params
+ *  pointer. When no entry is compressed it is stored verbatim, so the file can
+ *  be mapped and used in place; otherwise every entry is stored on its own and
+ *  the section is rebuilt at load time.
+ */
+#ifndef TVM_RUNTIME_HHB_HHB_PARAMS_H_
+#define TVM_RUNTIME_HHB_HHB_PARAMS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace hhb {
+
+constexpr char kParamsMagic[8] = {'H', 'H', 'B', 'P', 'A', 'R', 'A', 'M'};
+constexpr uint32_t kParamsVersion = 1;
+
+/*! \brief Some entries are stored apart from the data section layout. */
+constexpr uint32_t kParamsFlagPacked = 1;
+
+enum ParamsKind : uint32_t { kParamsQinfo = 0, kParamsConstant = 1 };
+
+enum ParamsCodec : uint32_t { kCodecNone = 0, kCodecDeflate = 1 };
+
+struct ParamsHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_entries;
+  uint32_t alignment;
+  uint32_t flags;
+  /*! \brief File offset of the data section. */
+  uint64_t data_offset;
+  /*! \brief Size of the data section as addressed by the generated code. */
+  uint64_t data_size;
+  uint64_t names_size;
+};
+
+struct ParamsEntry {
+  /*! \brief Offset of the entry in the data section. */
+  uint64_t offset;
+  uint64_t size;
+  /*! \brief Where the (maybe compressed) bytes of the entry are in the file. */
+  uint64_t file_offset;
+  uint64_t stored_size;
+  uint32_t kind;
+  uint32_t codec;
+  /*! \brief CRC32 of the uncompressed bytes. */
+  uint32_t checksum;
+  uint32_t name_offset;
+  uint32_t name_size;
+  char dtype[12];
+};
+
+static_assert(sizeof(ParamsHeader) == 48, "ParamsHeader layout changed");
+static_assert(sizeof(ParamsEntry) == 64, "ParamsEntry layout changed");
+
+/*! \brief Builds an indexed params file, used by the codegen. */
+class ParamsWriter {
+ public:
+  explicit ParamsWriter(size_t alignment) : alignment_(alignment) {}
+
+  /*!
+   * \brief Append one entry.
+   * \param name The entry name, unique and not empty.
+   * \param kind QINFO or CONSTANT.
+   * \param dtype The C type of the elements.
+   * \param offset The offset the generated code reads the entry from.
+   * \param data The raw bytes.
+   * \param size The number of raw bytes.
+   * \param compress Store the entry deflated if that makes it smaller, needs USE_CSINN_ZLIB.
+   */
+  void Add(const std::string& name, ParamsKind kind, const std::string& dtype, uint64_t offset,
+           const void* data, size_t size, bool compress);
+
+  /*!
+   * \brief Write the file.
+   * \param path The output path.
+   * \param data_size The size of the data section.
+   */
+  void Save(const std::string& path, uint64_t data_size);
+
+ private:
+  size_t alignment_;
+  std::vector<ParamsEntry> entries_;
+  std::vector<std::vector<char>> blobs_;
+  std::string names_;
+  std::unordered_set<std::string> names_seen_;
+  bool packed_{false};
+};
+
+/*! \brief The index of a loaded params file. */
+struct ParamsIndex {
+  std::vector<ParamsEntry> entries;
+  std::vector<std::string> names;
+
+  /*! \return The entry index of name, or -1. */
+  int Find(const std::string& name) const;
+};
+
+/*! \return Whether params entries can be deflated, i.e. TVM is built with USE_CSINN_ZLIB. */
+bool ParamsCompressionEnabled();
+
+/*! \return Whether the buffer starts with an indexed params header. */
+bool IsIndexedParams(const char* data, size_t size);
+
+/*!
+ * \brief Get the data section of an indexed params file.
+ *
+ *  Unpacked files are used in place and keep file alive; packed files are
+ *  inflated into a new buffer.
+ *
+ * \param file The whole file content.
+ * \param size The file size.
+ * \param verify Check the CRC32 of every entry.
+ * \param index Filled with the entries of the file.
+ * \return The data section.
+ */
+std::shared_ptr<char> LoadIndexedParams(std::shared_ptr<char> file, size_t size, bool verify,
+                                        ParamsIndex* index);
+
+}  // namespace hhb
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_HHB_HHB_PARAMS_H_
@@ -24,13 +24,22 @@
 
 #include <math.h>
 #include <stdio.h>
+#include <string.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/serializer.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <numeric>
@@ -45,26 +54,202 @@ namespace runtime {
 /*!
  * \brief Run all the operations one by one.
  */
-
 void HHBRuntime::Run() {
-  auto func = module_.GetFunction("csinn_runtime_wrapper_", false);
-  int i_size = input_.size();
-  void** inputs = reinterpret_cast<void**>(malloc(i_size * sizeof(void*)));
-  for (int i = 0; i < i_size; i++) {
-    inputs[i] = input_[i]->data;
+  ICHECK(params_ != nullptr) << "params must be set before run";
+  for (size_t i = 0; i < input_ptrs_.size(); i++) {
+    ICHECK(input_ptrs_[i] != nullptr) << "input " << i << " is not bound";
+  }
+  for (size_t i = 0; i < output_ptrs_.size(); i++) {
+    ICHECK(output_ptrs_[i] != nullptr) << "output " << i << " is not bound";
+  }
+  run_call_.Set(0, static_cast<void*>(input_ptrs_.data()));
+  run_call_.Set(1, static_cast<void*>(output_ptrs_.data()));
+  run_call_.Set(2, params_.get());
+  if (arena_.defined()) {
+    run_call_.Set(3, arena_->data);
+  }
+  if (num_layers_ > 0) {
+    run_call_.Set(4, static_cast<void*>(layer_time_));
+  }
+  run_call_.Run();
+}
+
+profiling::Report HHBRuntime::Profile() {
+  PackedFunc layer_info = module_.GetFunction("csinn_layer_info_", false);
+  ICHECK(layer_info != nullptr && num_layers_ > 0)
+      << "The model is generated without layer_profile";
+  int num_layers = num_layers_;
+  // the timing buffer is handed to this run only, other sessions keep running untimed
+  std::vector<int64_t> layer_time(num_layers, 0);
+  layer_time_ = layer_time.data();
+  auto start = std::chrono::steady_clock::now();
+  try {
+    Run();
+  } catch (...) {
+    layer_time_ = nullptr;
+    throw;
+  }
+  auto end = std::chrono::steady_clock::now();
+  layer_time_ = nullptr;
+  double total_us = std::chrono::duration<double, std::micro>(end - start).count();
+
+  String device = String(std::string(DeviceName(kDLCPU)) + "0");
+  Array<Map<String, ObjectRef>> calls;
+  for (int i = 0; i < num_layers; i++) {
+    Map<String, ObjectRef> row;
+    double us = layer_time[i] / 1e3;
+    row.Set("Name", String(static_cast<const char*>(layer_info(i, 0).operator void*())));
+    row.Set("Duration (us)", ObjectRef(make_object<profiling::DurationNode>(us)));
+    row.Set("Percent", ObjectRef(make_object<profiling::PercentNode>(us / total_us * 100)));
+    row.Set("Count", ObjectRef(make_object<profiling::CountNode>(1)));
+    row.Set("Device", device);
+    int64_t bytes_read = layer_info(i, 1);
+    int64_t bytes_written = layer_info(i, 2);
+    row.Set("Bytes Read", ObjectRef(make_object<profiling::CountNode>(bytes_read)));
+    row.Set("Bytes Written", ObjectRef(make_object<profiling::CountNode>(bytes_written)));
+    calls.push_back(row);
   }
 
-  int o_size = output_.size();
-  void** outputs = reinterpret_cast<void**>(malloc(o_size * sizeof(void*)));
-  for (int i = 0; i < o_size; i++) {
-    outputs[i] = output_[i]->data;
+  Map<String, ObjectRef> total;
+  total.Set("Name", String("Total"));
+  total.Set("Duration (us)", ObjectRef(make_object<profiling::DurationNode>(total_us)));
+  int64_t arena_bytes = arena_.defined() ? GetDataSize(*arena_.operator->()) : 0;
+  total.Set("Arena Size", ObjectRef(make_object<profiling::CountNode>(arena_bytes)));
+  Map<String, Map<String, ObjectRef>> device_metrics;
+  device_metrics.Set(device, total);
+  return profiling::Report(calls, device_metrics);
+}
+
+/*! \brief The batch split over the worker sessions of RunBatch. */
+struct HHBBatchJob {
+  std::vector<HHBRuntime*> sessions;
+  std::vector<char*> input_base;
+  std::vector<size_t> input_bytes;
+  std::vector<char*> output_base;
+  std::vector<size_t> output_bytes;
+  int batch;
+};
+
+int HHBRuntime::BatchTask(int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+  HHBBatchJob* job = static_cast<HHBBatchJob*>(cdata);
+  // the pool may split the launch into more tasks than there are sessions
+  int num_sessions = std::min<int>(penv->num_task, job->sessions.size());
+  if (task_id >= num_sessions) {
+    return 0;
+  }
+  HHBRuntime* sess = job->sessions[task_id];
+  try {
+    for (int b = task_id; b < job->batch; b += num_sessions) {
+      for (size_t i = 0; i < job->input_base.size(); i++) {
+        sess->input_ptrs_[i] = job->input_base[i] + b * job->input_bytes[i];
+      }
+      for (size_t i = 0; i < job->output_base.size(); i++) {
+        sess->output_ptrs_[i] = job->output_base[i] + b * job->output_bytes[i];
+      }
+      sess->Run();
+    }
+  } catch (const std::exception& e) {
+    TVMAPISetLastError(e.what());
+    return -1;
+  }
+  return 0;
+}
+
+void HHBRuntime::RunBatch(const Array<NDArray>& inputs, const Array<NDArray>& outputs,
+                          int batch) {
+  ICHECK_GT(batch, 0);
+  ICHECK(params_ != nullptr) << "params must be set before run";
+  HHBBatchJob job;
+  job.batch = batch;
+  // every array holds batch samples of the model input/output it is bound to
+  auto add_arrays = [batch](const Array<NDArray>& arrays, const std::vector<IOInfo>& info,
+                            const char* kind, std::vector<char*>* base,
+                            std::vector<size_t>* sample_bytes) {
+    if (!info.empty()) {
+      ICHECK_EQ(arrays.size(), info.size())
+          << "the model has " << info.size() << " " << kind << "s, got " << arrays.size();
+    }
+    for (size_t i = 0; i < arrays.size(); i++) {
+      const DLTensor* arr = arrays[i].operator->();
+      ICHECK_EQ(arr->device.device_type, kDLCPU) << kind << " " << i << " is not on the CPU";
+      ICHECK(IsContiguous(*arr)) << kind << " " << i << " is not contiguous";
+      size_t bytes = GetDataSize(*arr);
+      if (info.empty()) {
+        ICHECK_EQ(bytes % batch, 0U)
+            << kind << " " << i << " size is not a multiple of the batch " << batch;
+      } else {
+        ICHECK(DataType(arr->dtype) == DataType(info[i].dtype))
+            << kind << " " << i << " dtype mismatch, expected " << DataType(info[i].dtype)
+            << ", got " << DataType(arr->dtype);
+        ICHECK_EQ(bytes, info[i].bytes * batch)
+            << kind << " " << i << " should hold " << batch << " samples of " << info[i].bytes
+            << " bytes";
+      }
+      base->push_back(static_cast<char*>(arr->data) + arr->byte_offset);
+      sample_bytes->push_back(bytes / batch);
+    }
+  };
+  add_arrays(inputs, input_info_, "input", &job.input_base, &job.input_bytes);
+  add_arrays(outputs, output_info_, "output", &job.output_base, &job.output_bytes);
+
+  int num_workers = std::min(batch, threading::MaxConcurrency());
+  while (batch_sessions_.size() < static_cast<size_t>(num_workers)) {
+    batch_sessions_.push_back(CreateSession());
+  }
+  for (int i = 0; i < num_workers; i++) {
+    HHBRuntime* sess = static_cast<HHBRuntime*>(batch_sessions_[i].operator->());
+    sess->input_ptrs_.resize(inputs.size(), nullptr);
+    sess->output_ptrs_.resize(outputs.size(), nullptr);
+    sess->input_.resize(inputs.size());
+    sess->output_.resize(outputs.size());
+    job.sessions.push_back(sess);
+  }
+  // one task per worker thread of the pool, each driving its own session
+  int ret = TVMBackendParallelLaunch(BatchTask, &job, 0);
+  ICHECK_EQ(ret, 0) << TVMGetLastError();
+}
+
+/*!
+ * \brief Allocate the intermediate arena of this session, if the model was
+ *  generated with a static memory plan. The arena also holds the tensors the
+ *  first run creates, it starts zeroed so that run knows to create them.
+ */
+void HHBRuntime::AllocArena() {
+  PackedFunc arena_size = module_.GetFunction("csinn_arena_size_", false);
+  if (arena_size == nullptr) {
+    return;
+  }
+  int64_t size = arena_size();
+  arena_ = NDArray::Empty({size}, DLDataType{kDLUInt, 8, 1}, Device{kDLCPU, 0});
+  memset(arena_->data, 0, size);
+}
+
+/*!
+ * \brief Read the dtype and size of the model inputs and outputs, if the model
+ *  reports them, to check the buffers bound by the caller.
+ */
+void HHBRuntime::LoadIOInfo() {
+  PackedFunc io_info = module_.GetFunction("csinn_io_info_", false);
+  if (io_info == nullptr) {
+    return;
+  }
+  std::vector<IOInfo>* infos[2] = {&input_info_, &output_info_};
+  for (int kind = 0; kind < 2; kind++) {
+    int num = io_info(kind);
+    infos[kind]->clear();
+    for (int i = 0; i < num; i++) {
+      IOInfo info;
+      info.bytes = static_cast<int64_t>(io_info(kind, i, 0));
+      info.dtype.code = static_cast<uint8_t>(static_cast<int64_t>(io_info(kind, i, 1)));
+      info.dtype.bits = static_cast<uint8_t>(static_cast<int64_t>(io_info(kind, i, 2)));
+      info.dtype.lanes = 1;
+      infos[kind]->push_back(info);
+    }
   }
-  func(inputs, outputs, params_);
 }
 
 /*!
  * \brief Initialize the graph executor with graph and context.
- * \param graph_json The execution graph.
  * \param module The module containing the compiled functions for the host
  * processor.
  * \param ctxs The context of the host and devices where graph nodes will be
@@ -73,19 +258,157 @@ void HHBRuntime::Run() {
 void HHBRuntime::Init(tvm::runtime::Module module, const std::vector<Device>& ctxs) {
   module_ = module;
   ctxs_ = ctxs;
+  run_func_ = module_.GetFunction("csinn_runtime_wrapper_", false);
+  ICHECK(run_func_ != nullptr) << "Cannot find csinn_runtime_wrapper_ in the module";
+  AllocArena();
+  LoadIOInfo();
+  PackedFunc layer_info = module_.GetFunction("csinn_layer_info_", false);
+  num_layers_ = layer_info != nullptr ? static_cast<int>(layer_info()) : 0;
+  BindRunCall();
 }
 
 /*!
- * \brief set input to the graph.
- * \param data The input data.
+ * \brief Bind run_call_ to the wrapper, with the arena and the layer timing
+ *  buffer slots if the model takes them.
  */
-void HHBRuntime::SetOutput(NDArray data) { output_.push_back(data); }
+void HHBRuntime::BindRunCall() {
+  int num_args = 3;
+  if (num_layers_ > 0) {
+    num_args = 5;
+  } else if (arena_.defined()) {
+    num_args = 4;
+  }
+  run_call_ = BoundPackedCall(run_func_, num_args);
+}
+
+Module HHBRuntime::CreateSession() const {
+  auto exec = make_object<HHBRuntime>();
+  exec->module_ = module_;
+  exec->ctxs_ = ctxs_;
+  exec->run_func_ = run_func_;
+  exec->params_ = params_;
+  exec->params_index_ = params_index_;
+  exec->input_map_ = input_map_;
+  exec->output_map_ = output_map_;
+  exec->input_info_ = input_info_;
+  exec->output_info_ = output_info_;
+  exec->num_layers_ = num_layers_;
+  exec->input_.resize(input_.size());
+  exec->input_ptrs_.resize(input_ptrs_.size(), nullptr);
+  exec->output_.resize(output_.size());
+  exec->output_ptrs_.resize(output_ptrs_.size(), nullptr);
+  exec->AllocArena();
+  exec->BindRunCall();
+  return Module(exec);
+}
+
+void HHBRuntime::SetInputNames(const Array<String>& names) {
+  input_map_.clear();
+  for (size_t i = 0; i < names.size(); i++) {
+    input_map_[names[i]] = i;
+  }
+}
+
+void HHBRuntime::SetOutputNames(const Array<String>& names) {
+  output_map_.clear();
+  for (size_t i = 0; i < names.size(); i++) {
+    output_map_[names[i]] = i;
+  }
+}
+
+int HHBRuntime::GetInputIndex(const std::string& name) const {
+  auto it = input_map_.find(name);
+  if (it != input_map_.end()) {
+    return it->second;
+  }
+  return -1;
+}
+
+int HHBRuntime::GetOutputIndex(const std::string& name) const {
+  auto it = output_map_.find(name);
+  if (it != output_map_.end()) {
+    return it->second;
+  }
+  return -1;
+}
 
 /*!
- * \brief set output to the graph.
- * \param data The output data.
+ * \brief Grow the binding tables so that index is addressable.
  */
-void HHBRuntime::SetInput(NDArray data_in) { input_.push_back(data_in); }
+template <typename T>
+static void EnsureSlot(std::vector<T>* arrays, std::vector<void*>* ptrs, int index) {
+  ICHECK_GE(index, 0);
+  if (static_cast<size_t>(index) >= ptrs->size()) {
+    arrays->resize(index + 1);
+    ptrs->resize(index + 1, nullptr);
+  }
+}
+
+void HHBRuntime::CheckExternalDLTensor(const DLTensor* external, const std::vector<IOInfo>& info,
+                                       int index) {
+  // the generated code reads and writes plain host buffers
+  ICHECK_EQ(external->device.device_type, kDLCPU)
+      << "tensor " << index << " must be on CPU, got " << DeviceName(external->device.device_type);
+  ICHECK(IsContiguous(*external)) << "tensor " << index << " must be contiguous";
+  if (info.empty()) {
+    return;
+  }
+  ICHECK_LT(static_cast<size_t>(index), info.size()) << "The model has " << info.size()
+                                                     << " tensors, cannot bind " << index;
+  ICHECK(DataType(external->dtype) == DataType(info[index].dtype))
+      << "tensor " << index << " expects dtype " << DLDataType2String(info[index].dtype)
+      << ", got " << DLDataType2String(external->dtype);
+  ICHECK_EQ(GetDataSize(*external), info[index].bytes)
+      << "tensor " << index << " size mismatch";
+}
+
+/*!
+ * \brief set index-th input to the graph.
+ * \param index The input index.
+ * \param data_in The input data.
+ */
+void HHBRuntime::SetInput(int index, NDArray data_in) {
+  CheckExternalDLTensor(data_in.operator->(), input_info_, index);
+  EnsureSlot(&input_, &input_ptrs_, index);
+  input_[index] = data_in;
+  input_ptrs_[index] = static_cast<char*>(data_in->data) + data_in->byte_offset;
+}
+
+/*!
+ * \brief set index-th input to the graph without copying the data.
+ * \param index The input index.
+ * \param data_ref The input data that is referred.
+ */
+void HHBRuntime::SetInputZeroCopy(int index, DLTensor* data_ref) {
+  CheckExternalDLTensor(data_ref, input_info_, index);
+  EnsureSlot(&input_, &input_ptrs_, index);
+  input_[index] = NDArray();
+  input_ptrs_[index] = static_cast<char*>(data_ref->data) + data_ref->byte_offset;
+}
+
+/*!
+ * \brief set index-th output of the graph.
+ * \param index The output index.
+ * \param data The output buffer.
+ */
+void HHBRuntime::SetOutput(int index, NDArray data) {
+  CheckExternalDLTensor(data.operator->(), output_info_, index);
+  EnsureSlot(&output_, &output_ptrs_, index);
+  output_[index] = data;
+  output_ptrs_[index] = static_cast<char*>(data->data) + data->byte_offset;
+}
+
+/*!
+ * \brief set index-th output of the graph without copying the data.
+ * \param index The output index.
+ * \param data_ref The output data that is referred.
+ */
+void HHBRuntime::SetOutputZeroCopy(int index, DLTensor* data_ref) {
+  CheckExternalDLTensor(data_ref, output_info_, index);
+  EnsureSlot(&output_, &output_ptrs_, index);
+  output_[index] = NDArray();
+  output_ptrs_[index] = static_cast<char*>(data_ref->data) + data_ref->byte_offset;
+}
 
 /*!
  * \brief Return NDArray for given input index.
@@ -93,7 +416,11 @@ void HHBRuntime::SetInput(NDArray data_in) { input_.push_back(data_in); }
  *
  * \return NDArray corresponding to given input node index.
  */
-NDArray HHBRuntime::GetInput(int index) const { return input_[index]; }
+NDArray HHBRuntime::GetInput(int index) const {
+  ICHECK_LT(static_cast<size_t>(index), input_.size());
+  ICHECK(input_[index].defined()) << "input " << index << " is bound by zero copy";
+  return input_[index];
+}
 
 /*!
  * \brief Return NDArray for given output index.
@@ -101,59 +428,219 @@ NDArray HHBRuntime::GetInput(int index) const { return input_[index]; }
  *
  * \return NDArray corresponding to given output node index.
  */
-NDArray HHBRuntime::GetOutput(int index) {
-  input_.clear();
+NDArray HHBRuntime::GetOutput(int index) const {
+  ICHECK_LT(static_cast<size_t>(index), output_.size());
+  ICHECK(output_[index].defined()) << "output " << index << " is bound by zero copy";
   return output_[index];
 }
 
-char* read_file_content(const std::string& path) {
+static char* read_file_content(const std::string& path, size_t* size) {
   FILE* fp = fopen(path.c_str(), "rb");
   if (fp == NULL) {
     return NULL;
   }
   fseek(fp, 0, SEEK_END);
-  int file_size = ftell(fp);
+  long file_size = ftell(fp);
   rewind(fp);
 
   char* buffer = reinterpret_cast<char*>(malloc(file_size));
   if (buffer == NULL) {
+    fclose(fp);
     return NULL;
   }
 
-  int ret = fread(buffer, 1, file_size, fp);
+  long ret = fread(buffer, 1, file_size, fp);
+  fclose(fp);
   if (ret != file_size) {
+    free(buffer);
     return NULL;
   }
-
-  fclose(fp);
+  *size = file_size;
   return buffer;
 }
 
-void HHBRuntime::SetParams(const std::string& params_path) {
-  params_ = read_file_content(params_path);
+/*!
+ * \brief Map the params file into memory.
+ *
+ *  The mapping is read-only and shared: the pages stay in the page cache shared
+ *  by every process and session using the same file, and are only paged in when
+ *  first read.
+ */
+static std::shared_ptr<char> map_file_content(const std::string& path, size_t* size) {
+#if defined(_WIN32)
+  LOG(FATAL) << "mmap params is not supported on Windows";
+  return nullptr;
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  ICHECK_GE(fd, 0) << "Cannot open params " << path;
+  struct stat st;
+  ICHECK_EQ(fstat(fd, &st), 0) << "Cannot stat params " << path;
+  size_t map_size = static_cast<size_t>(st.st_size);
+  ICHECK_GT(map_size, 0U) << "Empty params " << path;
+  void* addr = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  ICHECK(addr != MAP_FAILED) << "Cannot mmap params " << path;
+  *size = map_size;
+  return std::shared_ptr<char>(static_cast<char*>(addr),
+                               [map_size](char* ptr) { munmap(ptr, map_size); });
+#endif
+}
+
+void HHBRuntime::SetParams(const std::string& params_path, bool use_mmap) {
+  size_t size = 0;
+  std::shared_ptr<char> file;
+  if (use_mmap) {
+    file = map_file_content(params_path, &size);
+  } else {
+    char* buffer = read_file_content(params_path, &size);
+    ICHECK(buffer != NULL) << "Cannot read params from " << params_path;
+    file = std::shared_ptr<char>(buffer, free);
+  }
+  if (!hhb::IsIndexedParams(file.get(), size)) {
+    params_ = file;
+    params_index_ = nullptr;
+  } else {
+    // checksums of a mapped file are skipped, they would page in the whole file
+    auto index = std::make_shared<hhb::ParamsIndex>();
+    params_ = hhb::LoadIndexedParams(file, size, !use_mmap, index.get());
+    params_index_ = index;
+  }
+  // the workers of RunBatch run on the params of this session
+  for (Module& mod : batch_sessions_) {
+    HHBRuntime* sess = static_cast<HHBRuntime*>(mod.operator->());
+    sess->params_ = params_;
+    sess->params_index_ = params_index_;
+  }
+}
+
+NDArray HHBRuntime::GetParam(const std::string& name) const {
+  ICHECK(params_index_ != nullptr) << "params are not loaded from an indexed params file";
+  int idx = params_index_->Find(name);
+  ICHECK_GE(idx, 0) << "Cannot find param " << name;
+  const hhb::ParamsEntry& entry = params_index_->entries[idx];
+  NDArray ret = NDArray::Empty({static_cast<int64_t>(entry.size)}, DLDataType{kDLUInt, 8, 1},
+                               Device{kDLCPU, 0});
+  ret.CopyFromBytes(params_.get() + entry.offset, entry.size);
+  return ret;
 }
 
 PackedFunc HHBRuntime::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   // Return member functions during query.
   if (name == "set_input") {
-    return PackedFunc(
-        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetInput(args[0]); });
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (args.num_args == 1) {
+        // Positional binding kept for scripts written against the append-only API.
+        this->SetInput(this->NumInputs(), args[0]);
+      } else if (String::CanConvertFrom(args[0])) {
+        int in_idx = this->GetInputIndex(args[0].operator String());
+        ICHECK_GE(in_idx, 0) << "Cannot find input " << args[0].operator String();
+        this->SetInput(in_idx, args[1]);
+      } else {
+        this->SetInput(args[0], args[1]);
+      }
+    });
+  } else if (name == "set_input_zero_copy") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (String::CanConvertFrom(args[0])) {
+        int in_idx = this->GetInputIndex(args[0].operator String());
+        ICHECK_GE(in_idx, 0) << "Cannot find input " << args[0].operator String();
+        this->SetInputZeroCopy(in_idx, args[1]);
+      } else {
+        this->SetInputZeroCopy(args[0], args[1]);
+      }
+    });
   } else if (name == "set_params") {
-    return PackedFunc(
-        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetParams(args[0]); });
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      bool use_mmap = args.num_args > 1 ? args[1].operator bool() : false;
+      this->SetParams(args[0], use_mmap);
+    });
+  } else if (name == "get_param") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->GetParam(args[0].operator String());
+    });
   } else if (name == "set_output") {
-    return PackedFunc(
-        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->SetOutput(args[0]); });
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (args.num_args == 1) {
+        this->SetOutput(this->NumOutputs(), args[0]);
+      } else if (String::CanConvertFrom(args[0])) {
+        int out_idx = this->GetOutputIndex(args[0].operator String());
+        ICHECK_GE(out_idx, 0) << "Cannot find output " << args[0].operator String();
+        this->SetOutput(out_idx, args[1]);
+      } else {
+        this->SetOutput(args[0], args[1]);
+      }
+    });
+  } else if (name == "set_output_zero_copy") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (String::CanConvertFrom(args[0])) {
+        int out_idx = this->GetOutputIndex(args[0].operator String());
+        ICHECK_GE(out_idx, 0) << "Cannot find output " << args[0].operator String();
+        this->SetOutputZeroCopy(out_idx, args[1]);
+      } else {
+        this->SetOutputZeroCopy(args[0], args[1]);
+      }
+    });
+  } else if (name == "set_input_names") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetInputNames(args[0].operator Array<String>());
+    });
+  } else if (name == "set_output_names") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SetOutputNames(args[0].operator Array<String>());
+    });
+  } else if (name == "get_input_index") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->GetInputIndex(args[0].operator String());
+    });
   } else if (name == "get_output") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->GetOutput(args[0]); });
   } else if (name == "get_input") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       int in_idx = 0;
-      in_idx = args[0];
-      CHECK_GE(in_idx, 0);
+      if (String::CanConvertFrom(args[0])) {
+        in_idx = this->GetInputIndex(args[0].operator String());
+      } else {
+        in_idx = args[0];
+      }
+      ICHECK_GE(in_idx, 0);
       *rv = this->GetInput(in_idx);
     });
+  } else if (name == "get_input_dtype") {
+    // the dtype the model reports for an input, empty if it reports none
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int in_idx = 0;
+      if (String::CanConvertFrom(args[0])) {
+        in_idx = this->GetInputIndex(args[0].operator String());
+      } else {
+        in_idx = args[0];
+      }
+      if (in_idx < 0 || static_cast<size_t>(in_idx) >= input_info_.size()) {
+        *rv = std::string();
+      } else {
+        *rv = DLDataType2String(input_info_[in_idx].dtype);
+      }
+    });
+  } else if (name == "get_num_inputs") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumInputs(); });
+  } else if (name == "get_num_outputs") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumOutputs(); });
+  } else if (name == "get_arena_size") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = arena_.defined() ? arena_.Shape()[0] : 0;
+    });
+  } else if (name == "create_session") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->CreateSession(); });
+  } else if (name == "run_batch") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->RunBatch(args[0], args[1], args[2]);
+    });
+  } else if (name == "profile") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Profile(); });
   } else if (name == "run") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
   } else {
@@ -28,8 +28,13 @@
 #include <dlpack/dlpack.h>
 #include <dmlc/json.h>
 #include <dmlc/memory_io.h>
+#include <tvm/runtime/bound_packed_call.h>
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/container/array.h>
+#include <tvm/runtime/container/string.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
 
 #include <memory>
 #include <string>
@@ -37,6 +42,8 @@
 #include <utility>
 #include <vector>
 
+#include "hhb_params.h"
+
 namespace tvm {
 namespace runtime {
 
@@ -61,27 +68,126 @@ class TVM_DLL HHBRuntime : public ModuleNode {
    */
   const char* type_key() const final { return "HHBRuntime"; }
 
+  /*!
+   * \brief Run the model once with the currently bound inputs and outputs.
+   */
   void Run();
 
+  /*!
+   * \brief Run the model once and time every layer.
+   *
+   *  Needs a model generated with layer_profile. The timing buffer belongs
+   *  to this call, so sessions sharing the model can run or profile at the
+   *  same time.
+   *
+   * \return The per layer duration, bytes read and written, and the arena size.
+   */
+  profiling::Report Profile();
+
+  /*!
+   * \brief Run the model over a batch of requests in one call.
+   *
+   *  Every input/output holds batch samples laid out back to back along the
+   *  outermost axis, each of the dtype and size of the model input/output.
+   *  Each sample is bound in place, without copies, and the samples are spread
+   *  over worker sessions running concurrently. The bindings of this session
+   *  are left untouched.
+   *
+   * \param inputs The batched inputs, in model input order.
+   * \param outputs The batched outputs, in model output order.
+   * \param batch The number of samples.
+   */
+  void RunBatch(const Array<NDArray>& inputs, const Array<NDArray>& outputs, int batch);
+
   /*!
    * \brief Initialize the graph executor with graph and context.
-   * \param graph_json The execution graph.
    * \param module The module containing the compiled functions for the host
    *  processor.
    * \param ctxs The context of the host and devices where graph nodes will be
    *  executed on.
    */
-
   void Init(tvm::runtime::Module module, const std::vector<Device>& ctxs);
 
   /*!
-   * \brief set index-th input to the graph.
+   * \brief Create an independent session sharing the loaded module and params.
+   *
+   *  The new session owns its own input/output bindings, so several sessions
+   *  can be driven concurrently from different threads.
+   *
+   * \return The new session module.
+   */
+  Module CreateSession() const;
+
+  /*!
+   * \brief Set the names of the inputs so they can be bound by name.
+   * \param names The input names in positional order.
+   */
+  void SetInputNames(const Array<String>& names);
+  /*!
+   * \brief Set the names of the outputs so they can be bound by name.
+   * \param names The output names in positional order.
+   */
+  void SetOutputNames(const Array<String>& names);
+  /*!
+   * \brief Get the input index given the name of input.
+   * \param name The name of the input.
+   * \return The index of input, -1 if not found.
+   */
+  int GetInputIndex(const std::string& name) const;
+  /*!
+   * \brief Get the output index given the name of output.
+   * \param name The name of the output.
+   * \return The index of output, -1 if not found.
+   */
+  int GetOutputIndex(const std::string& name) const;
+
+  /*!
+   * \brief Bind index-th input of the graph. The array is referenced, not copied,
+   *  and stays bound across runs until it is replaced.
    * \param index The input index.
-   * \param data_in The input data.
+   * \param data The input data.
    */
-  void SetInput(NDArray data);
-  void SetParams(const std::string& params_path);
-  void SetOutput(NDArray data);
+  void SetInput(int index, NDArray data);
+  /*!
+   * \brief Bind index-th input to a caller owned buffer without copying the data.
+   *  The caller must keep the buffer alive while it is bound. The buffer must be a
+   *  compact CPU tensor of the dtype and size of the model input.
+   * \param index The input index.
+   * \param data_ref The input data that is referred.
+   */
+  void SetInputZeroCopy(int index, DLTensor* data_ref);
+  /*!
+   * \brief Bind index-th output of the graph. The array is referenced, not copied.
+   * \param index The output index.
+   * \param data The output buffer.
+   */
+  void SetOutput(int index, NDArray data);
+  /*!
+   * \brief Bind index-th output to a caller owned buffer without copying the data.
+   *  The buffer must be a compact CPU tensor of the dtype and size of the model output.
+   * \param index The output index.
+   * \param data_ref The output data that is referred.
+   */
+  void SetOutputZeroCopy(int index, DLTensor* data_ref);
+  /*!
+   * \brief Load the constant params of the model.
+   * \param params_path The path of the params file.
+   * \param use_mmap Map the file read-only instead of reading it into a private
+   *  buffer, so the weights are paged in lazily and shared across processes. The
+   *  model must not write to its constants then.
+   *
+   *  Both the raw params blob and the indexed format of hhb_params.h are
+   *  accepted. Indexed files read into memory are checked against their CRC32;
+   *  the checksums of a mapped file are skipped, as checking them would page in
+   *  the whole file. Compressed entries are always inflated and checked.
+   */
+  void SetParams(const std::string& params_path, bool use_mmap = false);
+  /*!
+   * \brief Get a copy of one entry of an indexed params file.
+   * \param name The tensor name.
+   * \return The raw bytes of the entry.
+   */
+  NDArray GetParam(const std::string& name) const;
   /*!
    * \brief Return NDArray for given input index.
    * \param index The input index.
@@ -95,19 +201,74 @@ class TVM_DLL HHBRuntime : public ModuleNode {
    *
    * \return NDArray corresponding to given output node index.
    */
-  NDArray GetOutput(int index);
+  NDArray GetOutput(int index) const;
+  /*!
+   * \brief Get the number of bound inputs.
+   * \return The number of inputs.
+   */
+  int NumInputs() const { return input_ptrs_.size(); }
+  /*!
+   * \brief Get the number of bound outputs.
+   * \return The number of outputs.
+   */
+  int NumOutputs() const { return output_ptrs_.size(); }
 
  protected:
   /*! \brief The code module that contains both host and device code. */
   tvm::runtime::Module module_;
   /*! \brief Execution context of all devices including the host. */
   std::vector<Device> ctxs_;
+  /*! \brief The generated entry of the model, looked up once at init. */
+  PackedFunc run_func_;
+  /*! \brief The call of run_func_ made by Run, its arguments are packed in place. */
+  BoundPackedCall run_call_;
 
+  /*! \brief Bound inputs, empty when bound through a zero copy DLTensor. */
   std::vector<NDArray> input_;
+  /*! \brief Bound outputs, empty when bound through a zero copy DLTensor. */
   std::vector<NDArray> output_;
-  const char* out_buf_;
-  size_t output_size_;
-  char* params_;
+  /*! \brief Data pointers handed to the generated wrapper, kept in sync with the bindings. */
+  std::vector<void*> input_ptrs_;
+  std::vector<void*> output_ptrs_;
+  /*! \brief Map of input/output names to their index. */
+  std::unordered_map<std::string, int> input_map_;
+  std::unordered_map<std::string, int> output_map_;
+  /*! \brief The constant params, shared by all sessions created from this module. */
+  std::shared_ptr<char> params_;
+  /*! \brief Index of the params, null for a raw params blob. */
+  std::shared_ptr<const hhb::ParamsIndex> params_index_;
+  /*! \brief Intermediate tensor arena of this session, undefined without a static memory plan. */
+  NDArray arena_;
+  /*! \brief The number of layers the model times, 0 without layer_profile. */
+  int num_layers_{0};
+  /*! \brief The timing buffer of the running Profile call, null otherwise. */
+  int64_t* layer_time_{nullptr};
+
+  /*! \brief Dtype and size of one input or output, as reported by the model. */
+  struct IOInfo {
+    DLDataType dtype;
+    size_t bytes;
+  };
+  /*! \brief The model inputs and outputs, empty if the model does not report them. */
+  std::vector<IOInfo> input_info_;
+  std::vector<IOInfo> output_info_;
+
+  /*! \brief Worker sessions used by RunBatch, created on demand, they follow SetParams. */
+  std::vector<Module> batch_sessions_;
+
+ private:
+  void AllocArena();
+  void LoadIOInfo();
+  void BindRunCall();
+  /*!
+   * \brief Check that a caller buffer can be bound as a model input or output.
+   * \param external The buffer to bind.
+   * \param info The model input or output it is bound to, empty if unknown.
+   * \param index The index of the input or output, for the error message.
+   */
+  static void CheckExternalDLTensor(const DLTensor* external, const std::vector<IOInfo>& info,
+                                    int index);
+  static int BatchTask(int task_id, TVMParallelGroupEnv* penv, void* cdata);
 };
 }  // namespace runtime
 }  // namespace tvm
@@ -24,6 +24,7 @@
 #include "library_module.h"
 
 #include <dmlc/memory_io.h>
+#include <tvm/runtime/bound_packed_call.h>
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/registry.h>
 
@@ -71,8 +72,15 @@ class ModuleInternal {
   static std::vector<Module>* GetImportsAddr(ModuleNode* node) { return &(node->imports_); }
 };
 
-PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>& sptr_to_self) {
-  return PackedFunc([faddr, sptr_to_self](TVMArgs args, TVMRetValue* rv) {
+/*!
+ * \brief The body of the PackedFuncs made by WrapPackedFunc, a named type so that
+ *  GetBackendPackedCFunc can find the function address back.
+ */
+struct BackendPackedCFuncCaller {
+  TVMBackendPackedCFunc faddr;
+  ObjectPtr<Object> sptr_to_self;
+
+  void operator()(TVMArgs args, TVMRetValue* rv) const {
     TVMValue ret_value;
     int ret_type_code = kTVMNullptr;
     int ret = (*faddr)(const_cast<TVMValue*>(args.values), const_cast<int*>(args.type_codes),
@@ -81,7 +89,17 @@ PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>&
     if (ret_type_code != kTVMNullptr) {
       *rv = TVMRetValue::MoveFromCHost(ret_value, ret_type_code);
     }
-  });
+  }
+};
+
+PackedFunc WrapPackedFunc(TVMBackendPackedCFunc faddr, const ObjectPtr<Object>& sptr_to_self) {
+  return PackedFunc(BackendPackedCFuncCaller{faddr, sptr_to_self});
+}
+
+TVMBackendPackedCFunc GetBackendPackedCFunc(const PackedFunc& func) {
+  PackedFunc::FType body = func.body();
+  const auto* caller = body.target<BackendPackedCFuncCaller>();
+  return caller != nullptr ? caller->faddr : nullptr;
 }
 
 void InitContextFunctions(std::function<void*(const char*)> fgetsymbol) {
@@ -58,6 +58,9 @@ enum class RPCCode : int {
   kDevCreateStream,
   kDevFreeStream,
   kDevSetStream,
+  // Copies with a zero run-length encoded payload, only served by the C++ endpoint.
+  kCopyToRemoteCompressed,
+  kCopyFromRemoteCompressed,
 };
 
 /*!
@@ -122,6 +125,10 @@ inline const char* RPCCodeToString(RPCCode code) {
       return "kCopyAmongRemote";
     case RPCCode::kDevAllocDataWithScope:
       return "kDevAllocDataWithScope";
+    case RPCCode::kCopyToRemoteCompressed:
+      return "kCopyToRemoteCompressed";
+    case RPCCode::kCopyFromRemoteCompressed:
+      return "kCopyFromRemoteCompressed";
     default:
       return "";
   }
@@ -34,6 +34,22 @@ PackedFunc PipelineExecutor::GetFunction(const std::string& name,
   if (name == "get_num_outputs") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->NumOutputs(); });
+  } else if (name == "run") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = pipeline_scheduler_.Run(args[0].operator Map<String, NDArray>());
+    });
+  } else if (name == "get_output") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = pipeline_scheduler_.GetOutput();
+    });
+  } else if (name == "get_num_pending") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = pipeline_scheduler_.NumPending();
+    });
+  } else if (name == "get_statistics") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = pipeline_scheduler_.GetStatistics();
+    });
   } else {
     LOG(FATAL) << "Unknown packed function: " << name;
     return PackedFunc();
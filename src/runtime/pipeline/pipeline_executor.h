@@ -128,6 +128,7 @@ class TVM_DLL PipelineExecutor : public ModuleNode {
       reader->BeginObject();
       int mod_idx = -1;
       OutputMap output;
+      InputMap input;
       std::string dev;
       while (reader->NextObjectItem(&key)) {
         if (key == "mod_idx") {
@@ -136,6 +137,8 @@ class TVM_DLL PipelineExecutor : public ModuleNode {
           reader->Read(&dev);
         } else if (key == "output") {
           reader->Read(&output);
+        } else if (key == "input") {
+          reader->Read(&input);
         } else {
           LOG(FATAL) << "do not support key " << key;
         }
@@ -144,6 +147,7 @@ class TVM_DLL PipelineExecutor : public ModuleNode {
       // Check if the output is successfully read.
       ICHECK(!output.Empty()) << "Invalid output binding result.";
       pipeline_config_.Insert(mod_idx, output);
+      pipeline_config_.InsertInput(mod_idx, input);
     }
     return pipeline_config_;
   }
@@ -18,10 +18,108 @@
  */
 #include "pipeline_scheduler.h"
 
+#include <tvm/runtime/threading_backend.h>
+
+#include <algorithm>
 #include <utility>
 #include <vector>
 namespace tvm {
 namespace runtime {
+/*! \brief How many times a idle worker yields before it sleeps, following the thread pool. */
+constexpr uint32_t kPipelineSpinCount = 300000;
+
+bool PipelineQueue::Enqueue(std::shared_ptr<PipelineRequest>* request) {
+  uint32_t pos = tail_.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &cells_[pos & (kRingSize - 1)];
+    uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+    int32_t diff = static_cast<int32_t>(sequence - pos);
+    if (diff == 0) {
+      // the cell is free, claim it
+      if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      // the queue is full
+      return false;
+    } else {
+      pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->request = std::move(*request);
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool PipelineQueue::Dequeue(std::shared_ptr<PipelineRequest>* request) {
+  uint32_t pos = head_.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &cells_[pos & (kRingSize - 1)];
+    uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+    int32_t diff = static_cast<int32_t>(sequence - (pos + 1));
+    if (diff == 0) {
+      if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+    } else if (diff < 0) {
+      // empty, or the producer of this cell has not published it yet
+      return false;
+    } else {
+      pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+  *request = std::move(cell->request);
+  cell->sequence.store(pos + kRingSize, std::memory_order_release);
+  return true;
+}
+
+bool PipelineQueue::Push(std::shared_ptr<PipelineRequest> request) {
+  while (!Enqueue(&request)) {
+    if (exit_now_.load(std::memory_order_relaxed)) return false;
+    threading::Yield();
+  }
+  if (pending_.fetch_add(1) == -1) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.notify_one();
+  }
+  return true;
+}
+
+bool PipelineQueue::Pop(std::shared_ptr<PipelineRequest>* output, uint32_t spin_count) {
+  for (uint32_t i = 0; i < spin_count && pending_.load() == 0; ++i) {
+    if (exit_now_.load(std::memory_order_relaxed)) return false;
+    threading::Yield();
+  }
+  if (pending_.fetch_sub(1) == 0) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return pending_.load() >= 0 || exit_now_.load(); });
+  }
+  if (exit_now_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  // pending_ is raised after the cell is published, but another producer may
+  // still be writing the cell in front of it
+  while (!Dequeue(output)) {
+    threading::Yield();
+  }
+  return true;
+}
+
+void PipelineQueue::SignalForKill() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  exit_now_.store(true);
+  cv_.notify_all();
+}
+
+PipelineScheduler::~PipelineScheduler() {
+  for (auto& stage : stages_) {
+    stage->queue.SignalForKill();
+  }
+  for (auto& stage : stages_) {
+    if (stage->thread.joinable()) {
+      stage->thread.join();
+    }
+  }
+}
+
 /*!
  * \brief Initialize the pipeline.
  * \param modules The list of graph executor modules.
@@ -30,8 +128,196 @@ namespace runtime {
 size_t PipelineScheduler::PipelineInit(const std::vector<Module>& modules,
                                        const PipelineConfig& pipeline_config) {
   graph_modules_ = modules;
-  int num_output = pipeline_config.GetGlobalOutputNum();
-  return num_output;
+  num_outputs_ = pipeline_config.GetGlobalOutputNum();
+  for (size_t i = 0; i < modules.size(); i++) {
+    auto stage = std::make_unique<PipelineStage>();
+    stage->mod_idx = i;
+    stage->module = modules[i];
+    stage->set_input = modules[i].GetFunction("set_input");
+    stage->run = modules[i].GetFunction("run");
+    stage->get_output = modules[i].GetFunction("get_output");
+    ICHECK(stage->set_input != nullptr && stage->run != nullptr && stage->get_output != nullptr)
+        << "Module " << i << " of the pipeline is not a graph executor.";
+    stages_.push_back(std::move(stage));
+  }
+  // Give every bound module input a slot, an input can only have one source.
+  auto new_slot = [this](int mod_idx, const std::string& name) {
+    ICHECK(mod_idx >= 0 && mod_idx < static_cast<int>(stages_.size()))
+        << "Invalid mod_idx value " << mod_idx;
+    auto& names = stages_[mod_idx]->input_names;
+    ICHECK(std::find(names.begin(), names.end(), name) == names.end())
+        << "The input " << name << " of module " << mod_idx << " is bound more than once.";
+    names.push_back(name);
+    return static_cast<int>(names.size()) - 1;
+  };
+  for (const auto& mod_inputs : pipeline_config.input_config) {
+    for (const auto& binding : mod_inputs.second.input_binding_map) {
+      int slot = new_slot(mod_inputs.first, binding.first);
+      stages_[mod_inputs.first]->global_inputs.emplace_back(binding.second, slot);
+    }
+  }
+  for (const auto& mod_outputs : pipeline_config.config) {
+    ICHECK_LT(mod_outputs.first, static_cast<int>(stages_.size()))
+        << "Invalid mod_idx value " << mod_outputs.first;
+    PipelineStage* stage = stages_[mod_outputs.first].get();
+    for (const auto& output : mod_outputs.second.output_binding_map) {
+      std::vector<std::pair<int, int>> destinations;
+      if (output.second.IsGlobalOutput()) {
+        ICHECK_LT(output.second.global_output_index, static_cast<int>(num_outputs_))
+            << "The pipeline output indexes must be contiguous.";
+        destinations.emplace_back(-1, output.second.global_output_index);
+      }
+      for (const auto& binding : output.second.bindings) {
+        destinations.emplace_back(binding.first, new_slot(binding.first, binding.second));
+      }
+      stage->output_bindings.emplace_back(output.first, destinations);
+    }
+  }
+  start_time_ = std::chrono::steady_clock::now();
+  for (auto& stage : stages_) {
+    stage->thread = std::thread(&PipelineScheduler::StageLoop, this, stage.get());
+  }
+  return num_outputs_;
+}
+
+void PipelineScheduler::StageLoop(PipelineStage* stage) {
+  using std::chrono::duration_cast;
+  using std::chrono::microseconds;
+  const int mod_idx = stage->mod_idx;
+  std::shared_ptr<PipelineRequest> request;
+  auto idle_begin = std::chrono::steady_clock::now();
+  while (stage->queue.Pop(&request, kPipelineSpinCount)) {
+    auto begin = std::chrono::steady_clock::now();
+    stage->wait_us += duration_cast<microseconds>(begin - idle_begin).count();
+
+    std::vector<NDArray> outputs(stage->output_bindings.size());
+    if (!request->failed.load()) {
+      try {
+        for (size_t i = 0; i < stage->input_names.size(); i++) {
+          stage->set_input(stage->input_names[i], request->inputs[mod_idx][i]);
+        }
+        stage->run();
+        for (size_t i = 0; i < outputs.size(); i++) {
+          // the executor reuses its output buffers for the next request
+          NDArray output = stage->get_output(stage->output_bindings[i].first);
+          outputs[i] = output.CopyTo(output->device);
+        }
+      } catch (const std::exception& e) {
+        std::lock_guard<std::mutex> lock(request->error_mutex);
+        if (!request->failed.load()) {
+          request->error = "module " + std::to_string(mod_idx) + ": " + e.what();
+          request->failed.store(true);
+        }
+      }
+    }
+    // the inputs of this module are consumed, release them early
+    std::fill(request->inputs[mod_idx].begin(), request->inputs[mod_idx].end(), NDArray());
+
+    for (size_t i = 0; i < outputs.size(); i++) {
+      for (const auto& destination : stage->output_bindings[i].second) {
+        if (destination.first < 0) {
+          request->outputs[destination.second] = outputs[i];
+          OutputReady(request);
+        } else {
+          request->inputs[destination.first][destination.second] = outputs[i];
+          InputReady(request, destination.first);
+        }
+      }
+    }
+    request.reset();
+
+    idle_begin = std::chrono::steady_clock::now();
+    stage->busy_us += duration_cast<microseconds>(idle_begin - begin).count();
+    stage->count++;
+  }
+}
+
+void PipelineScheduler::InputReady(const std::shared_ptr<PipelineRequest>& request, int mod_idx) {
+  if (request->pending_inputs[mod_idx].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    stages_[mod_idx]->queue.Push(request);
+  }
+}
+
+void PipelineScheduler::OutputReady(const std::shared_ptr<PipelineRequest>& request) {
+  if (request->pending_outputs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::lock_guard<std::mutex> lock(finished_mutex_);
+    finished_.push_back(request);
+    finished_cv_.notify_all();
+  }
+}
+
+int64_t PipelineScheduler::Run(const Map<String, NDArray>& inputs) {
+  ICHECK(!stages_.empty()) << "The pipeline is not initialized.";
+  ICHECK(num_outputs_ > 0) << "The pipeline has no output.";
+  auto request = std::make_shared<PipelineRequest>();
+  request->id = next_id_++;
+  request->inputs.resize(stages_.size());
+  request->pending_inputs.reset(new std::atomic<int>[stages_.size()]);
+  request->outputs.resize(num_outputs_);
+  request->pending_outputs.store(num_outputs_);
+  for (size_t i = 0; i < stages_.size(); i++) {
+    request->inputs[i].resize(stages_[i]->input_names.size());
+    request->pending_inputs[i].store(stages_[i]->input_names.size());
+    for (const auto& global_input : stages_[i]->global_inputs) {
+      auto it = inputs.find(global_input.first);
+      ICHECK(it != inputs.end()) << "The pipeline input " << global_input.first << " is not set.";
+      // the caller may reuse its arrays for the next request
+      NDArray data = (*it).second;
+      request->inputs[i][global_input.second] = data.CopyTo(data->device);
+    }
+  }
+  // Only count the inputs down once all of them are in place.
+  for (size_t i = 0; i < stages_.size(); i++) {
+    if (stages_[i]->input_names.empty()) {
+      stages_[i]->queue.Push(request);
+    }
+    for (size_t j = 0; j < stages_[i]->global_inputs.size(); j++) {
+      InputReady(request, i);
+    }
+  }
+  return request->id;
+}
+
+Array<NDArray> PipelineScheduler::GetOutput() {
+  std::shared_ptr<PipelineRequest> request;
+  {
+    std::unique_lock<std::mutex> lock(finished_mutex_);
+    ICHECK(!finished_.empty() || NumPending() > 0) << "No request is running in the pipeline.";
+    finished_cv_.wait(lock, [this] { return !finished_.empty(); });
+    request = finished_.front();
+    finished_.pop_front();
+  }
+  num_fetched_++;
+  if (request->failed.load()) {
+    LOG(FATAL) << "Pipeline request " << request->id << " failed in " << request->error;
+  }
+  return Array<NDArray>(request->outputs.begin(), request->outputs.end());
+}
+
+profiling::Report PipelineScheduler::GetStatistics() const {
+  double elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                               start_time_)
+                          .count();
+  Array<Map<String, ObjectRef>> calls;
+  for (const auto& stage : stages_) {
+    Map<String, ObjectRef> row;
+    double busy_us = stage->busy_us.load();
+    row.Set("Name", String("mod" + std::to_string(stage->mod_idx)));
+    row.Set("Duration (us)", ObjectRef(make_object<profiling::DurationNode>(busy_us)));
+    row.Set("Percent", ObjectRef(make_object<profiling::PercentNode>(busy_us / elapsed_us * 100)));
+    row.Set("Count", ObjectRef(make_object<profiling::CountNode>(stage->count.load())));
+    row.Set("Wait (us)",
+            ObjectRef(make_object<profiling::DurationNode>(static_cast<double>(stage->wait_us))));
+    row.Set("Device", String("pipeline"));
+    calls.push_back(row);
+  }
+  Map<String, ObjectRef> total;
+  total.Set("Name", String("Total"));
+  total.Set("Duration (us)", ObjectRef(make_object<profiling::DurationNode>(elapsed_us)));
+  total.Set("Requests", ObjectRef(make_object<profiling::CountNode>(next_id_.load())));
+  Map<String, Map<String, ObjectRef>> device_metrics;
+  device_metrics.Set("pipeline", total);
+  return profiling::Report(calls, device_metrics);
 }
 }  // namespace runtime
 }  // namespace tvm
@@ -18,34 +18,178 @@
  */
 #ifndef TVM_RUNTIME_PIPELINE_PIPELINE_SCHEDULER_H_
 #define TVM_RUNTIME_PIPELINE_PIPELINE_SCHEDULER_H_
+#include <tvm/runtime/container/map.h>
+#include <tvm/runtime/container/string.h>
 #include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "pipeline_struct.h"
 namespace tvm {
 namespace runtime {
+/*!
+ * \brief One inference travelling through the pipeline.
+ */
+struct PipelineRequest {
+  /*!\brief The sequence number of the request.*/
+  int64_t id = 0;
+  /*!\brief The input data of every module, indexed by the input slot of the module.*/
+  std::vector<std::vector<NDArray>> inputs;
+  /*!\brief How many inputs each module still waits for.*/
+  std::unique_ptr<std::atomic<int>[]> pending_inputs;
+  /*!\brief The pipeline outputs.*/
+  std::vector<NDArray> outputs;
+  /*!\brief How many pipeline outputs are not produced yet.*/
+  std::atomic<int> pending_outputs{0};
+  /*!\brief Set by the first module that fails, the later modules skip the request.*/
+  std::atomic<bool> failed{false};
+  std::string error;
+  std::mutex error_mutex;
+};
+
+/*!
+ * \brief Bounded lock-free queue between the modules of the pipeline.
+ *  Any number of producers can push, a single consumer pops. The consumer
+ *  spins for a while before it sleeps, and producers only take the lock to
+ *  wake a sleeping consumer up.
+ */
+class PipelineQueue {
+ public:
+  PipelineQueue() : cells_(new Cell[kRingSize]) {
+    for (uint32_t i = 0; i < kRingSize; i++) {
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+  /*!
+   * \brief Push a request, yield while the queue is full.
+   * \return Whether the request is queued, false once the queue is killed.
+   */
+  bool Push(std::shared_ptr<PipelineRequest> request);
+  /*!
+   * \brief Pop a request and condition wait if the queue is empty.
+   * \param output The popped request.
+   * \param spin_count The number of iterations to spin before sleep.
+   * \return Whether pop is successful (true) or we need to exit now (false).
+   */
+  bool Pop(std::shared_ptr<PipelineRequest>* output, uint32_t spin_count);
+  /*!\brief Signal to terminate the consumer.*/
+  void SignalForKill();
+
+ private:
+  bool Enqueue(std::shared_ptr<PipelineRequest>* request);
+  bool Dequeue(std::shared_ptr<PipelineRequest>* request);
+
+  struct Cell {
+    std::atomic<uint32_t> sequence;
+    std::shared_ptr<PipelineRequest> request;
+  };
+  /*!\brief The capacity of the queue, must be a power of two.*/
+  static constexpr const uint32_t kRingSize = 8;
+  std::unique_ptr<Cell[]> cells_;
+  // the positions are on their own cache lines to avoid false sharing
+  alignas(64) std::atomic<uint32_t> tail_{0};
+  alignas(64) std::atomic<uint32_t> head_{0};
+  /*!\brief Queued requests, -1 when the consumer is asleep.*/
+  alignas(64) std::atomic<int32_t> pending_{0};
+  alignas(64) std::atomic<bool> exit_now_{false};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+/*!
+ * \brief The execution state of one graph executor module of the pipeline.
+ */
+struct PipelineStage {
+  int mod_idx = 0;
+  Module module;
+  PackedFunc set_input;
+  PackedFunc run;
+  PackedFunc get_output;
+  /*!\brief The input names, the index is the input slot.*/
+  std::vector<std::string> input_names;
+  /*!\brief The pipeline inputs feeding this module, the pair is (global name, slot).*/
+  std::vector<std::pair<std::string, int>> global_inputs;
+  /*!\brief The destinations of each output index, a destination is (module index, slot) or
+   *  (-1, pipeline output index).
+   */
+  std::vector<std::pair<int, std::vector<std::pair<int, int>>>> output_bindings;
+  PipelineQueue queue;
+  std::thread thread;
+  /*!\brief Occupancy statistics, in microseconds.*/
+  std::atomic<int64_t> busy_us{0};
+  std::atomic<int64_t> wait_us{0};
+  std::atomic<int64_t> count{0};
+};
+
 /*!
  * \brief The class that executes the pipeline logic,it is used to initialize the thread pool,
     execute and schedule pipeline tasks, allocate and manage memory, etc.
+
+    Every module runs on its own worker thread and consumes requests from its
+    queue in order, so module i can work on request n while module i + 1 works on
+    request n - 1. A module is queued a request once all of its inputs arrived,
+    from the pipeline inputs or from the modules it depends on.
  */
 class PipelineScheduler {
  public:
+  ~PipelineScheduler();
   /*!
    * \brief Initialize the pipeline.
    * \param modules The list of graph executor module.
    * \param pipeline_config The dependency information of each graph executor module.
    */
   size_t PipelineInit(const std::vector<Module>& modules, const PipelineConfig& pipeline_config);
+  /*!
+   * \brief Feed one request to the pipeline, blocks while the first modules are saturated.
+   * \param inputs The pipeline inputs, keyed by the pipeline input name.
+   * \return The sequence number of the request.
+   */
+  int64_t Run(const Map<String, NDArray>& inputs);
+  /*!
+   * \brief Get the outputs of the oldest finished request, waits for it if needed.
+   * \return The pipeline outputs.
+   */
+  Array<NDArray> GetOutput();
+  /*!\return The number of requests fed but not fetched yet.*/
+  int64_t NumPending() const { return next_id_ - num_fetched_; }
+  /*!\return The occupancy statistics of every module since initialization.*/
+  profiling::Report GetStatistics() const;
 
  private:
+  /*!\brief The worker loop of a module.*/
+  void StageLoop(PipelineStage* stage);
+  /*!\brief One input of a module arrived, queue the request when it has all of them.*/
+  void InputReady(const std::shared_ptr<PipelineRequest>& request, int mod_idx);
+  /*!\brief One pipeline output arrived, finish the request when it has all of them.*/
+  void OutputReady(const std::shared_ptr<PipelineRequest>& request);
   /*!\brief The list of graph executors.*/
   std::vector<Module> graph_modules_;
+  /*!\brief The modules, indexed by module index.*/
+  std::vector<std::unique_ptr<PipelineStage>> stages_;
+  size_t num_outputs_ = 0;
+  /*!\brief Run and GetOutput may be called from different threads.*/
+  std::atomic<int64_t> next_id_{0};
+  std::atomic<int64_t> num_fetched_{0};
+  std::chrono::steady_clock::time_point start_time_;
+  /*!\brief Finished requests, unbounded so that workers never wait for the caller.*/
+  std::deque<std::shared_ptr<PipelineRequest>> finished_;
+  std::mutex finished_mutex_;
+  std::condition_variable finished_cv_;
 };
 }  // namespace runtime
 }  // namespace tvm
@@ -134,6 +134,39 @@ struct OutputMap {
     }
   }
 };
+/*!
+ * \brief The pipeline inputs bound to the input interfaces of a module.
+ */
+struct InputMap {
+  /*!\brief Input binding map, the key is the module input name and the value is the name of
+   *  the pipeline input feeding it.
+   */
+  std::unordered_map<std::string, std::string> input_binding_map;
+  /*!
+   * \brief Create a input binding map from JSONReader.
+   * \param reader Json reader.
+   */
+  void Load(dmlc::JSONReader* reader) {
+    reader->BeginArray();
+    while (reader->NextArrayItem()) {
+      std::string key;
+      reader->BeginObject();
+      std::string global_input_name;
+      std::string input_name;
+      while (reader->NextObjectItem(&key)) {
+        if (key == "global_input_name") {
+          reader->Read(&global_input_name);
+        } else if (key == "input_name") {
+          reader->Read(&input_name);
+        } else {
+          LOG(FATAL) << "do not support key " << key;
+        }
+      }
+      ICHECK(!global_input_name.empty() && !input_name.empty());
+      input_binding_map[input_name] = global_input_name;
+    }
+  }
+};
 /*!
  * \brief The binding or dependency information of each module output interface.
  */
@@ -142,6 +175,8 @@ struct PipelineConfig {
    * information.
    */
   std::unordered_map<int, OutputMap> config;
+  /*!\brief The key is the module index, the pipeline inputs each module reads.*/
+  std::unordered_map<int, InputMap> input_config;
   OutputMap& operator[](int key) {
     ICHECK(config.find(key) != config.end());
     return config[key];
@@ -149,6 +184,8 @@ struct PipelineConfig {
 
   void Insert(int key, const OutputMap& map) { config[key] = map; }
 
+  void InsertInput(int key, const InputMap& map) { input_config[key] = map; }
+
   /*!\brief This function is used to verify whether config is loaded successfully.
    * \return Return true to indicate that this class has not been successfully loaded.
    */
@@ -33,6 +33,7 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -46,6 +47,84 @@
 namespace tvm {
 namespace runtime {
 
+/*! \brief Largest block a client copy is split into when the remote sets no packet limit. */
+constexpr uint64_t kRPCCopyBlockBytes = 4 << 20;
+/*! \brief Number of copy blocks a client keeps in flight by default. */
+constexpr int kRPCMaxOutstandingCopies = 4;
+/*! \brief Shorter zero runs are kept as literals by the copy compression. */
+constexpr uint64_t kRPCMinZeroRun = 8;
+
+static void PutVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+static uint64_t GetVarint(const char** ptr, const char* end) {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    ICHECK(*ptr < end) << "Corrupted compressed copy";
+    uint8_t byte = static_cast<uint8_t>(*(*ptr)++);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return value;
+  }
+  LOG(FATAL) << "Corrupted compressed copy";
+  return 0;
+}
+
+/*!
+ * \brief Zero run-length encode the payload of a compressed copy.
+ *
+ *  The payload is a sequence of (literal length, literal bytes, zero run length)
+ *  with the lengths stored as varints. Activations and padded buffers are mostly
+ *  zeros, and encoding is cheap enough to not slow a fast link down.
+ *
+ * \param data The raw bytes.
+ * \param size The number of raw bytes.
+ * \param out The encoded bytes.
+ * \return Whether the encoded bytes are smaller than the raw ones.
+ */
+static bool CompressZeroRuns(const char* data, uint64_t size, std::string* out) {
+  out->clear();
+  uint64_t begin = 0;
+  while (begin < size) {
+    uint64_t run_begin = begin, run_end = begin;
+    while (run_begin < size) {
+      run_begin = std::find(data + run_begin, data + size, 0) - data;
+      run_end = run_begin;
+      while (run_end < size && data[run_end] == 0) ++run_end;
+      if (run_end - run_begin >= kRPCMinZeroRun || run_end == size) break;
+      run_begin = run_end;
+    }
+    PutVarint(run_begin - begin, out);
+    out->append(data + begin, run_begin - begin);
+    PutVarint(run_end - run_begin, out);
+    if (out->size() >= size) return false;
+    begin = run_end;
+  }
+  return out->size() < size;
+}
+
+static void DecompressZeroRuns(const char* data, uint64_t size, char* out, uint64_t out_size) {
+  const char* end = data + size;
+  uint64_t pos = 0;
+  while (data < end) {
+    uint64_t literal = GetVarint(&data, end);
+    ICHECK(literal <= static_cast<uint64_t>(end - data) && pos + literal <= out_size)
+        << "Corrupted compressed copy";
+    memcpy(out + pos, data, literal);
+    data += literal;
+    pos += literal;
+    uint64_t zeros = GetVarint(&data, end);
+    ICHECK_LE(pos + zeros, out_size) << "Corrupted compressed copy";
+    memset(out + pos, 0, zeros);
+    pos += zeros;
+  }
+  ICHECK_EQ(pos, out_size) << "Corrupted compressed copy";
+}
+
 /*!
  * Event-driven state-machine based handlers for RPCEndpoint.
  *
@@ -384,20 +463,28 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
 
   void HandleSyscall(RPCCode code);
 
-  void HandleCopyFromRemote() {
+  void HandleCopyFromRemote(bool compressed = false) {
     DLTensor* arr = RPCReference::ReceiveDLTensor(this);
     uint64_t data_bytes;
     this->Read(&data_bytes);
     size_t elem_bytes = (arr->dtype.bits * arr->dtype.lanes + 7) / 8;
     auto* sess = GetServingSession();
-    // Return Copy Ack with the given data
-    auto fcopyack = [this](char* dptr, size_t num_bytes) {
+    // Return Copy Ack with the given data, a compressed ack carries the stored size first.
+    auto fcopyack = [this, compressed](char* dptr, size_t num_bytes) {
       RPCCode code = RPCCode::kCopyAck;
-      uint64_t packet_nbytes = sizeof(code) + num_bytes;
+      uint64_t stored_bytes = num_bytes;
+      const char* payload = dptr;
+      if (compressed && CompressZeroRuns(dptr, num_bytes, &copy_buffer_)) {
+        stored_bytes = copy_buffer_.size();
+        payload = copy_buffer_.data();
+      }
+      uint64_t packet_nbytes = sizeof(code) + stored_bytes;
+      if (compressed) packet_nbytes += sizeof(stored_bytes);
 
       this->Write(packet_nbytes);
       this->Write(code);
-      this->WriteArray(dptr, num_bytes);
+      if (compressed) this->Write(stored_bytes);
+      this->WriteArray(payload, stored_bytes);
       this->SwitchToState(kRecvPacketNumBytes);
     };
 
@@ -427,10 +514,12 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
     }
   }
 
-  void HandleCopyToRemote() {
+  void HandleCopyToRemote(bool compressed = false) {
     DLTensor* arr = RPCReference::ReceiveDLTensor(this);
     uint64_t data_bytes;
     this->Read(&data_bytes);
+    uint64_t stored_bytes = data_bytes;
+    if (compressed) this->Read(&stored_bytes);
     size_t elem_bytes = (arr->dtype.bits * arr->dtype.lanes + 7) / 8;
     auto* sess = GetServingSession();
 
@@ -438,7 +527,7 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
     // as the cpu pointer without allocating a temp space.
     if (arr->device.device_type == kDLCPU && sess->IsLocalSession()) {
       char* dptr = reinterpret_cast<char*>(arr->data) + arr->byte_offset;
-      this->ReadArray(dptr, data_bytes);
+      this->ReadCopyPayload(dptr, data_bytes, stored_bytes);
 
       if (!DMLC_IO_NO_ENDIAN_SWAP) {
         dmlc::ByteSwap(dptr, elem_bytes, data_bytes / elem_bytes);
@@ -447,7 +536,7 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
       this->SwitchToState(kRecvPacketNumBytes);
     } else {
       char* temp_data = this->ArenaAlloc<char>(data_bytes);
-      this->ReadArray(temp_data, data_bytes);
+      this->ReadCopyPayload(temp_data, data_bytes, stored_bytes);
 
       if (!DMLC_IO_NO_ENDIAN_SWAP) {
         dmlc::ByteSwap(temp_data, elem_bytes, data_bytes / elem_bytes);
@@ -468,6 +557,18 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
     }
   }
 
+  // Read the payload of a copy, it is zero run-length encoded when stored in fewer bytes.
+  void ReadCopyPayload(char* dptr, uint64_t data_bytes, uint64_t stored_bytes) {
+    if (stored_bytes == data_bytes) {
+      this->ReadArray(dptr, data_bytes);
+      return;
+    }
+    ICHECK_LT(stored_bytes, data_bytes) << "Corrupted compressed copy";
+    char* stored_data = this->ArenaAlloc<char>(stored_bytes);
+    this->ReadArray(stored_data, stored_bytes);
+    DecompressZeroRuns(stored_data, stored_bytes, dptr, data_bytes);
+  }
+
   // Handle for packed call.
   void HandleNormalCallFunc() {
     uint64_t call_handle;
@@ -619,6 +720,8 @@ class RPCEndpoint::EventHandler : public dmlc::Stream {
   std::string* remote_key_;
   // function to flush the writer.
   std::function<void()> flush_writer_;
+  // Scratch space of the compressed copy acks.
+  std::string copy_buffer_;
 };
 
 RPCCode RPCEndpoint::HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn) {
@@ -744,6 +847,10 @@ int RPCEndpoint::ServerAsyncIOEventHandler(const std::string& in_bytes, int even
   RPCCode code = RPCCode::kNone;
   if (in_bytes.length() != 0) {
     reader_.Write(in_bytes.c_str(), in_bytes.length());
+  }
+  // Clients pipeline copies, so requests may already be buffered while an
+  // async callback was pending.
+  if (reader_.bytes_available() != 0) {
     code = handler_->HandleNextEvent(false, true, [](TVMArgs) {});
   }
   if ((event_flag & 2) != 0 && writer_.bytes_available() != 0) {
@@ -801,29 +908,41 @@ void RPCEndpoint::CallFunc(RPCSession::PackedFuncHandle h, const TVMValue* arg_v
   ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
 }
 
-void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  RPCCode code = RPCCode::kCopyToRemote;
+void RPCEndpoint::SendCopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes,
+                                   bool compress) {
+  RPCCode code = compress ? RPCCode::kCopyToRemoteCompressed : RPCCode::kCopyToRemote;
 
   uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*to));
   ICHECK_LE(to->byte_offset + nbytes, tensor_total_size_bytes)
       << "CopyToRemote: overflow in tensor size: (byte_offset=" << to->byte_offset
       << ", nbytes=" << nbytes << ", tensor_total_size=" << tensor_total_size_bytes << ")";
 
+  const char* payload = static_cast<const char*>(from_bytes);
+  uint64_t stored_bytes = nbytes;
+  if (compress && CompressZeroRuns(payload, nbytes, &copy_buffer_)) {
+    stored_bytes = copy_buffer_.size();
+    payload = copy_buffer_.data();
+  }
+
   uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(to, code, nbytes);
-  uint64_t packet_nbytes = overhead + nbytes;
+  uint64_t packet_nbytes = overhead + stored_bytes;
+  if (compress) packet_nbytes += sizeof(stored_bytes);
 
   handler_->Write(packet_nbytes);
   handler_->Write(code);
   RPCReference::SendDLTensor(handler_, to);
   handler_->Write(nbytes);
-  handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
-  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
+  if (compress) handler_->Write(stored_bytes);
+  handler_->WriteArray(payload, stored_bytes);
 }
 
-void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  RPCCode code = RPCCode::kCopyFromRemote;
+void RPCEndpoint::RecvCopyToRemote() {
+  RPCCode code = HandleUntilReturnEvent(true, [](TVMArgs) {});
+  ICHECK(code == RPCCode::kReturn) << "code=" << RPCCodeToString(code);
+}
+
+void RPCEndpoint::SendCopyFromRemote(DLTensor* from, uint64_t nbytes, bool compress) {
+  RPCCode code = compress ? RPCCode::kCopyFromRemoteCompressed : RPCCode::kCopyFromRemote;
 
   uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*from));
   ICHECK_LE(from->byte_offset + nbytes, tensor_total_size_bytes)
@@ -837,12 +956,122 @@ void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes
   handler_->Write(code);
   RPCReference::SendDLTensor(handler_, from);
   handler_->Write(nbytes);
-  ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kCopyAck);
+}
 
-  handler_->ReadArray(reinterpret_cast<char*>(to_bytes), nbytes);
+void RPCEndpoint::RecvCopyFromRemote(void* to_bytes, uint64_t nbytes, bool compress) {
+  RPCCode code = HandleUntilReturnEvent(true, [](TVMArgs) {});
+  ICHECK(code == RPCCode::kCopyAck) << "code=" << RPCCodeToString(code);
+
+  uint64_t stored_bytes = nbytes;
+  if (compress) handler_->Read(&stored_bytes);
+  if (stored_bytes == nbytes) {
+    handler_->ReadArray(reinterpret_cast<char*>(to_bytes), nbytes);
+  } else {
+    ICHECK_LT(stored_bytes, nbytes) << "Corrupted compressed copy";
+    copy_buffer_.resize(stored_bytes);
+    handler_->ReadArray(&copy_buffer_[0], stored_bytes);
+    DecompressZeroRuns(copy_buffer_.data(), stored_bytes, reinterpret_cast<char*>(to_bytes),
+                       nbytes);
+  }
   handler_->FinishCopyAck();
 }
 
+void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  this->SendCopyToRemote(from_bytes, to, nbytes, false);
+  this->RecvCopyToRemote();
+}
+
+void RPCEndpoint::CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  this->SendCopyFromRemote(from, nbytes, false);
+  this->RecvCopyFromRemote(to_bytes, nbytes, false);
+}
+
+void RPCEndpoint::CopyToRemoteBlocks(void* from_bytes, DLTensor* to, uint64_t nbytes,
+                                     uint64_t block_size, int max_outstanding, bool compress) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ICHECK_GT(block_size, 0U);
+  ICHECK_GT(max_outstanding, 0);
+  uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*to));
+  ICHECK_LE(to->byte_offset + nbytes, tensor_total_size_bytes)
+      << "CopyToRemote: overflow in tensor size: (byte_offset=" << to->byte_offset
+      << ", nbytes=" << nbytes << ", tensor_total_size=" << tensor_total_size_bytes << ")";
+
+  const uint64_t num_blocks = (nbytes + block_size - 1) / block_size;
+  uint64_t num_sent = 0, num_done = 0;
+  DLTensor block = *to;
+  try {
+    for (; num_sent < num_blocks; ++num_sent) {
+      if (num_sent - num_done == static_cast<uint64_t>(max_outstanding)) {
+        ++num_done;
+        this->RecvCopyToRemote();
+      }
+      uint64_t offset = num_sent * block_size;
+      block.byte_offset = to->byte_offset + offset;
+      this->SendCopyToRemote(static_cast<char*>(from_bytes) + offset, &block,
+                             std::min(block_size, nbytes - offset), compress);
+    }
+    while (num_done < num_blocks) {
+      ++num_done;
+      this->RecvCopyToRemote();
+    }
+  } catch (const std::exception&) {
+    // Consume the replies of the blocks still in flight so the channel stays in sync.
+    while (num_done < num_sent) {
+      ++num_done;
+      try {
+        this->RecvCopyToRemote();
+      } catch (const std::exception&) {
+      }
+    }
+    throw;
+  }
+}
+
+void RPCEndpoint::CopyFromRemoteBlocks(DLTensor* from, void* to_bytes, uint64_t nbytes,
+                                       uint64_t block_size, int max_outstanding, bool compress) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ICHECK_GT(block_size, 0U);
+  ICHECK_GT(max_outstanding, 0);
+  uint64_t tensor_total_size_bytes = static_cast<uint64_t>(GetDataSize(*from));
+  ICHECK_LE(from->byte_offset + nbytes, tensor_total_size_bytes)
+      << "CopyFromRemote: overflow in tensor size: (byte_offset=" << from->byte_offset
+      << ", nbytes=" << nbytes << ", tensor_total_size=" << tensor_total_size_bytes << ")";
+
+  const uint64_t num_blocks = (nbytes + block_size - 1) / block_size;
+  uint64_t num_sent = 0, num_done = 0;
+  auto recv_block = [&]() {
+    uint64_t offset = num_done * block_size;
+    ++num_done;
+    this->RecvCopyFromRemote(static_cast<char*>(to_bytes) + offset,
+                             std::min(block_size, nbytes - offset), compress);
+  };
+  DLTensor block = *from;
+  try {
+    for (; num_sent < num_blocks; ++num_sent) {
+      if (num_sent - num_done == static_cast<uint64_t>(max_outstanding)) {
+        recv_block();
+      }
+      uint64_t offset = num_sent * block_size;
+      block.byte_offset = from->byte_offset + offset;
+      this->SendCopyFromRemote(&block, std::min(block_size, nbytes - offset), compress);
+    }
+    while (num_done < num_blocks) {
+      recv_block();
+    }
+  } catch (const std::exception&) {
+    // Consume the replies of the blocks still in flight so the channel stays in sync.
+    while (num_done < num_sent) {
+      try {
+        recv_block();
+      } catch (const std::exception&) {
+      }
+    }
+    throw;
+  }
+}
+
 // SysCallEventHandler functions
 void RPCGetGlobalFunc(RPCSession* handler, TVMArgs args, TVMRetValue* rv) {
   std::string name = args[0];
@@ -980,6 +1209,12 @@ void RPCEndpoint::EventHandler::HandleSyscall(RPCCode code) {
     case RPCCode::kCopyAmongRemote:
       SysCallHandler(RPCCopyAmongRemote);
       break;
+    case RPCCode::kCopyToRemoteCompressed:
+      this->HandleCopyToRemote(true);
+      break;
+    case RPCCode::kCopyFromRemoteCompressed:
+      this->HandleCopyFromRemote(true);
+      break;
     default:
       LOG(FATAL) << "Unknown event " << static_cast<int>(code);
   }
@@ -1010,55 +1245,36 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
   }
 
   void CopyToRemote(void* local_from_bytes, DLTensor* remote_to, uint64_t nbytes) final {
-    RPCCode code = RPCCode::kCopyToRemote;
-    uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_to, code, nbytes);
-    uint64_t rpc_max_size = GetRPCMaxTransferSize();
-    ICHECK_GT(rpc_max_size, overhead) << "CopyToRemote: Invalid block size!";
-    const uint64_t block_size = rpc_max_size - overhead;
-    uint64_t block_count = 0;
-    const uint64_t num_blocks = nbytes / block_size;
-    void* from_bytes;
-
-    for (block_count = 0; block_count < num_blocks; block_count++) {
-      remote_to->byte_offset = block_count * block_size;
-      from_bytes = reinterpret_cast<void*>(
-          (reinterpret_cast<uint8_t*>(local_from_bytes) + block_count * block_size));
-      endpoint_->CopyToRemote(from_bytes, remote_to, block_size);
-    }
-
-    const uint64_t remainder_bytes = nbytes % block_size;
-    if (remainder_bytes != 0) {
-      remote_to->byte_offset = block_count * block_size;
-      from_bytes = reinterpret_cast<void*>(
-          (reinterpret_cast<uint8_t*>(local_from_bytes) + block_count * block_size));
-      endpoint_->CopyToRemote(from_bytes, remote_to, remainder_bytes);
-    }
+    uint64_t block_size = GetCopyBlockSize(remote_to, RPCCode::kCopyToRemote, nbytes);
+    endpoint_->CopyToRemoteBlocks(local_from_bytes, remote_to, nbytes, block_size,
+                                  GetMaxOutstandingCopies(), compress_copies_);
   }
 
   void CopyFromRemote(DLTensor* remote_from, void* local_to_bytes, uint64_t nbytes) final {
-    RPCCode code = RPCCode::kCopyFromRemote;
-    uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(remote_from, code, nbytes);
-    uint64_t rpc_max_size = GetRPCMaxTransferSize();
-    ICHECK_GT(rpc_max_size, overhead) << "CopyFromRemote: Invalid block size!";
-    const uint64_t block_size = rpc_max_size - overhead;
-    uint64_t block_count = 0;
-    const uint64_t num_blocks = nbytes / block_size;
-    void* to_bytes;
-
-    for (block_count = 0; block_count < num_blocks; block_count++) {
-      remote_from->byte_offset = block_count * block_size;
-      to_bytes = reinterpret_cast<void*>(
-          (reinterpret_cast<uint8_t*>(local_to_bytes) + block_count * block_size));
-      endpoint_->CopyFromRemote(remote_from, to_bytes, block_size);
-    }
+    uint64_t block_size = GetCopyBlockSize(remote_from, RPCCode::kCopyFromRemote, nbytes);
+    endpoint_->CopyFromRemoteBlocks(remote_from, local_to_bytes, nbytes, block_size,
+                                    GetMaxOutstandingCopies(), compress_copies_);
+  }
 
-    const uint64_t remainder_bytes = nbytes % block_size;
-    if (remainder_bytes != 0) {
-      remote_from->byte_offset = block_count * block_size;
-      to_bytes = reinterpret_cast<void*>(
-          (reinterpret_cast<uint8_t*>(local_to_bytes) + block_count * block_size));
-      endpoint_->CopyFromRemote(remote_from, to_bytes, remainder_bytes);
+  /*!
+   * \brief Configure how tensors are copied to and from the remote.
+   * \param max_outstanding The maximum number of copy blocks in flight.
+   * \param compress Whether to zero run-length encode the copies, ignored when
+   *  the remote cannot decode them.
+   */
+  void SetCopyOptions(int max_outstanding, bool compress) {
+    ICHECK_GT(max_outstanding, 0) << "max_outstanding must be positive";
+    if (compress) {
+      PackedFuncHandle marker = GetFunction("rpc.CompressedCopy");
+      if (marker == nullptr) {
+        LOG(WARNING) << "The remote does not support compressed copies, sending them raw";
+        compress = false;
+      } else {
+        FreeHandle(marker, kTVMPackedFuncHandle);
+      }
     }
+    max_outstanding_copies_ = max_outstanding;
+    compress_copies_ = compress;
   }
 
   void FreeHandle(void* handle, int type_code) final {
@@ -1148,14 +1364,43 @@ class RPCClientSession : public RPCSession, public DeviceAPI {
     return (uint64_t)rpc_chunk_max_size_bytes_;
   }
 
+  uint64_t GetCopyBlockSize(DLTensor* tensor, RPCCode code, uint64_t nbytes) {
+    uint64_t overhead = RemoteCopyCalculatePacketOverheadSize(tensor, code, nbytes);
+    uint64_t rpc_max_size = GetRPCMaxTransferSize();
+    ICHECK_GT(rpc_max_size, overhead) << RPCCodeToString(code) << ": Invalid block size!";
+    return std::min(rpc_max_size - overhead, kRPCCopyBlockBytes);
+  }
+
+  int GetMaxOutstandingCopies() {
+    if (max_outstanding_copies_ <= 0) {
+      // A remote with a packet size limit is a device that buffers a single packet.
+      max_outstanding_copies_ = GetRPCMaxTransferSize() == kRPCMaxTransferSizeBytesDefault
+                                    ? kRPCMaxOutstandingCopies
+                                    : 1;
+    }
+    return max_outstanding_copies_;
+  }
+
   std::shared_ptr<RPCEndpoint> endpoint_;
   int64_t rpc_chunk_max_size_bytes_ = -1;
+  int max_outstanding_copies_ = -1;
+  bool compress_copies_ = false;
 };
 
 std::shared_ptr<RPCSession> CreateClientSession(std::shared_ptr<RPCEndpoint> endpoint) {
   return std::make_shared<RPCClientSession>(endpoint);
 }
 
+TVM_REGISTER_GLOBAL("rpc.SessionSetCopyOptions")
+    .set_body_typed([](Module mod, int max_outstanding, bool compress) {
+      auto* sess = dynamic_cast<RPCClientSession*>(RPCModuleGetSession(mod).get());
+      ICHECK(sess != nullptr) << "Copy options only apply to the session of an RPC client";
+      sess->SetCopyOptions(max_outstanding, compress);
+    });
+
+// Looked up by clients to tell whether the remote decodes compressed copies.
+TVM_REGISTER_GLOBAL("rpc.CompressedCopy").set_body_typed([]() {});
+
 uint64_t RemoteCopyCalculatePacketOverheadSize(DLTensor* tensor, RPCCode code, uint64_t nbytes) {
   uint64_t shape_bytes = tensor->ndim * sizeof(int64_t);
   uint64_t to_data = reinterpret_cast<uint64_t>(static_cast<uint8_t*>(tensor->data));
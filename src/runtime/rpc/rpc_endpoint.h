@@ -147,6 +147,30 @@ class RPCEndpoint {
    * \param type_hint Hint of content data type.
    */
   void CopyFromRemote(DLTensor* from, void* to_bytes, uint64_t nbytes);
+  /*!
+   * \brief Copy bytes into remote array content, split into blocks that are
+   *  acknowledged asynchronously so that up to max_outstanding blocks are in flight.
+   * \param from_bytes The source host data.
+   * \param to The target array, the copy starts at its byte_offset.
+   * \param nbytes The size of the memory in bytes.
+   * \param block_size The maximum number of bytes in one block.
+   * \param max_outstanding The maximum number of unacknowledged blocks.
+   * \param compress Whether to zero run-length encode the blocks.
+   */
+  void CopyToRemoteBlocks(void* from_bytes, DLTensor* to, uint64_t nbytes, uint64_t block_size,
+                          int max_outstanding, bool compress);
+  /*!
+   * \brief Copy bytes from remote array content, split into blocks that are
+   *  requested ahead so that up to max_outstanding blocks are in flight.
+   * \param from The source array, the copy starts at its byte_offset.
+   * \param to_bytes The target host data.
+   * \param nbytes The size of the memory in bytes.
+   * \param block_size The maximum number of bytes in one block.
+   * \param max_outstanding The maximum number of unacknowledged blocks.
+   * \param compress Whether the remote zero run-length encodes the blocks.
+   */
+  void CopyFromRemoteBlocks(DLTensor* from, void* to_bytes, uint64_t nbytes, uint64_t block_size,
+                            int max_outstanding, bool compress);
 
   /*!
    * \brief Call a remote defined system function with arguments.
@@ -174,6 +198,12 @@ class RPCEndpoint {
   // Handle events until receives a return
   // Also flushes channels so that the function advances.
   RPCCode HandleUntilReturnEvent(bool client_mode, RPCSession::FEncodeReturn setreturn);
+  // Write one copy packet without waiting for the reply.
+  void SendCopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes, bool compress);
+  void SendCopyFromRemote(DLTensor* from, uint64_t nbytes, bool compress);
+  // Wait for the reply of the oldest copy packet.
+  void RecvCopyToRemote();
+  void RecvCopyFromRemote(void* to_bytes, uint64_t nbytes, bool compress);
   // Initalization
   void Init();
   // Shutdown
@@ -184,6 +214,8 @@ class RPCEndpoint {
   std::mutex mutex_;
   // Internal ring buffer.
   support::RingBuffer reader_, writer_;
+  // Scratch space of the compressed copy payloads.
+  std::string copy_buffer_;
   // Event handler.
   std::shared_ptr<EventHandler> handler_;
   // syscall remote with specified function code.
@@ -26,8 +26,15 @@
 #include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 
+#include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 #if defined(_M_X64) || defined(__x86_64__)
 #include <immintrin.h>
 #endif
@@ -49,6 +56,124 @@ static void RemoteNDArrayDeleter(Object* obj) {
   delete ptr;
 }
 
+/*!
+ * \brief A call running on the async call queue of an RPC session.
+ */
+class RPCFutureObj : public Object {
+ public:
+  /*! \brief The function to call. */
+  PackedFunc func;
+  /*! \brief The arguments, kept alive until the call is done. */
+  std::vector<TVMRetValue> args;
+  /*! \brief The return value, set once done. */
+  TVMRetValue result;
+  /*! \brief The error message, set once done if the call failed. */
+  std::string error;
+  bool done{false};
+  std::mutex mutex;
+  std::condition_variable cv;
+
+  void Run() {
+    std::vector<TVMValue> values(args.size());
+    std::vector<int> type_codes(args.size());
+    std::vector<TVMByteArray> bytes(args.size());
+    TVMArgsSetter setter(values.data(), type_codes.data());
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (args[i].type_code() == kTVMBytes) {
+        const std::string* data = args[i].ptr<std::string>();
+        bytes[i].data = data->data();
+        bytes[i].size = data->size();
+        setter(i, bytes[i]);
+      } else {
+        setter(i, args[i]);
+      }
+    }
+    TVMRetValue rv;
+    std::string err;
+    try {
+      func.CallPacked(TVMArgs(values.data(), type_codes.data(), args.size()), &rv);
+    } catch (const std::exception& e) {
+      err = e.what();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      result = std::move(rv);
+      error = std::move(err);
+      done = true;
+    }
+    cv.notify_all();
+  }
+
+  static constexpr const char* _type_key = "rpc.RPCFuture";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RPCFutureObj, Object);
+};
+
+class RPCFuture : public ObjectRef {
+ public:
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(RPCFuture, ObjectRef, RPCFutureObj);
+};
+
+TVM_REGISTER_OBJECT_TYPE(RPCFutureObj);
+
+/*!
+ * \brief Runs the async calls of a session in order on a worker thread.
+ *
+ *  An endpoint serves one call at a time, so one thread per session is enough to
+ *  keep it busy, and the caller is free to drive other sessions meanwhile.
+ */
+class RPCAsyncCallQueue {
+ public:
+  RPCAsyncCallQueue() : state_(std::make_shared<State>()) {
+    std::shared_ptr<State> state = state_;
+    thread_ = std::thread([state]() {
+      while (true) {
+        RPCFuture future;
+        {
+          std::unique_lock<std::mutex> lock(state->mutex);
+          state->cv.wait(lock, [&state]() { return state->exit || !state->queue.empty(); });
+          // drain the queued calls before exiting
+          if (state->queue.empty()) return;
+          future = std::move(state->queue.front());
+          state->queue.pop_front();
+        }
+        future->Run();
+      }
+    });
+  }
+
+  ~RPCAsyncCallQueue() {
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->exit = true;
+    }
+    state_->cv.notify_one();
+    // The last reference can be dropped by a call of the queue itself.
+    if (thread_.get_id() == std::this_thread::get_id()) {
+      thread_.detach();
+    } else {
+      thread_.join();
+    }
+  }
+
+  void Push(RPCFuture future) {
+    {
+      std::lock_guard<std::mutex> lock(state_->mutex);
+      state_->queue.push_back(std::move(future));
+    }
+    state_->cv.notify_one();
+  }
+
+ private:
+  struct State {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<RPCFuture> queue;
+    bool exit{false};
+  };
+  std::shared_ptr<State> state_;
+  std::thread thread_;
+};
+
 /*!
  * \brief Build a local NDArray with remote backing storage.
  * \param sess the RPCSession which owns the given handle.
@@ -219,6 +344,14 @@ class RPCModuleNode final : public ModuleNode {
 
   const std::shared_ptr<RPCSession>& sess() { return sess_; }
 
+  RPCAsyncCallQueue* GetAsyncCallQueue() {
+    std::lock_guard<std::mutex> lock(async_call_mutex_);
+    if (async_call_queue_ == nullptr) {
+      async_call_queue_ = std::make_unique<RPCAsyncCallQueue>();
+    }
+    return async_call_queue_.get();
+  }
+
   void* module_handle() const { return module_handle_; }
 
  private:
@@ -249,6 +382,9 @@ class RPCModuleNode final : public ModuleNode {
   TypedPackedFunc<Module(std::string)> remote_load_module_;
   // remote function getter for load module
   TypedPackedFunc<void(Module, Module)> remote_import_module_;
+  // The queue of async calls, created on the first one.
+  std::mutex async_call_mutex_;
+  std::unique_ptr<RPCAsyncCallQueue> async_call_queue_;
 };
 
 void* RPCWrappedFunc::UnwrapRemoteValueToHandle(const TVMArgValue& arg) const {
@@ -484,6 +620,36 @@ TVM_REGISTER_GLOBAL("rpc.SessTableIndex").set_body([](TVMArgs args, TVMRetValue*
   *rv = static_cast<RPCModuleNode*>(m.operator->())->sess()->table_index();
 });
 
+TVM_REGISTER_GLOBAL("rpc.AsyncCall").set_body([](TVMArgs args, TVMRetValue* rv) {
+  Module m = args[0];
+  std::string tkey = m->type_key();
+  ICHECK_EQ(tkey, "rpc");
+  auto n = make_object<RPCFutureObj>();
+  n->func = args[1];
+  n->args.resize(args.size() - 2);
+  for (int i = 2; i < args.size(); ++i) {
+    n->args[i - 2] = args[i];
+  }
+  RPCFuture future(n);
+  static_cast<RPCModuleNode*>(m.operator->())->GetAsyncCallQueue()->Push(future);
+  *rv = future;
+});
+
+TVM_REGISTER_GLOBAL("rpc.RPCFutureDone").set_body_typed([](RPCFuture future) {
+  std::lock_guard<std::mutex> lock(future->mutex);
+  return future->done;
+});
+
+TVM_REGISTER_GLOBAL("rpc.RPCFutureResult").set_body([](TVMArgs args, TVMRetValue* rv) {
+  RPCFuture future = args[0];
+  std::unique_lock<std::mutex> lock(future->mutex);
+  future->cv.wait(lock, [&future]() { return future->done; });
+  if (!future->error.empty()) {
+    LOG(FATAL) << future->error;
+  }
+  *rv = future->result;
+});
+
 TVM_REGISTER_GLOBAL("tvm.rpc.NDArrayFromRemoteOpaqueHandle")
     .set_body_typed([](Module mod, void* remote_array, DLTensor* template_tensor, Device dev,
                        void* ndarray_handle) -> NDArray {
@@ -26,6 +26,7 @@
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/threading_backend.h>
 #if TVM_THREADPOOL_USE_OPENMP
@@ -33,8 +34,10 @@
 #endif
 #include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstring>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -58,11 +61,28 @@ uint32_t GetSpinCount() {
   return atoi(val);
 }
 
+bool GetWorkStealing() {
+  const char* val = getenv("TVM_THREAD_POOL_WORK_STEALING");
+  return val && atoi(val) != 0;
+}
+
+constexpr int kDefaultStealChunks = 4;
+
+int GetStealChunks() {
+  const char* val = getenv("TVM_THREAD_POOL_STEAL_CHUNKS");
+  if (!val || atoi(val) <= 0) {
+    return kDefaultStealChunks;
+  }
+  return atoi(val);
+}
+
 }  // namespace
 
 // stride in the page, fit to cache line.
 constexpr int kSyncStride = 64 / sizeof(std::atomic<int>);
 
+class ThreadPool;
+
 /*!
  * \brief Thread local main environment.
  */
@@ -78,10 +98,12 @@ class ParallelLauncher {
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
       par_errors_.resize(num_task + 1);
-      if (need_sync) {
-        delete[] sync_counter_;
-        sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
-      }
+    }
+    // sized apart from the errors, a launch without sync may have grown those
+    if (need_sync && num_task > sync_size_) {
+      delete[] sync_counter_;
+      sync_counter_ = new std::atomic<int>[num_task * kSyncStride];
+      sync_size_ = num_task;
     }
     if (need_sync) {
       for (int i = 0; i < num_task; ++i) {
@@ -95,9 +117,15 @@ class ParallelLauncher {
   ~ParallelLauncher() { delete[] sync_counter_; }
   // Wait n jobs to finish
   int WaitForJobs() {
-    while (num_pending_.load() != 0) {
+    while (!Done()) {
       tvm::runtime::threading::Yield();
     }
+    return CollectErrors();
+  }
+  // Whether all the jobs finished.
+  bool Done() const { return num_pending_.load() == 0; }
+  // Report the errors of the finished jobs, if any.
+  int CollectErrors() {
     if (!has_error_.load()) return 0;
     std::ostringstream os;
     for (size_t i = 0; i < par_errors_.size(); ++i) {
@@ -117,6 +145,22 @@ class ParallelLauncher {
   }
   // Signal that one job has finished.
   void SignalJobFinish() { num_pending_.fetch_sub(1); }
+  // Keep a thread running a task of this launch, joined by JoinHelpers.
+  void AddHelper(std::thread thread) {
+    std::lock_guard<std::mutex> lock(helper_mutex_);
+    helpers_.push_back(std::move(thread));
+  }
+  // Join the helper threads, once all the jobs finished.
+  void JoinHelpers() {
+    std::vector<std::thread> helpers;
+    {
+      std::lock_guard<std::mutex> lock(helper_mutex_);
+      helpers.swap(helpers_);
+    }
+    for (std::thread& t : helpers) {
+      t.join();
+    }
+  }
   // Get thread local version of the store.
   static ParallelLauncher* ThreadLocal() { return dmlc::ThreadLocalStore<ParallelLauncher>::Get(); }
   // The parallel lambda
@@ -128,6 +172,8 @@ class ParallelLauncher {
   // Whether this thread is worker of the pool.
   // used to prevent recursive launch.
   bool is_worker{false};
+  // The pool of a work-stealing launch, nullptr for the static scheduler.
+  ThreadPool* stealing_pool{nullptr};
 
  private:
   // The pending jobs.
@@ -136,6 +182,11 @@ class ParallelLauncher {
   std::atomic<bool> has_error_;
   // The counter page.
   std::atomic<int32_t>* sync_counter_{nullptr};
+  // The number of tasks the counter page has room for.
+  int sync_size_{0};
+  // The threads started by barriers of a work-stealing launch.
+  std::mutex helper_mutex_;
+  std::vector<std::thread> helpers_;
   // The error message
   std::vector<std::string> par_errors_;
 };
@@ -198,6 +249,15 @@ class SpscTaskQueue {
   /*!
    * \brief Signal to terminate the worker.
    */
+  // Join the workers and drop their queues
+  void Stop() {
+    SignalForKill();
+    // Destroy threads before we destory the shared queue, otherwise we segfault on MacOS
+    threads_.reset();
+    queues_.clear();
+    deques_.clear();
+  }
+
   void SignalForKill() {
     std::lock_guard<std::mutex> lock(mutex_);
     exit_now_.store(true);
@@ -254,10 +314,124 @@ class SpscTaskQueue {
   std::condition_variable cv_;
 };
 
+/*!
+ * \brief A contiguous range of task ids of one parallel launch, the unit of stealing.
+ */
+struct TaskRange {
+  ParallelLauncher* launcher;
+  int32_t begin;
+  int32_t end;
+};
+
+/*!
+ * \brief Per-worker deque of the work-stealing scheduler. The owner takes one
+ *  task at a time from the front of its newest range, thieves take the back
+ *  half of its oldest range, so both sides touch different ends of the work.
+ */
+class StealingTaskDeque {
+ public:
+  void Push(const TaskRange& range) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ranges_.push_back(range);
+    num_tasks_.fetch_add(range.end - range.begin, std::memory_order_relaxed);
+  }
+
+  bool PopOne(ParallelLauncher** launcher, int32_t* task_id) {
+    if (num_tasks_.load(std::memory_order_relaxed) == 0) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ranges_.empty()) return false;
+    TaskRange& range = ranges_.back();
+    *launcher = range.launcher;
+    *task_id = range.begin++;
+    if (range.begin == range.end) ranges_.pop_back();
+    num_tasks_.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool StealHalf(TaskRange* stolen) {
+    if (num_tasks_.load(std::memory_order_relaxed) == 0) return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (ranges_.empty()) return false;
+    TaskRange& range = ranges_.front();
+    int32_t take = (range.end - range.begin + 1) / 2;
+    *stolen = TaskRange{range.launcher, range.end - take, range.end};
+    range.end -= take;
+    if (range.begin == range.end) ranges_.pop_front();
+    num_tasks_.fetch_sub(take, std::memory_order_relaxed);
+    return true;
+  }
+
+  /*!
+   * \brief Take every task of a launch that has not started yet.
+   * \return The number of tasks appended to task_ids.
+   */
+  int TakeAll(const ParallelLauncher* launcher, std::vector<int32_t>* task_ids) {
+    if (num_tasks_.load(std::memory_order_relaxed) == 0) return 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    int taken = 0;
+    for (auto it = ranges_.begin(); it != ranges_.end();) {
+      if (it->launcher != launcher) {
+        ++it;
+        continue;
+      }
+      for (int32_t i = it->begin; i < it->end; ++i) {
+        task_ids->push_back(i);
+      }
+      taken += it->end - it->begin;
+      it = ranges_.erase(it);
+    }
+    num_tasks_.fetch_sub(taken, std::memory_order_relaxed);
+    return taken;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::deque<TaskRange> ranges_;
+  // the number of tasks left, lets thieves skip empty deques without locking
+  std::atomic<int32_t> num_tasks_{0};
+};
+
+/*! \brief Scheduling counters of one worker in work-stealing mode. */
+struct StealingStats {
+  std::atomic<uint64_t> tasks{0};
+  std::atomic<uint64_t> steals{0};
+  std::atomic<uint64_t> failed_steals{0};
+  std::atomic<uint64_t> idle_ns{0};
+  // the counters of each worker sit on their own cache line
+  char pad[kL1CacheBytes];
+
+  void Reset() {
+    tasks.store(0);
+    steals.store(0);
+    failed_steals.store(0);
+    idle_ns.store(0);
+  }
+};
+
+/*!
+ * \brief Thread local state of the work-stealing scheduler, which lets a task
+ *  launch nested parallel jobs on the pool it runs in.
+ */
+struct StealingContext {
+  // The pool whose worker this thread is, nullptr for other threads.
+  ThreadPool* pool{nullptr};
+  int worker_id{0};
+  // The launch of the task running on this thread, for its barriers.
+  ParallelLauncher* running{nullptr};
+  // The launchers of the nested launches in progress on this thread.
+  std::vector<std::unique_ptr<ParallelLauncher>> launchers;
+  size_t depth{0};
+
+  static StealingContext* ThreadLocal() { return dmlc::ThreadLocalStore<StealingContext>::Get(); }
+};
+
 // The thread pool
 class ThreadPool {
  public:
-  ThreadPool() : num_workers_(tvm::runtime::threading::MaxConcurrency()) {
+  ThreadPool()
+      : num_workers_(LocalSize() > 0 ? LocalSize() : tvm::runtime::threading::MaxConcurrency()),
+        work_stealing_(GetWorkStealing()),
+        steal_chunks_(GetStealChunks()) {
     const char* exclude_worker0 = getenv("TVM_EXCLUDE_WORKER0");
     if (exclude_worker0 && atoi(exclude_worker0) == 0) {
       exclude_worker0_ = false;
@@ -266,23 +440,43 @@ class ThreadPool {
   }
 
   ~ThreadPool() {
-    for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
-      q->SignalForKill();
-    }
+    SignalForKill();
     threads_.reset();
   }
 
   void Reset() {
-    for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
-      q->SignalForKill();
-    }
-    // Destroy threads before we destory the shared queue, otherwise we segfault on MacOS
-    threads_.reset();
-    queues_.clear();
+    Stop();
     Init();
   }
 
+  /*!
+   * \brief Switch between the static and the work-stealing scheduler.
+   * \param enable Whether to use work stealing.
+   * \param chunks The number of tasks per worker a launch is split into, 0 keeps the current.
+   */
+  void ConfigWorkStealing(bool enable, int chunks) {
+    if (chunks > 0) {
+      steal_chunks_ = chunks;
+    }
+    if (enable != work_stealing_) {
+      work_stealing_ = enable;
+      Reset();
+    }
+  }
+
+  /*!
+   * \return The pool to launch on from this thread: the pool of the worker in
+   *  work-stealing mode, so that nested launches share its workers.
+   */
+  static ThreadPool* Current() {
+    ThreadPool* pool = StealingContext::ThreadLocal()->pool;
+    return pool != nullptr ? pool : ThreadLocal();
+  }
+
   int Launch(FTVMParallelLambda flambda, void* cdata, int num_task, int need_sync) {
+    if (work_stealing_) {
+      return LaunchStealing(flambda, cdata, num_task);
+    }
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
     ICHECK(!launcher->is_worker)
         << "Cannot launch parallel job inside worker, consider fuse then parallel";
@@ -317,29 +511,278 @@ class ThreadPool {
 
   static ThreadPool* ThreadLocal() { return dmlc::ThreadLocalStore<ThreadPool>::Get(); }
 
-  void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads) {
+  /*! \brief The size of the pool of this thread when created, 0 for MaxConcurrency. */
+  static int& LocalSize() {
+    static thread_local int size = 0;
+    return size;
+  }
+
+  /*!
+   * \brief Restart the pool with another number of workers.
+   * \param num_workers The number of workers, including the launching thread.
+   */
+  void Resize(int num_workers) {
+    if (num_workers == num_workers_) return;
+    Stop();
+    num_workers_ = num_workers;
+    stats_.reset();
+    Init();
+  }
+
+  void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads,
+                                 const std::vector<unsigned int>& cpus = {}) {
     // this will also reset the affinity of the ThreadGroup
     // may use less than the MaxConcurrency number of workers
-    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_);
+    num_workers_used_ = threads_->Configure(mode, nthreads, exclude_worker0_, cpus);
     // if MaxConcurrency restricted the number of workers (e.g., due to
     // hyperthreading), respect the restriction
     num_workers_used_ = std::min(num_workers_, num_workers_used_);
   }
 
+  /*!
+   * \brief Get the work-stealing counters of every worker.
+   * \param reset Clear the counters afterwards.
+   */
+  profiling::Report GetStealingStats(bool reset) {
+    Array<Map<String, ObjectRef>> calls;
+    uint64_t total_steals = 0;
+    double total_idle_us = 0;
+    for (int i = 0; i < num_workers_; ++i) {
+      StealingStats& stats = stats_[i];
+      Map<String, ObjectRef> row;
+      double idle_us = stats.idle_ns.load() / 1e3;
+      row.Set("Name", String("worker" + std::to_string(i)));
+      row.Set("Count", ObjectRef(make_object<profiling::CountNode>(stats.tasks.load())));
+      row.Set("Steals", ObjectRef(make_object<profiling::CountNode>(stats.steals.load())));
+      row.Set("Failed Steals",
+              ObjectRef(make_object<profiling::CountNode>(stats.failed_steals.load())));
+      row.Set("Idle (us)", ObjectRef(make_object<profiling::DurationNode>(idle_us)));
+      row.Set("Device", String("cpu0"));
+      calls.push_back(row);
+      total_steals += stats.steals.load();
+      total_idle_us += idle_us;
+      if (reset) {
+        stats.Reset();
+      }
+    }
+    Map<String, ObjectRef> total;
+    total.Set("Steals", ObjectRef(make_object<profiling::CountNode>(total_steals)));
+    total.Set("Idle (us)", ObjectRef(make_object<profiling::DurationNode>(total_idle_us)));
+    Map<String, Map<String, ObjectRef>> device_metrics;
+    device_metrics.Set("cpu0", total);
+    return profiling::Report(calls, device_metrics);
+  }
+
+  /*!
+   * \brief Start the tasks of a work-stealing launch that wait in the deques.
+   *
+   *  A launch may have more tasks than workers, and a task that waits at a
+   *  barrier keeps its worker, so the tasks not started yet are taken off the
+   *  deques and run on threads of their own. Called while waiting at a barrier,
+   *  this lets every task of the launch reach it.
+   * \param launcher The launch waiting at the barrier.
+   */
+  void StartQueuedTasks(ParallelLauncher* launcher) {
+    std::vector<int32_t> task_ids;
+    int taken = 0;
+    for (auto& deque : deques_) {
+      taken += deque->TakeAll(launcher, &task_ids);
+    }
+    if (taken == 0) return;
+    queued_tasks_.fetch_sub(taken);
+    for (int32_t task_id : task_ids) {
+      launcher->AddHelper(std::thread([this, launcher, task_id]() {
+        // nested launches of the task go to this pool like those of a worker
+        StealingContext::ThreadLocal()->pool = this;
+        RunStealingTask(launcher, task_id);
+      }));
+    }
+  }
+
  private:
   // Shared initialization code
   void Init() {
+    exit_now_.store(false);
+    if (stats_ == nullptr) {
+      stats_.reset(new StealingStats[num_workers_]);
+    }
     for (int i = 0; i < num_workers_; ++i) {
       // The SpscTaskQueue only hosts ONE item at a time
       queues_.emplace_back(std::unique_ptr<SpscTaskQueue>(new SpscTaskQueue()));
+      deques_.emplace_back(std::unique_ptr<StealingTaskDeque>(new StealingTaskDeque()));
     }
     threads_ = std::unique_ptr<tvm::runtime::threading::ThreadGroup>(
         new tvm::runtime::threading::ThreadGroup(
-            num_workers_, [this](int worker_id) { this->RunWorker(worker_id); },
+            num_workers_,
+            [this](int worker_id) {
+              if (work_stealing_) {
+                this->RunStealingWorker(worker_id);
+              } else {
+                this->RunWorker(worker_id);
+              }
+            },
             exclude_worker0_ /* include_main_thread */));
     num_workers_used_ = threads_->Configure(threading::ThreadGroup::kBig, 0, exclude_worker0_);
   }
 
+  // Join the workers and drop their queues
+  void Stop() {
+    SignalForKill();
+    // Destroy threads before we destory the shared queue, otherwise we segfault on MacOS
+    threads_.reset();
+    queues_.clear();
+    deques_.clear();
+  }
+
+  void SignalForKill() {
+    for (std::unique_ptr<SpscTaskQueue>& q : queues_) {
+      q->SignalForKill();
+    }
+    std::lock_guard<std::mutex> lock(steal_mutex_);
+    exit_now_.store(true);
+    steal_cv_.notify_all();
+  }
+
+  static void RunTask(ParallelLauncher* launcher, int32_t task_id) {
+    if ((*launcher->flambda)(task_id, &launcher->env, launcher->cdata) == 0) {
+      launcher->SignalJobFinish();
+    } else {
+      launcher->SignalJobError(task_id);
+    }
+  }
+
+  // Run a task of a work-stealing launch, remembering the launch for its barriers.
+  static void RunStealingTask(ParallelLauncher* launcher, int32_t task_id) {
+    StealingContext* ctx = StealingContext::ThreadLocal();
+    ParallelLauncher* outer = ctx->running;
+    ctx->running = launcher;
+    RunTask(launcher, task_id);
+    ctx->running = outer;
+  }
+
+  /*!
+   * \brief Run one task, from the own deque first, stealing half of the
+   *  oldest range of another worker otherwise.
+   * \return Whether a task was run.
+   */
+  bool RunOneTask(int worker_id) {
+    ParallelLauncher* launcher;
+    int32_t task_id;
+    StealingStats& stats = stats_[worker_id];
+    if (!deques_[worker_id]->PopOne(&launcher, &task_id)) {
+      if (queued_tasks_.load() == 0) return false;
+      TaskRange stolen;
+      bool found = false;
+      // start at a different victim every time to spread the thieves
+      int start = steal_seed_.fetch_add(1, std::memory_order_relaxed);
+      for (int i = 0; i < num_workers_used_ && !found; ++i) {
+        int victim = (start + i) % num_workers_used_;
+        if (victim == worker_id) continue;
+        found = deques_[victim]->StealHalf(&stolen);
+      }
+      if (!found) {
+        stats.failed_steals.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      stats.steals.fetch_add(1, std::memory_order_relaxed);
+      launcher = stolen.launcher;
+      task_id = stolen.begin++;
+      if (stolen.begin != stolen.end) {
+        deques_[worker_id]->Push(stolen);
+      }
+    }
+    queued_tasks_.fetch_sub(1);
+    stats.tasks.fetch_add(1, std::memory_order_relaxed);
+    RunStealingTask(launcher, task_id);
+    return true;
+  }
+
+  /*!
+   * \brief Launch in work-stealing mode. The tasks are split in contiguous
+   *  ranges over the worker deques, and the launching thread keeps running
+   *  tasks until its own are finished instead of waiting, which also makes
+   *  launches from inside a task work.
+   *
+   *  Tasks of a launch are not guaranteed to run at the same time, see
+   *  StartQueuedTasks for how TVMBackendParallelBarrier still completes.
+   */
+  int LaunchStealing(FTVMParallelLambda flambda, void* cdata, int num_task) {
+    StealingContext* ctx = StealingContext::ThreadLocal();
+    bool nested = ctx->pool == this;
+    int self = nested ? ctx->worker_id : 0;
+    if (ctx->launchers.size() <= ctx->depth) {
+      ctx->launchers.emplace_back(new ParallelLauncher());
+    }
+    ParallelLauncher* launcher = ctx->launchers[ctx->depth].get();
+    if (num_task == 0) {
+      // over-decompose so that the ragged tail of the work can be stolen
+      num_task = num_workers_used_ * steal_chunks_;
+    }
+    launcher->Init(flambda, cdata, num_task, true);
+    launcher->stealing_pool = this;
+    ctx->depth++;
+    queued_tasks_.fetch_add(num_task);
+    if (nested) {
+      // the other workers are busy, let them steal from here when they are done
+      deques_[self]->Push(TaskRange{launcher, 0, num_task});
+    } else {
+      for (int i = 0; i < num_workers_used_; ++i) {
+        int32_t begin = static_cast<int64_t>(num_task) * i / num_workers_used_;
+        int32_t end = static_cast<int64_t>(num_task) * (i + 1) / num_workers_used_;
+        if (begin < end) {
+          deques_[i]->Push(TaskRange{launcher, begin, end});
+        }
+      }
+    }
+    if (num_sleeping_.load() > 0) {
+      std::lock_guard<std::mutex> lock(steal_mutex_);
+      steal_cv_.notify_all();
+    }
+    while (!launcher->Done()) {
+      if (!RunOneTask(self)) {
+        tvm::runtime::threading::Yield();
+      }
+    }
+    launcher->JoinHelpers();
+    ctx->depth--;
+    return launcher->CollectErrors();
+  }
+
+  // Worker function of work-stealing mode.
+  void RunStealingWorker(int worker_id) {
+    ParallelLauncher::ThreadLocal()->is_worker = true;
+    StealingContext* ctx = StealingContext::ThreadLocal();
+    ctx->pool = this;
+    ctx->worker_id = worker_id;
+    static size_t spin_count = GetSpinCount();
+    StealingStats& stats = stats_[worker_id];
+    auto has_work = [this, worker_id] {
+      return worker_id < num_workers_used_ && queued_tasks_.load() > 0;
+    };
+    while (!exit_now_.load()) {
+      if (has_work() && RunOneTask(worker_id)) continue;
+      // Busy wait a bit for new work, then sleep until a launch wakes us up.
+      auto idle_begin = std::chrono::steady_clock::now();
+      for (size_t i = 0;
+           i < spin_count && !exit_now_.load(std::memory_order_relaxed) && !has_work(); ++i) {
+        tvm::runtime::threading::Yield();
+      }
+      if (!has_work()) {
+        num_sleeping_.fetch_add(1);
+        {
+          std::unique_lock<std::mutex> lock(steal_mutex_);
+          steal_cv_.wait(lock, [this, &has_work] { return exit_now_.load() || has_work(); });
+        }
+        num_sleeping_.fetch_sub(1);
+      }
+      stats.idle_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - idle_begin)
+                                  .count(),
+                              std::memory_order_relaxed);
+    }
+    ctx->pool = nullptr;
+  }
+
   // Internal worker function.
   void RunWorker(int worker_id) {
     SpscTaskQueue* queue = queues_[worker_id].get();
@@ -366,6 +809,19 @@ class ThreadPool {
   // if or not to exclude worker 0 and use main to run task 0
   bool exclude_worker0_{true};
   std::vector<std::unique_ptr<SpscTaskQueue> > queues_;
+  // work-stealing mode, selected with TVM_THREAD_POOL_WORK_STEALING or at runtime
+  bool work_stealing_;
+  // tasks per worker of a launch that does not set the number of tasks
+  int steal_chunks_;
+  std::vector<std::unique_ptr<StealingTaskDeque> > deques_;
+  std::unique_ptr<StealingStats[]> stats_;
+  // tasks pushed to the deques and not started yet
+  std::atomic<int32_t> queued_tasks_{0};
+  std::atomic<int32_t> num_sleeping_{0};
+  std::atomic<uint32_t> steal_seed_{0};
+  std::atomic<bool> exit_now_{false};
+  std::mutex steal_mutex_;
+  std::condition_variable steal_cv_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
 };
 
@@ -373,9 +829,35 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRe
   threading::ThreadGroup::AffinityMode mode =
       static_cast<threading::ThreadGroup::AffinityMode>(static_cast<int>(args[0]));
   int nthreads = args[1];
-  ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads);
+  // the trailing arguments are the cpu ids of kSpecifyOneCorePerThread
+  std::vector<unsigned int> cpus;
+  for (int i = 2; i < args.num_args; ++i) {
+    cpus.push_back(static_cast<unsigned int>(args[i].operator int()));
+  }
+  // a pool bound to given cpus spawns no workers beyond them, e.g. the pools of
+  // the inter-op workers of the graph executor, which share the cores.
+  int size = threading::MaxConcurrency();
+  if (mode == threading::ThreadGroup::kSpecifyOneCorePerThread) {
+    size = std::min(size, nthreads > 0 ? nthreads : static_cast<int>(cpus.size()));
+  }
+  ThreadPool::LocalSize() = size;
+  ThreadPool::ThreadLocal()->Resize(size);
+  ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads, cpus);
 });
 
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_work_stealing")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      bool enable = args[0];
+      int chunks = args.num_args > 1 ? args[1].operator int() : 0;
+      ThreadPool::ThreadLocal()->ConfigWorkStealing(enable, chunks);
+    });
+
+TVM_REGISTER_GLOBAL("runtime.threadpool_stealing_stats")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      bool reset = args.num_args > 0 ? args[0].operator bool() : false;
+      *rv = ThreadPool::ThreadLocal()->GetStealingStats(reset);
+    });
+
 namespace threading {
 void ResetThreadPool() { tvm::runtime::ThreadPool::ThreadLocal()->Reset(); }
 }  // namespace threading
@@ -394,7 +876,7 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
     return 0;
   } else {
 #if !TVM_THREADPOOL_USE_OPENMP
-    int res = tvm::runtime::ThreadPool::ThreadLocal()->Launch(flambda, cdata, num_task, 1);
+    int res = tvm::runtime::ThreadPool::Current()->Launch(flambda, cdata, num_task, 1);
     return res;
 #else
     // if (num_task == 0) num_task = num_workers;
@@ -418,10 +900,17 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
   using tvm::runtime::kSyncStride;
   int num_task = penv->num_task;
   std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
+  // in work-stealing mode the tasks still queued are started while waiting
+  tvm::runtime::ParallelLauncher* launcher = tvm::runtime::StealingContext::ThreadLocal()->running;
+  tvm::runtime::ThreadPool* pool =
+      launcher != nullptr && &launcher->env == penv ? launcher->stealing_pool : nullptr;
   int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
   for (int i = 0; i < num_task; ++i) {
     if (i != task_id) {
       while (sync_counter[i * kSyncStride].load(std::memory_order_relaxed) <= old_counter) {
+        if (pool != nullptr) {
+          pool->StartQueuedTasks(launcher);
+        }
         tvm::runtime::threading::Yield();
       }
     }
@@ -60,12 +60,16 @@ class ThreadGroup::Impl {
     }
   }
 
-  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0) {
+  int Configure(AffinityMode mode, int nthreads, bool exclude_worker0,
+                const std::vector<unsigned int>& cpus) {
     int num_workers_used = 0;
     if (mode == kLittle) {
       num_workers_used = little_count_;
     } else if (mode == kBig) {
       num_workers_used = big_count_;
+    } else if (mode == kSpecifyOneCorePerThread) {
+      ICHECK(!cpus.empty()) << "kSpecifyOneCorePerThread needs a list of cpus";
+      num_workers_used = cpus.size();
     } else {
       // use default
       num_workers_used = threading::MaxConcurrency();
@@ -82,9 +86,19 @@ class ThreadGroup::Impl {
 
     const char* val = getenv("TVM_BIND_THREADS");
     if (val == nullptr || atoi(val) == 1) {
-      // Do not set affinity if there are more workers than found cores
-      if (sorted_order_.size() >= static_cast<unsigned int>(num_workers_)) {
-        SetAffinity(exclude_worker0, mode == kLittle);
+      if (mode == kSpecifyOneCorePerThread) {
+        // the workers past the given cpus are not used, they share the cpus
+        SetAffinity(exclude_worker0, cpus, cpus);
+      } else if (sorted_order_.size() >= static_cast<unsigned int>(num_workers_)) {
+        // Do not set affinity if there are more workers than found cores
+        std::vector<unsigned int> order = sorted_order_;
+        int num_main_cores = std::min(MaxConcurrency(), big_count_);
+        if (mode == kLittle) {
+          std::reverse(order.begin(), order.end());
+          num_main_cores = little_count_;
+        }
+        std::vector<unsigned int> main_cores(order.begin(), order.begin() + num_main_cores);
+        SetAffinity(exclude_worker0, order, main_cores);
       } else {
         LOG(WARNING) << "The thread affinity cannot be set when the number of workers"
                      << "is larger than the number of available cores in the system.";
@@ -94,10 +108,11 @@ class ThreadGroup::Impl {
   }
 
  private:
-  // bind worker threads to disjoint cores
+  // bind worker threads to disjoint cores, worker i to cores[i]
   // if worker 0 is offloaded to main, i.e. exclude_worker0 is true,
-  // the main thread is bound to core 0.
-  void SetAffinity(bool exclude_worker0, bool reverse = false) {
+  // the main thread may run on any of main_cores.
+  void SetAffinity(bool exclude_worker0, const std::vector<unsigned int>& cores,
+                   const std::vector<unsigned int>& main_cores) {
 #if defined(__ANDROID__)
 #ifndef CPU_SET
 #define CPU_SETSIZE 1024
@@ -112,15 +127,8 @@ class ThreadGroup::Impl {
 #endif
 #endif
 #if defined(__linux__) || defined(__ANDROID__)
-    ICHECK_GE(sorted_order_.size(), num_workers_);
-
     for (unsigned i = 0; i < threads_.size(); ++i) {
-      unsigned core_id;
-      if (reverse) {
-        core_id = sorted_order_[sorted_order_.size() - (i + exclude_worker0) - 1];
-      } else {
-        core_id = sorted_order_[i + exclude_worker0];
-      }
+      unsigned core_id = cores[(i + exclude_worker0) % cores.size()];
       cpu_set_t cpuset;
       CPU_ZERO(&cpuset);
       CPU_SET(core_id, &cpuset);
@@ -135,12 +143,12 @@ class ThreadGroup::Impl {
       // Typically, the OS will schedule the main thread to run at core 0,
       // which is idle, when other workers are running.
       // See the comment inside SetMasterThreadFullCpuAffinity function to get more detail.
-      SetMasterThreadFullCpuAffinity(reverse);
+      SetMasterThreadFullCpuAffinity(main_cores);
     }
 #endif
   }
 
-  void SetMasterThreadFullCpuAffinity(bool reverse) {
+  void SetMasterThreadFullCpuAffinity(const std::vector<unsigned int>& cores) {
 #if defined(__linux__) || defined(__ANDROID__)
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
@@ -154,15 +162,8 @@ class ThreadGroup::Impl {
     // Note: this works well on x86 too. Because x86 doesn't have BIG.LITTLE,
     // our implementation will use kBig mode by default and will let main thread
     // run on intended cores.
-    if (reverse) {
-      for (int i = 0; i < little_count_; ++i) {
-        CPU_SET(sorted_order_[sorted_order_.size() - i - 1], &cpuset);
-      }
-    } else {
-      int num_cpu_workers = std::min(MaxConcurrency(), big_count_);
-      for (int i = 0; i < num_cpu_workers; ++i) {
-        CPU_SET(sorted_order_[i], &cpuset);
-      }
+    for (unsigned int core : cores) {
+      CPU_SET(core, &cpuset);
     }
 #if defined(__ANDROID__)
     sched_setaffinity(pthread_self(), sizeof(cpu_set_t), &cpuset);
@@ -231,8 +232,9 @@ ThreadGroup::ThreadGroup(int num_workers, std::function<void(int)> worker_callba
 ThreadGroup::~ThreadGroup() { delete impl_; }
 void ThreadGroup::Join() { impl_->Join(); }
 
-int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0) {
-  return impl_->Configure(mode, nthreads, exclude_worker0);
+int ThreadGroup::Configure(AffinityMode mode, int nthreads, bool exclude_worker0,
+                           const std::vector<unsigned int>& cpus) {
+  return impl_->Configure(mode, nthreads, exclude_worker0, cpus);
 }
 
 void Yield() { std::this_thread::yield(); }
@@ -78,6 +78,14 @@ PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Obje
       int index = args[1];
       *rv = this->GetFunctionParameterName(func_name, index);
     });
+  } else if (name == "save_constants_mapped") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->SaveConstantsMapped(args[0]);
+    });
+  } else if (name == "load_constants_mapped") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->LoadConstantsMapped(args[0]);
+    });
   } else if (name == "vm_load_executable") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       auto vm = make_object<VirtualMachine>();
@@ -168,8 +176,13 @@ std::string Executable::GetConstants() const {
 
   for (size_t i = 0; i < constants.size(); ++i) {
     const auto& constant = constants[i];
-    auto ndarray = Downcast<NDArray>(constant);
     DLDeviceType device_type = static_cast<DLDeviceType>(const_device_type[i]);
+    if (!constant.defined()) {
+      oss << "VM Constant[" << i << "]: is not loaded, on device of type " << device_type
+          << std::endl;
+      continue;
+    }
+    auto ndarray = Downcast<NDArray>(constant);
     oss << "VM Constant[" << i << "]: has shape " << ShapeString(ndarray.Shape(), ndarray->dtype)
         << " on device of type " << device_type << std::endl;
   }
@@ -183,6 +196,10 @@ std::string Executable::Stats() const {
   // Get the number of constants and the shape of each of them.
   oss << "  Constant shapes (# " << constants.size() << "): [";
   for (const auto& it : constants) {
+    if (!it.defined()) {
+      oss << "not loaded, ";
+      continue;
+    }
     const auto constant = Downcast<NDArray>(it);
     const auto& shape = constant.Shape();
 
@@ -278,7 +295,16 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
   strm->Write(glbs);
 }
 
+// Tags a constant section whose data is kept in a separate mapped file.
+constexpr uint64_t kVMMappedConstantsMagic = 0xC0E58D4F05049CB8;
+
 void Executable::SaveConstantSection(dmlc::Stream* strm) {
+  if (constants_mapped_) {
+    strm->Write(kVMMappedConstantsMagic);
+    strm->Write(static_cast<uint64_t>(this->constants.size()));
+    strm->Write(this->const_device_type);
+    return;
+  }
   std::vector<DLTensor*> arrays;
   for (const auto& obj : this->constants) {
     const auto cell = Downcast<runtime::NDArray>(obj);
@@ -591,6 +617,15 @@ void Executable::LoadConstantSection(dmlc::Stream* strm) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
+  if (sz == kVMMappedConstantsMagic) {
+    // the data is loaded later by LoadConstantsMapped.
+    STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
+    this->constants.resize(static_cast<size_t>(sz));
+    STREAM_CHECK(strm->Read(&this->const_device_type), "constant");
+    ICHECK_EQ(this->constants.size(), this->const_device_type.size());
+    this->constants_mapped_ = true;
+    return;
+  }
 
   size_t size = static_cast<size_t>(sz);
   // Load each of the constants.
@@ -607,6 +642,28 @@ void Executable::LoadConstantSection(dmlc::Stream* strm) {
   this->const_device_type = const_device_type;
 }
 
+void Executable::SaveConstantsMapped(const std::string& path) {
+  Map<String, NDArray> params;
+  for (size_t i = 0; i < this->constants.size(); ++i) {
+    ICHECK(this->constants[i].defined()) << "VM constant " << i << " is not loaded";
+    params.Set(std::to_string(i), Downcast<NDArray>(this->constants[i]));
+  }
+  SaveParamsMapped(path, params);
+  this->constants_mapped_ = true;
+}
+
+void Executable::LoadConstantsMapped(const std::string& path) {
+  Map<String, NDArray> params = LoadParamsMapped(path);
+  ICHECK_EQ(params.size(), this->constants.size())
+      << "The mapped constants do not belong to this executable";
+  for (size_t i = 0; i < this->constants.size(); ++i) {
+    auto it = params.find(std::to_string(i));
+    ICHECK(it != params.end()) << "VM constant " << i << " is missing in " << path;
+    this->constants[i] = (*it).second;
+  }
+  this->constants_mapped_ = true;
+}
+
 void Executable::LoadPrimitiveOpNames(dmlc::Stream* strm) {
   std::vector<std::string> primitive_names;
   STREAM_CHECK(strm->Read(&primitive_names), "primitive name");
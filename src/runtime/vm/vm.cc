@@ -32,6 +32,7 @@
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 #include <vector>
 
@@ -324,9 +325,18 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
     }
   }
 
-  std::vector<TVMValue> values(arity);
-  std::vector<int> codes(arity);
-  runtime::TVMArgsSetter setter(values.data(), codes.data());
+  // the call bound at load time if func is the packed function of packed_index,
+  // PackedFunc has no equality so it is recognized by its slot
+  std::unique_ptr<BoundPackedCall> other;
+  BoundPackedCall* call;
+  if (static_cast<size_t>(packed_index) < packed_calls_.size() &&
+      &func == &packed_funcs_[packed_index]) {
+    call = &packed_calls_[packed_index];
+  } else {
+    other.reset(new BoundPackedCall(func));
+    call = other.get();
+  }
+  call->SetNumArgs(arity);
   int idx = 0;
   bool is_empty_output = false;
   for (Index i = 0; i < arg_count; i++) {
@@ -334,7 +344,7 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
       for (size_t fi = 0; fi < dt_cell->size; ++fi) {
         auto obj = (*dt_cell)[fi];
         auto nd_array = Downcast<NDArray>(obj);
-        setter(idx++, nd_array);
+        call->Set(idx++, nd_array);
       }
     } else {
       auto nd_array = Downcast<NDArray>(args[i]);
@@ -348,13 +358,12 @@ void VirtualMachine::InvokePacked(Index packed_index, const PackedFunc& func, In
           }
         }
       }
-      setter(idx++, nd_array);
+      call->Set(idx++, nd_array);
     }
   }
 
   if (!is_empty_output) {
-    TVMRetValue rv;
-    func.CallPacked(TVMArgs(values.data(), codes.data(), arity), &rv);
+    call->Run();
   }
 }
 
@@ -381,6 +390,10 @@ void VirtualMachine::LoadExecutable(const Executable* exec) {
   for (size_t i = 0; i < packed_funcs_.size(); ++i) {
     ICHECK(packed_funcs_[i] != nullptr) << "Packed function " << i << " is not initialized";
   }
+  packed_calls_.clear();
+  for (const auto& pf : packed_funcs_) {
+    packed_calls_.emplace_back(pf);
+  }
 }
 
 void VirtualMachine::Init(const std::vector<Device>& devs,
@@ -465,6 +478,8 @@ void VirtualMachine::RunLoop() {
           OpStartHook(instr);
         }
         auto constant_obj = exec_->constants[instr.const_index];
+        ICHECK(constant_obj.defined()) << "VM constant " << instr.const_index
+                                       << " is saved apart, load it with load_constants_mapped";
         // We cache the allocated object in the constant pool. To measure, the
         // first iteration will set the pool up. The other iterations will
         // directly reuse the allocated objects.
@@ -504,16 +519,15 @@ void VirtualMachine::RunLoop() {
         ICHECK_LE(instr.packed_index, packed_funcs_.size());
         const auto& func = packed_funcs_[instr.packed_index];
         const auto& arity = instr.arity;
-        std::vector<ObjectRef> args;
+        packed_args_.clear();
         for (Index i = 0; i < arity; ++i) {
           VLOG(2) << "arg" << i << " $" << instr.packed_args[i];
-          auto arg = ReadRegister(instr.packed_args[i]);
-          args.push_back(arg);
+          packed_args_.push_back(ReadRegister(instr.packed_args[i]));
         }
 
         // We no longer need to write the registers back, we write directly
         // through the registers mutably.
-        InvokePacked(instr.packed_index, func, arity, instr.output_size, args);
+        InvokePacked(instr.packed_index, func, arity, instr.output_size, packed_args_);
         pc_++;
         goto main_loop;
       }
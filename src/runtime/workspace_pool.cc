@@ -23,120 +23,281 @@
  */
 #include "workspace_pool.h"
 
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
 namespace tvm {
 namespace runtime {
 
 // page size.
 constexpr size_t kWorkspacePageSize = 4 << 10;
+// The number of freed blocks of a size class kept aside from coalescing.
+constexpr size_t kMaxCachedPerClass = 4;
+
+// Round up to a size class, there are four classes per power of two above the page size.
+static size_t RoundToSizeClass(size_t nbytes) {
+  if (nbytes <= kWorkspacePageSize) return kWorkspacePageSize;
+  size_t msb = kWorkspacePageSize;
+  while ((msb << 1) <= nbytes - 1) msb <<= 1;
+  size_t step = std::max(kWorkspacePageSize, msb / 4);
+  return (nbytes + step - 1) / step * step;
+}
+
+// Whether the data pointers of the device can be offset, so that blocks can be split.
+static bool IsAddressable(DLDeviceType device_type) {
+  switch (static_cast<int>(device_type)) {
+    case kDLCPU:
+    case kDLCUDA:
+    case kDLCUDAHost:
+    case kDLCUDAManaged:
+    case kDLROCM:
+    case kDLROCMHost:
+      return true;
+    default:
+      return false;
+  }
+}
 
 class WorkspacePool::Pool {
  public:
-  // constructor
-  Pool() {
-    // safe guard header on each list.
-    Entry e;
-    e.data = nullptr;
-    e.size = 0;
-    free_list_.push_back(e);
-    allocated_.push_back(e);
-  }
+  explicit Pool(bool addressable) : addressable_(addressable) {}
   // allocate from pool
   void* Alloc(Device dev, DeviceAPI* device, size_t nbytes) {
-    // Allocate align to page.
-    nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
-    if (nbytes == 0) nbytes = kWorkspacePageSize;
-    Entry e;
-    DLDataType type;
-    type.code = kDLUInt;
-    type.bits = 8;
-    type.lanes = 1;
-    if (free_list_.size() == 2) {
-      e = free_list_.back();
-      free_list_.pop_back();
-      if (e.size < nbytes) {
-        // resize the page
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
-      }
-    } else if (free_list_.size() == 1) {
-      e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-      e.size = nbytes;
+    size_t size = RoundToSizeClass(nbytes);
+    Block* block = nullptr;
+    auto bin = cache_.find(size);
+    if (bin != cache_.end() && !bin->second.empty()) {
+      // fast path, the same class was freed recently.
+      block = bin->second.back();
+      bin->second.pop_back();
+      block->cached = false;
+      block->free = false;
+      stats_.num_cache_hits.fetch_add(1, std::memory_order_relaxed);
     } else {
-      if (free_list_.back().size >= nbytes) {
-        // find smallest fit
-        auto it = free_list_.end() - 2;
-        for (; it->size >= nbytes; --it) {
-        }
-        e = *(it + 1);
-        free_list_.erase(it + 1);
-      } else {
-        // resize the page
-        e = free_list_.back();
-        free_list_.pop_back();
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+      block = TakeBestFit(size);
+      if (block == nullptr) {
+        // coalesce the cached blocks and look again.
+        FlushCache();
+        block = TakeBestFit(size);
+      }
+      if (block == nullptr) {
+        // whole free chunks are all smaller than size here, give them back before growing.
+        ReleaseFreeChunks(dev, device);
+        block = NewChunk(dev, device, size);
       }
+      Split(block, size);
     }
-    allocated_.push_back(e);
-    return e.data;
+    allocated_[block->data] = block;
+    stats_.num_allocs.fetch_add(1, std::memory_order_relaxed);
+    UpdatePeak(&stats_.in_use, &stats_.peak_in_use, block->size);
+    return block->data;
   }
   // free resource back to pool
   void Free(void* data) {
-    Entry e;
-    if (allocated_.back().data == data) {
-      // quick path, last allocated.
-      e = allocated_.back();
-      allocated_.pop_back();
-    } else {
-      int index = static_cast<int>(allocated_.size()) - 2;
-      for (; index > 0 && allocated_[index].data != data; --index) {
+    auto it = allocated_.find(data);
+    ICHECK(it != allocated_.end()) << "trying to free things that has not been allocated";
+    Block* block = it->second;
+    allocated_.erase(it);
+    stats_.in_use.fetch_sub(block->size, std::memory_order_relaxed);
+    block->free = true;
+    if (block->size == RoundToSizeClass(block->size)) {
+      std::vector<Block*>& bin = cache_[block->size];
+      if (bin.size() < kMaxCachedPerClass) {
+        block->cached = true;
+        bin.push_back(block);
+        return;
       }
-      ICHECK_GT(index, 0) << "trying to free things that has not been allocated";
-      e = allocated_[index];
-      allocated_.erase(allocated_.begin() + index);
-    }
-    if (free_list_.back().size < e.size) {
-      free_list_.push_back(e);
-    } else if (free_list_.size() == 2) {
-      free_list_.push_back(free_list_.back());
-      free_list_[1] = e;
-    } else {
-      size_t i = free_list_.size() - 1;
-      free_list_.resize(free_list_.size() + 1);
-      for (; e.size < free_list_[i].size; --i) {
-        free_list_[i + 1] = free_list_[i];
-      }
-      free_list_[i + 1] = e;
     }
+    InsertFree(Coalesce(block));
   }
   // Release all resources
   void Release(Device dev, DeviceAPI* device) {
-    for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(dev, free_list_[i].data);
+    FlushCache();
+    ReleaseFreeChunks(dev, device);
+    // chunks with live workspaces are left to their owners.
+    for (auto& kv : free_) delete kv.second;
+    for (auto& kv : allocated_) delete kv.second;
+    free_.clear();
+    allocated_.clear();
+  }
+  // Snapshot of the counters, may be called from other threads.
+  Stats GetStats(bool reset_peak) {
+    Stats stats;
+    stats.in_use = stats_.in_use.load(std::memory_order_relaxed);
+    stats.peak_in_use = stats_.peak_in_use.load(std::memory_order_relaxed);
+    stats.reserved = stats_.reserved.load(std::memory_order_relaxed);
+    stats.peak_reserved = stats_.peak_reserved.load(std::memory_order_relaxed);
+    stats.num_allocs = stats_.num_allocs.load(std::memory_order_relaxed);
+    stats.num_cache_hits = stats_.num_cache_hits.load(std::memory_order_relaxed);
+    stats.num_device_allocs = stats_.num_device_allocs.load(std::memory_order_relaxed);
+    if (reset_peak) {
+      stats_.peak_in_use.store(stats.in_use, std::memory_order_relaxed);
+      stats_.peak_reserved.store(stats.reserved, std::memory_order_relaxed);
     }
-    free_list_.clear();
+    return stats;
   }
 
  private:
-  /*! \brief a single entry in the pool */
-  struct Entry {
+  /*!
+   * \brief A block of a chunk allocated from the device.
+   *  The blocks of a chunk are linked in address order, the first one starts the chunk.
+   */
+  struct Block {
     void* data;
     size_t size;
+    Block* prev{nullptr};
+    Block* next{nullptr};
+    bool free{false};
+    /*! \brief Freed but parked in the class cache, not coalesced. */
+    bool cached{false};
+    std::multimap<size_t, Block*>::iterator free_it;
   };
-  /*! \brief List of free items, sorted from small to big size */
-  std::vector<Entry> free_list_;
-  /*! \brief List of allocated items */
-  std::vector<Entry> allocated_;
+  /*! \brief Counters written by the owner thread, read by GetStats. */
+  struct AtomicStats {
+    std::atomic<int64_t> in_use{0};
+    std::atomic<int64_t> peak_in_use{0};
+    std::atomic<int64_t> reserved{0};
+    std::atomic<int64_t> peak_reserved{0};
+    std::atomic<int64_t> num_allocs{0};
+    std::atomic<int64_t> num_cache_hits{0};
+    std::atomic<int64_t> num_device_allocs{0};
+  };
+
+  static void UpdatePeak(std::atomic<int64_t>* value, std::atomic<int64_t>* peak, int64_t delta) {
+    int64_t now = value->fetch_add(delta, std::memory_order_relaxed) + delta;
+    if (now > peak->load(std::memory_order_relaxed)) {
+      peak->store(now, std::memory_order_relaxed);
+    }
+  }
+  // remove the smallest free block of at least size from the free list.
+  Block* TakeBestFit(size_t size) {
+    auto it = free_.lower_bound(size);
+    if (it == free_.end()) return nullptr;
+    Block* block = it->second;
+    free_.erase(it);
+    block->free = false;
+    return block;
+  }
+  void InsertFree(Block* block) { block->free_it = free_.emplace(block->size, block); }
+  // split the tail of a taken block off when it is worth a page.
+  void Split(Block* block, size_t size) {
+    if (!addressable_ || block->size - size < kWorkspacePageSize) return;
+    Block* rest = new Block();
+    rest->data = static_cast<char*>(block->data) + size;
+    rest->size = block->size - size;
+    rest->prev = block;
+    rest->next = block->next;
+    rest->free = true;
+    if (block->next != nullptr) block->next->prev = rest;
+    block->next = rest;
+    block->size = size;
+    InsertFree(Coalesce(rest));
+  }
+  // merge a free block with its free neighbours, the returned block is not on the free list.
+  Block* Coalesce(Block* block) {
+    Block* next = block->next;
+    if (next != nullptr && next->free && !next->cached) {
+      free_.erase(next->free_it);
+      block->size += next->size;
+      block->next = next->next;
+      if (next->next != nullptr) next->next->prev = block;
+      delete next;
+    }
+    Block* prev = block->prev;
+    if (prev != nullptr && prev->free && !prev->cached) {
+      free_.erase(prev->free_it);
+      prev->size += block->size;
+      prev->next = block->next;
+      if (block->next != nullptr) block->next->prev = prev;
+      delete block;
+      block = prev;
+    }
+    return block;
+  }
+  void FlushCache() {
+    for (auto& kv : cache_) {
+      for (Block* block : kv.second) {
+        block->cached = false;
+        InsertFree(Coalesce(block));
+      }
+      kv.second.clear();
+    }
+  }
+  // give every chunk that is entirely free back to the device.
+  void ReleaseFreeChunks(Device dev, DeviceAPI* device) {
+    for (auto it = free_.begin(); it != free_.end();) {
+      Block* block = it->second;
+      if (block->prev == nullptr && block->next == nullptr) {
+        device->FreeDataSpace(dev, block->data);
+        stats_.reserved.fetch_sub(block->size, std::memory_order_relaxed);
+        delete block;
+        it = free_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  Block* NewChunk(Device dev, DeviceAPI* device, size_t size) {
+    DLDataType type;
+    type.code = kDLUInt;
+    type.bits = 8;
+    type.lanes = 1;
+    Block* block = new Block();
+    block->data = device->AllocDataSpace(dev, size, kTempAllocaAlignment, type);
+    block->size = size;
+    stats_.num_device_allocs.fetch_add(1, std::memory_order_relaxed);
+    UpdatePeak(&stats_.reserved, &stats_.peak_reserved, size);
+    return block;
+  }
+
+  /*! \brief Whether blocks can be split and coalesced. */
+  bool addressable_;
+  /*! \brief Free blocks by size. */
+  std::multimap<size_t, Block*> free_;
+  /*! \brief Recently freed blocks by size class. */
+  std::unordered_map<size_t, std::vector<Block*>> cache_;
+  /*! \brief Live blocks by data pointer. */
+  std::unordered_map<void*, Block*> allocated_;
+  AtomicStats stats_;
+};
+
+namespace {
+/*! \brief The live pools of the process, for GetStats and VisitAll. */
+struct PoolRegistry {
+  std::mutex mutex;
+  std::vector<WorkspacePool*> pools;
+
+  static PoolRegistry* Global() {
+    // leaked, thread local pools can be destroyed after static destructors ran.
+    static PoolRegistry* inst = new PoolRegistry();
+    return inst;
+  }
 };
+}  // namespace
 
 WorkspacePool::WorkspacePool(DLDeviceType device_type, DeviceAPI* device)
-    : device_type_(device_type), device_(device) {}
+    : device_type_(device_type), device_(device) {
+  PoolRegistry* registry = PoolRegistry::Global();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  registry->pools.push_back(this);
+}
 
 WorkspacePool::~WorkspacePool() {
+  {
+    PoolRegistry* registry = PoolRegistry::Global();
+    std::lock_guard<std::mutex> lock(registry->mutex);
+    auto& pools = registry->pools;
+    pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+  }
   for (size_t i = 0; i < array_.size(); ++i) {
     if (array_[i] != nullptr) {
       Device dev;
@@ -149,11 +310,13 @@ WorkspacePool::~WorkspacePool() {
 }
 
 void* WorkspacePool::AllocWorkspace(Device dev, size_t size) {
-  if (static_cast<size_t>(dev.device_id) >= array_.size()) {
-    array_.resize(dev.device_id + 1, nullptr);
-  }
-  if (array_[dev.device_id] == nullptr) {
-    array_[dev.device_id] = new Pool();
+  if (static_cast<size_t>(dev.device_id) >= array_.size() || array_[dev.device_id] == nullptr) {
+    // array_ is only modified under the registry lock, so that stats readers can walk it.
+    std::lock_guard<std::mutex> lock(PoolRegistry::Global()->mutex);
+    if (static_cast<size_t>(dev.device_id) >= array_.size()) {
+      array_.resize(dev.device_id + 1, nullptr);
+    }
+    array_[dev.device_id] = new Pool(IsAddressable(device_type_));
   }
   return array_[dev.device_id]->Alloc(dev, device_, size);
 }
@@ -163,5 +326,69 @@ void WorkspacePool::FreeWorkspace(Device dev, void* ptr) {
   array_[dev.device_id]->Free(ptr);
 }
 
+WorkspacePool::Stats WorkspacePool::GetStats(Device dev, bool reset_peak) {
+  std::lock_guard<std::mutex> lock(PoolRegistry::Global()->mutex);
+  if (static_cast<size_t>(dev.device_id) >= array_.size() || array_[dev.device_id] == nullptr) {
+    return Stats();
+  }
+  return array_[dev.device_id]->GetStats(reset_peak);
+}
+
+void WorkspacePool::VisitAll(const std::function<void(Device, const Stats&)>& fvisit,
+                             bool reset_peak) {
+  PoolRegistry* registry = PoolRegistry::Global();
+  std::lock_guard<std::mutex> lock(registry->mutex);
+  for (WorkspacePool* pool : registry->pools) {
+    for (size_t i = 0; i < pool->array_.size(); ++i) {
+      if (pool->array_[i] == nullptr) continue;
+      Device dev;
+      dev.device_type = pool->device_type_;
+      dev.device_id = static_cast<int>(i);
+      fvisit(dev, pool->array_[i]->GetStats(reset_peak));
+    }
+  }
+}
+
+TVM_REGISTER_GLOBAL("runtime.workspace_pool_stats").set_body([](TVMArgs args, TVMRetValue* rv) {
+  bool reset = args.num_args > 0 ? args[0].operator bool() : false;
+  // the pools are per thread, sum them up per device.
+  std::map<std::string, WorkspacePool::Stats> totals;
+  WorkspacePool::VisitAll(
+      [&totals](Device dev, const WorkspacePool::Stats& stats) {
+        WorkspacePool::Stats& total =
+            totals[DeviceName(dev.device_type) + std::to_string(dev.device_id)];
+        total.in_use += stats.in_use;
+        total.peak_in_use += stats.peak_in_use;
+        total.reserved += stats.reserved;
+        total.peak_reserved += stats.peak_reserved;
+        total.num_allocs += stats.num_allocs;
+        total.num_cache_hits += stats.num_cache_hits;
+        total.num_device_allocs += stats.num_device_allocs;
+      },
+      reset);
+  auto count = [](int64_t value) { return ObjectRef(make_object<profiling::CountNode>(value)); };
+  Array<Map<String, ObjectRef>> calls;
+  Map<String, Map<String, ObjectRef>> device_metrics;
+  for (const auto& kv : totals) {
+    const WorkspacePool::Stats& stats = kv.second;
+    Map<String, ObjectRef> row;
+    row.Set("Name", String("workspace"));
+    row.Set("Device", String(kv.first));
+    row.Set("Count", count(stats.num_allocs));
+    row.Set("Cache Hits", count(stats.num_cache_hits));
+    row.Set("Device Allocs", count(stats.num_device_allocs));
+    row.Set("In Use (bytes)", count(stats.in_use));
+    row.Set("Peak In Use (bytes)", count(stats.peak_in_use));
+    row.Set("Reserved (bytes)", count(stats.reserved));
+    row.Set("Peak Reserved (bytes)", count(stats.peak_reserved));
+    calls.push_back(row);
+    Map<String, ObjectRef> metrics;
+    metrics.Set("Peak In Use (bytes)", count(stats.peak_in_use));
+    metrics.Set("Peak Reserved (bytes)", count(stats.peak_reserved));
+    device_metrics.Set(kv.first, metrics);
+  }
+  *rv = profiling::Report(calls, device_metrics);
+});
+
 }  // namespace runtime
 }  // namespace tvm
@@ -26,6 +26,7 @@
 
 #include <tvm/runtime/device_api.h>
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -41,6 +42,14 @@ namespace runtime {
  *  - Only a few allocation will happen, and space will be released after use.
  *  - The release order is usually in reverse order of allocate
  *  - Repeative pattern of same allocations over different runs.
+ *
+ *  Requests are rounded up to size classes, four per power of two, and served
+ *  best-fit from the free blocks of the pool. The last few blocks freed in a
+ *  class are cached as they are and handed back to the next request of that
+ *  class. On devices whose data pointers are addressable, a larger block is split
+ *  and neighbouring free blocks are coalesced again, so a varying demand can be
+ *  served from the same memory. The pool is meant to be owned by a single
+ *  thread, every backend keeps one per thread.
  */
 class TVM_DLL WorkspacePool {
  public:
@@ -66,6 +75,38 @@ class TVM_DLL WorkspacePool {
    */
   void FreeWorkspace(Device dev, void* ptr);
 
+  /*! \brief Allocation counters of the pool of one device. */
+  struct Stats {
+    /*! \brief Bytes handed out to live workspaces, after size class rounding. */
+    int64_t in_use{0};
+    /*! \brief High-water mark of in_use. */
+    int64_t peak_in_use{0};
+    /*! \brief Bytes held from the device API. */
+    int64_t reserved{0};
+    /*! \brief High-water mark of reserved. */
+    int64_t peak_reserved{0};
+    /*! \brief Number of AllocWorkspace calls. */
+    int64_t num_allocs{0};
+    /*! \brief Number of AllocWorkspace calls served from the per class cache. */
+    int64_t num_cache_hits{0};
+    /*! \brief Number of AllocWorkspace calls that went to the device API. */
+    int64_t num_device_allocs{0};
+  };
+  /*!
+   * \brief Get the counters of one device, safe to call from any thread.
+   * \param dev The device.
+   * \param reset_peak Restart the high-water marks from the current usage.
+   */
+  Stats GetStats(Device dev, bool reset_peak = false);
+  /*!
+   * \brief Visit every live pool of the process.
+   * \param fvisit Called with the device type and the device id of each device
+   *  pool along with its counters.
+   * \param reset_peak Restart the high-water marks from the current usage.
+   */
+  static void VisitAll(const std::function<void(Device, const Stats&)>& fvisit,
+                       bool reset_peak = false);
+
  private:
   class Pool;
   /*! \brief pool of device local array */
@@ -0,0 +1,228 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file codegen_riscv.cc
+ * \brief RISC-V specific code generator
+ */
+#ifdef TVM_LLVM_VERSION
+
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/op.h>
+
+#include <limits>
+#include <mutex>
+#include <string>
+
+#include "codegen_cpu.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/CommandLine.h"
+
+namespace tvm {
+namespace codegen {
+
+// RISC-V specific code generator. With the vector extension, the vector
+// length of the target is passed to LLVM so that fixed width TIR vectors
+// and the loops LLVM vectorizes itself, reductions included, are lowered
+// to RVV, and the vector exponentials and logarithms are expanded inline
+// under fast-math instead of being scalarized into libm calls.
+class CodeGenRISCV final : public CodeGenCPU {
+ public:
+  void InitTarget(llvm::TargetMachine* tm) final {
+    vlen_ = GetVLEN(*tm);
+    // without vector registers keep the default width, which only affects alignment.
+    native_vector_bits_ = vlen_ > 0 ? vlen_ : 128;
+    SetMinVectorBits(vlen_ >= 128 ? vlen_ : 0);
+    CodeGenCPU::InitTarget(tm);
+  }
+  llvm::Value* CreateIntrinsic(const CallNode* op) override;
+
+ protected:
+  void Optimize() final;
+
+ private:
+  /*! \return The minimal vector register width in bits, 0 without the vector extension. */
+  static int GetVLEN(const llvm::TargetMachine& tm);
+  /*!
+   * \brief Tell LLVM 14 and 15 the minimal vector length, they lower fixed width
+   *  vectors to RVV only with it set on the command line, 0 turns it off.
+   */
+  static void SetMinVectorBits(int bits);
+  /*! \brief Expand exp of a float32 vector into a polynomial LLVM vectorizes as is. */
+  PrimExpr VectorFastExp(const PrimExpr& e);
+  /*! \brief Expand the natural log of a float32 vector, as VectorFastExp. */
+  PrimExpr VectorFastLog(const PrimExpr& e);
+  int vlen_{0};
+};
+
+int CodeGenRISCV::GetVLEN(const llvm::TargetMachine& tm) {
+  // Zve32x, implied by V, and the Zvl*b features are known since LLVM 14.
+#if TVM_LLVM_VERSION >= 140
+  const auto* MCInfo = tm.getMCSubtargetInfo();
+  if (!MCInfo->checkFeatures("+zve32x")) return 0;
+  // V implies Zvl128b, the Zvl*b features are cumulative.
+  for (int vlen = 65536; vlen > 32; vlen /= 2) {
+    if (MCInfo->checkFeatures("+zvl" + std::to_string(vlen) + "b")) return vlen;
+  }
+  return 32;
+#else
+  return 0;
+#endif
+}
+
+void CodeGenRISCV::SetMinVectorBits(int bits) {
+#if TVM_LLVM_VERSION >= 140 && TVM_LLVM_VERSION < 160
+  // from LLVM 16 on, the Zvl*b features are enough. The option is global to LLVM
+  // and takes a single occurrence, so it is reset to its default before every
+  // build sets its own value; builds of different vector lengths running
+  // concurrently in one process still see whichever value was set last.
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& options = llvm::cl::getRegisteredOptions();
+  auto it = options.find("riscv-v-vector-bits-min");
+  if (it != options.end()) {
+    llvm::cl::Option* option = it->second;
+    option->reset();
+    if (bits > 0) {
+      option->addOccurrence(0, option->ArgStr, std::to_string(bits));
+    }
+  }
+#endif
+}
+
+void CodeGenRISCV::Optimize() {
+#if TVM_LLVM_VERSION >= 140
+  if (vlen_ >= 64) {
+    // vscale is the number of 64 bit blocks of a vector register, an exact
+    // range lets LLVM pick scalable vectors for loops and reductions.
+    unsigned vscale = static_cast<unsigned>(vlen_ / 64);
+    for (llvm::Function& f : *module_) {
+      if (f.isDeclaration()) continue;
+      f.addFnAttr(llvm::Attribute::getWithVScaleRangeArgs(*ctx_, vscale, vscale));
+    }
+  }
+#endif
+  CodeGenCPU::Optimize();
+}
+
+llvm::Value* CodeGenRISCV::CreateIntrinsic(const CallNode* op) {
+#if TVM_LLVM_VERSION >= 140
+  if (op->op.same_as(builtin_call_llvm_pure_intrin_) && vlen_ > 0) {
+    llvm::Intrinsic::ID id = static_cast<llvm::Intrinsic::ID>(Downcast<IntImm>(op->args[0])->value);
+    if (op->dtype.is_vector() && op->dtype.element_of() == DataType::Float(32) &&
+        builder_->getFastMathFlags().approxFunc()) {
+      const PrimExpr& x = op->args[2];
+      DataType t = op->dtype;
+      switch (id) {
+        case ::llvm::Intrinsic::exp:
+          return MakeValue(VectorFastExp(x));
+        case ::llvm::Intrinsic::exp2:
+          return MakeValue(VectorFastExp(x * make_const(t, 0.6931471805599453f)));
+        case ::llvm::Intrinsic::log:
+          return MakeValue(VectorFastLog(x));
+        case ::llvm::Intrinsic::log2:
+          return MakeValue(VectorFastLog(x) * make_const(t, 1.44269504088896341f));
+        case ::llvm::Intrinsic::log10:
+          return MakeValue(VectorFastLog(x) * make_const(t, 0.434294481903251828f));
+        default:
+          break;
+      }
+    }
+  }
+#endif
+  return CodeGenCPU::CreateIntrinsic(op);
+}
+
+PrimExpr CodeGenRISCV::VectorFastExp(const PrimExpr& e) {
+  using namespace tir;
+  // same approximation as topi::fast_exp_float32, the intrinsics are
+  // already lowered here so floor goes to LLVM directly.
+  DataType t = e.dtype();
+  DataType ti = DataType::Int(32, t.lanes());
+  Var x("x", t);
+  PrimExpr p[6] = {make_const(t, 1.9875691500E-4f), make_const(t, 1.3981999507E-3f),
+                   make_const(t, 8.3334519073E-3f), make_const(t, 4.1665795894E-2f),
+                   make_const(t, 1.6666665459E-1f), make_const(t, 5.0000001201E-1f)};
+  // clamp x
+  PrimExpr clamped =
+      max(min(x, make_const(t, 88.3762626647950f)), make_const(t, -88.3762626647949f));
+  // integer part
+  PrimExpr n = Call(t, builtin_call_llvm_pure_intrin_,
+                    {IntImm(DataType::UInt(32), ::llvm::Intrinsic::floor),
+                     IntImm(DataType::UInt(32), 1),
+                     clamped * make_const(t, 1.44269504088896341f) + make_const(t, 0.5f)});
+  // fractional part
+  PrimExpr f = clamped - n * make_const(t, 0.6931471805599453f);
+  PrimExpr y = (((((p[0] * f + p[1]) * f + p[2]) * f + p[3]) * f + p[4]) * f + p[5]) * f * f + f +
+               make_const(t, 1.0f);
+  // 2^n * exp(f)
+  PrimExpr ef = reinterpret(t, cast(ti, n + make_const(t, 127.0f)) << make_const(ti, 23));
+  return Let(x, e, max(ef * y, x));
+}
+
+PrimExpr CodeGenRISCV::VectorFastLog(const PrimExpr& e) {
+  using namespace tir;
+  // the cephes logf approximation, on the mantissa in [sqrt(1/2), sqrt(2)).
+  DataType t = e.dtype();
+  DataType ti = DataType::Int(32, t.lanes());
+  Var x("x", t);
+  PrimExpr bits = reinterpret(ti, max(x, make_const(t, 1.17549435e-38f)));
+  // x = m * 2^k with m in [0.5, 1)
+  PrimExpr k = cast(t, (bits >> make_const(ti, 23)) - make_const(ti, 126));
+  PrimExpr m = reinterpret(t, (bits & make_const(ti, 0x007fffff)) | make_const(ti, 0x3f000000));
+  PrimExpr small = m < make_const(t, 0.707106781186547524f);
+  k = Select(small, k - make_const(t, 1.0f), k);
+  Var f("f", t);
+  PrimExpr z = f * f;
+  PrimExpr p[9] = {make_const(t, 7.0376836292E-2f), make_const(t, -1.1514610310E-1f),
+                   make_const(t, 1.1676998740E-1f), make_const(t, -1.2420140846E-1f),
+                   make_const(t, 1.4249322787E-1f), make_const(t, -1.6668057665E-1f),
+                   make_const(t, 2.0000714765E-1f), make_const(t, -2.4999993993E-1f),
+                   make_const(t, 3.3333331174E-1f)};
+  PrimExpr y = p[0];
+  for (int i = 1; i < 9; i++) {
+    y = y * f + p[i];
+  }
+  y = y * f * z + k * make_const(t, -2.12194440E-4f) - z * make_const(t, 0.5f);
+  PrimExpr log = f + y + k * make_const(t, 0.693359375f);
+  // log(inf) = inf, log(0) = -inf, NaN below 0 and for NaN
+  PrimExpr inf = make_const(t, std::numeric_limits<float>::infinity());
+  PrimExpr special = Select(x == make_const(t, 0.0f), -inf,
+                            make_const(t, std::numeric_limits<float>::quiet_NaN()));
+  PrimExpr body = Select(x > make_const(t, 0.0f), Select(x == inf, x, log), special);
+  // f = 2m - 1 below sqrt(1/2), m - 1 otherwise
+  PrimExpr fraction = Select(small, m + m, m) - make_const(t, 1.0f);
+  return Let(x, e, Let(f, fraction, body));
+}
+
+TVM_REGISTER_GLOBAL("tvm.codegen.llvm.target_riscv32")
+    .set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+      CodeGenLLVM* cg = new CodeGenRISCV();
+      *rv = static_cast<void*>(cg);
+    });
+
+TVM_REGISTER_GLOBAL("tvm.codegen.llvm.target_riscv64")
+    .set_body([](const TVMArgs& targs, TVMRetValue* rv) {
+      CodeGenLLVM* cg = new CodeGenRISCV();
+      *rv = static_cast<void*>(cg);
+    });
+
+}  // namespace codegen
+}  // namespace tvm
+#endif  // TVM_LLVM_VERSION
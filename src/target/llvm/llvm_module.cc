@@ -23,12 +23,18 @@
  */
 #ifdef TVM_LLVM_VERSION
 
+#include <tvm/driver/driver_api.h>
 #include <tvm/ir/module.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/target/codegen.h>
 
+#include <algorithm>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "../../runtime/file_utils.h"
 #include "../../runtime/library_module.h"
@@ -45,6 +51,54 @@ using runtime::PackedFunc;
 using runtime::TVMArgs;
 using runtime::TVMRetValue;
 
+// Get the fast math flags of the target.
+// See https://llvm.org/docs/LangRef.html#fast-math-flags for details
+static llvm::FastMathFlags GetFastMathFlags(const Target& target) {
+  Bool fast_math_all = target->GetAttr<Bool>("fast-math").value_or(Bool(false));
+  Bool fast_math_nnan = target->GetAttr<Bool>("fast-math-nnan").value_or(Bool(false));
+  Bool fast_math_ninf = target->GetAttr<Bool>("fast-math-ninf").value_or(Bool(false));
+  Bool fast_math_nsz = target->GetAttr<Bool>("fast-math-nsz").value_or(Bool(false));
+  Bool fast_math_arcp = target->GetAttr<Bool>("fast-math-arcp").value_or(Bool(false));
+
+  llvm::FastMathFlags fmf;
+  if (fast_math_all) {
+#if TVM_LLVM_VERSION >= 60
+    fmf.setFast();
+#else
+    fmf.setUnsafeAlgebra();
+#endif
+  }
+
+  if (fast_math_nnan) {
+    fmf.setNoNaNs();
+  }
+  if (fast_math_ninf) {
+    fmf.setNoInfs();
+  }
+  if (fast_math_nsz) {
+    fmf.setNoSignedZeros();
+  }
+  if (fast_math_arcp) {
+    fmf.setAllowReciprocal();
+  }
+
+#if TVM_LLVM_VERSION >= 60
+  Bool fast_math_contract = target->GetAttr<Bool>("fast-math-contract").value_or(Bool(false));
+  Bool fast_math_afn = target->GetAttr<Bool>("fast-math-afn").value_or(Bool(false));
+  Bool fast_math_reassoc = target->GetAttr<Bool>("fast-math-reassoc").value_or(Bool(false));
+  if (fast_math_contract) {
+    fmf.setAllowContract(true);
+  }
+  if (fast_math_afn) {
+    fmf.setApproxFunc();
+  }
+  if (fast_math_reassoc) {
+    fmf.setAllowReassoc();
+  }
+#endif
+  return fmf;
+}
+
 class LLVMModuleNode final : public runtime::ModuleNode {
  public:
   ~LLVMModuleNode() {
@@ -218,7 +272,6 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     bool system_lib = target->GetAttr<Bool>("system-lib").value_or(Bool(false));
     bool target_c_runtime = (target->GetAttr<String>("runtime").value_or("") == kTvmRuntimeCrt);
     ctx_ = std::make_shared<llvm::LLVMContext>();
-    std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm_.get());
 
     std::vector<PrimFunc> funcs;
     std::string entry_func;
@@ -254,65 +307,28 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     }
     // TODO(@jroesch): follow up on this condition.
     // ICHECK(funcs.size() > 0 || (could_have_linked_params && found_linked_params));
-    // TODO(tqchen): remove the entry function behavior as it does not
-    // makes sense when we start to use multiple modules.
-    cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
-
-    // See https://llvm.org/docs/LangRef.html#fast-math-flags for details
-    Bool fast_math_all = target->GetAttr<Bool>("fast-math").value_or(Bool(false));
-    Bool fast_math_nnan = target->GetAttr<Bool>("fast-math-nnan").value_or(Bool(false));
-    Bool fast_math_ninf = target->GetAttr<Bool>("fast-math-ninf").value_or(Bool(false));
-    Bool fast_math_nsz = target->GetAttr<Bool>("fast-math-nsz").value_or(Bool(false));
-    Bool fast_math_arcp = target->GetAttr<Bool>("fast-math-arcp").value_or(Bool(false));
-
-    llvm::FastMathFlags fmf;
-    if (fast_math_all) {
-#if TVM_LLVM_VERSION >= 60
-      fmf.setFast();
-#else
-      fmf.setUnsafeAlgebra();
-#endif
-    }
 
-    if (fast_math_nnan) {
-      fmf.setNoNaNs();
-    }
-    if (fast_math_ninf) {
-      fmf.setNoInfs();
-    }
-    if (fast_math_nsz) {
-      fmf.setNoSignedZeros();
-    }
-    if (fast_math_arcp) {
-      fmf.setAllowReciprocal();
-    }
-
-#if TVM_LLVM_VERSION >= 60
-    Bool fast_math_contract = target->GetAttr<Bool>("fast-math-contract").value_or(Bool(false));
-    Bool fast_math_afn = target->GetAttr<Bool>("fast-math-afn").value_or(Bool(false));
-    Bool fast_math_reassoc = target->GetAttr<Bool>("fast-math-reassoc").value_or(Bool(false));
-    if (fast_math_contract) {
-      fmf.setAllowContract(true);
-    }
-    if (fast_math_afn) {
-      fmf.setApproxFunc();
-    }
-    if (fast_math_reassoc) {
-      fmf.setAllowReassoc();
-    }
-#endif
-
-    cg->SetFastMathFlag(fmf);
-
-    cg->AddFunctionsOrdered(funcs.begin(), funcs.end());
-    if (entry_func.length() != 0) {
-      cg->AddMainFunction(entry_func);
-    }
+    // The system library and the CRT registry enumerate the functions of one LLVM module,
+    // they are generated on a single thread.
+    int num_shards = std::min<int>(GetNumBuildThreads(), funcs.size());
+    if (num_shards > 1 && !system_lib && !target_c_runtime && !found_linked_params) {
+      module_ = CodeGenShards(target, funcs, entry_func, num_shards);
+    } else {
+      std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm_.get());
+      // TODO(tqchen): remove the entry function behavior as it does not
+      // makes sense when we start to use multiple modules.
+      cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
+      cg->SetFastMathFlag(GetFastMathFlags(target));
+      cg->AddFunctionsOrdered(funcs.begin(), funcs.end());
+      if (entry_func.length() != 0) {
+        cg->AddMainFunction(entry_func);
+      }
 
-    if (found_linked_params) {
-      cg->LinkParameters(linked_params);
+      if (found_linked_params) {
+        cg->LinkParameters(linked_params);
+      }
+      module_ = cg->Finish();
     }
-    module_ = cg->Finish();
     module_->addModuleFlag(llvm::Module::Warning, "tvm_target",
                            llvm::MDString::get(*ctx_, LLVMTargetToString(target)));
     module_->addModuleFlag(llvm::Module::Override, "Debug Info Version",
@@ -371,6 +387,66 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   }
 
  private:
+  /*!
+   * \brief Generate and optimize the functions in num_shards LLVM modules, each in its own
+   *  context on its own thread, then link them into one module of ctx_.
+   */
+  std::unique_ptr<llvm::Module> CodeGenShards(const Target& target,
+                                              const std::vector<PrimFunc>& funcs,
+                                              const std::string& entry_func, int num_shards) {
+    // Shard by name so that the linked module does not depend on the map order.
+    std::vector<std::pair<std::string, PrimFunc>> sorted;
+    for (const PrimFunc& f : funcs) {
+      sorted.emplace_back(f->GetAttr<String>(tvm::attr::kGlobalSymbol).value(), f);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<std::vector<PrimFunc>> shards(num_shards);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+      shards[i % num_shards].push_back(sorted[i].second);
+    }
+    // The shards cross contexts as bitcode.
+    std::vector<std::string> bitcode(num_shards);
+    support::parallel_for_dynamic(0, num_shards, num_shards, [&](int /*thread_id*/, int i) {
+      llvm::LLVMContext ctx;
+      std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target);
+      std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm.get());
+      cg->Init("TVMMod", tm.get(), &ctx, false, false, false);
+      cg->SetFastMathFlag(GetFastMathFlags(target));
+      cg->AddFunctionsOrdered(shards[i].begin(), shards[i].end());
+      if (!entry_func.empty()) {
+        for (const PrimFunc& f : shards[i]) {
+          if (f->GetAttr<String>(tvm::attr::kGlobalSymbol).value() == entry_func) {
+            cg->AddMainFunction(entry_func);
+          }
+        }
+      }
+      std::unique_ptr<llvm::Module> module = cg->Finish();
+      llvm::raw_string_ostream os(bitcode[i]);
+#if TVM_LLVM_VERSION >= 70
+      llvm::WriteBitcodeToFile(*module, os);
+#else
+      llvm::WriteBitcodeToFile(module.get(), os);
+#endif
+      os.flush();
+    });
+
+    std::unique_ptr<llvm::Module> linked;
+    for (int i = 0; i < num_shards; ++i) {
+      auto module = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode[i], "TVMMod"), *ctx_);
+      if (!module) {
+        LOG(FATAL) << "Fail to load module shard: " << llvm::toString(module.takeError());
+      }
+      if (linked == nullptr) {
+        linked = std::move(module.get());
+      } else {
+        ICHECK(!llvm::Linker::linkModules(*linked, std::move(module.get())))
+            << "Failed to link module shards";
+      }
+    }
+    return linked;
+  }
+
   void LazyInitJIT() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (ee_) {
@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/bound_packed_call.h>
+
+#include "../../src/runtime/library_module.h"
+
+using namespace tvm::runtime;
+
+namespace {
+
+// out[0] = a[0] + b[0] over float32 DLTensors, returns the number of calls so far.
+int AddOne(TVMValue* args, int* type_codes, int num_args, TVMValue* ret_value,
+           int* ret_type_code, void* resource_handle) {
+  static int64_t num_calls = 0;
+  if (num_args != 3) return -1;
+  for (int i = 0; i < num_args; ++i) {
+    if (type_codes[i] != kTVMDLTensorHandle) return -1;
+  }
+  auto data = [&](int i) {
+    return static_cast<float*>(static_cast<DLTensor*>(args[i].v_handle)->data);
+  };
+  data(2)[0] = data(0)[0] + data(1)[0];
+  ret_value->v_int64 = ++num_calls;
+  *ret_type_code = kDLInt;
+  return 0;
+}
+
+DLTensor MakeScalar(float* data) {
+  static int64_t shape[1] = {1};
+  DLTensor tensor;
+  tensor.data = data;
+  tensor.device = Device{kDLCPU, 0};
+  tensor.ndim = 1;
+  tensor.dtype = DLDataType{kDLFloat, 32, 1};
+  tensor.shape = shape;
+  tensor.strides = nullptr;
+  tensor.byte_offset = 0;
+  return tensor;
+}
+
+}  // namespace
+
+TEST(BoundPackedCall, DirectCall) {
+  PackedFunc func = WrapPackedFunc(AddOne, ObjectPtr<Object>());
+  EXPECT_EQ(GetBackendPackedCFunc(func), AddOne);
+  float a = 1, b = 2, c = 0;
+  DLTensor ta = MakeScalar(&a), tb = MakeScalar(&b), tc = MakeScalar(&c);
+  BoundPackedCall call(func, 3);
+  ASSERT_TRUE(call.is_direct());
+  call.Set(0, &ta);
+  call.Set(1, &tb);
+  call.Set(2, &tc);
+  TVMRetValue rv;
+  call.Run(&rv);
+  EXPECT_EQ(c, 3);
+  int64_t first = rv;
+  // tensors refreshed in place are seen without setting the arguments again.
+  float d = 10;
+  tb.data = &d;
+  call.Run(&rv);
+  EXPECT_EQ(c, 11);
+  EXPECT_EQ(static_cast<int64_t>(rv), first + 1);
+}
+
+TEST(BoundPackedCall, Fallback) {
+  PackedFunc func([](TVMArgs args, TVMRetValue* rv) {
+    int64_t sum = 0;
+    for (int i = 0; i < args.size(); ++i) {
+      sum += args[i].operator int64_t();
+    }
+    *rv = sum;
+  });
+  EXPECT_EQ(GetBackendPackedCFunc(func), nullptr);
+  BoundPackedCall call(func, 2);
+  EXPECT_FALSE(call.is_direct());
+  call.Set(0, 1);
+  call.Set(1, 2);
+  TVMRetValue rv;
+  call.Run(&rv);
+  EXPECT_EQ(static_cast<int64_t>(rv), 3);
+  call.SetNumArgs(3);
+  call.Set(2, 4);
+  call.Run(&rv);
+  EXPECT_EQ(static_cast<int64_t>(rv), 7);
+}
+
+TEST(BoundPackedCall, MatchesPackedFunc) {
+  PackedFunc func = WrapPackedFunc(AddOne, ObjectPtr<Object>());
+  float a = 0, b = 2, c = 0;
+  DLTensor ta = MakeScalar(&a), tb = MakeScalar(&b), tc = MakeScalar(&c);
+  BoundPackedCall call(func, 3);
+  ASSERT_TRUE(call.is_direct());
+  call.Set(0, &ta);
+  call.Set(1, &tb);
+  call.Set(2, &tc);
+  for (int i = 0; i < 100; ++i) {
+    a = i;
+    c = 0;
+    TVMRetValue rv;
+    call.Run(&rv);
+    int64_t bound_calls = rv;
+    float bound = c;
+    c = 0;
+    int64_t packed_calls = func(&ta, &tb, &tc);
+    // both call the same function with the same arguments, one after the other
+    EXPECT_EQ(bound, i + 2);
+    EXPECT_EQ(c, bound);
+    EXPECT_EQ(packed_calls, bound_calls + 1);
+  }
+}
@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#ifdef USE_CSINN
+
+#include <tvm/runtime/logging.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../../src/runtime/hhb/hhb_params.h"
+
+using namespace tvm::runtime::hhb;
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+
+std::vector<char> ReadFile(const std::string& path) {
+  std::ifstream fs(path, std::ios::in | std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(fs), std::istreambuf_iterator<char>());
+}
+
+std::shared_ptr<char> Share(const std::vector<char>& content) {
+  std::shared_ptr<char> file(new char[content.size()], std::default_delete<char[]>());
+  memcpy(file.get(), content.data(), content.size());
+  return file;
+}
+
+// a float constant at offset 0 and an int8 constant at offset kAlignment
+std::string WriteParams(const std::string& file_name, bool compress) {
+  std::string path = ::testing::TempDir() + file_name;
+  std::vector<float> weight = {1, 2, 3, 4};
+  std::vector<int8_t> kernel(200, 7);
+  ParamsWriter writer(kAlignment);
+  writer.Add("weight", kParamsConstant, "float", 0, weight.data(), weight.size() * sizeof(float),
+             false);
+  writer.Add("kernel", kParamsConstant, "int8_t", kAlignment, kernel.data(), kernel.size(),
+             compress);
+  writer.Save(path, kAlignment + kernel.size());
+  return path;
+}
+
+void CheckData(const char* data, const ParamsIndex& index) {
+  ASSERT_EQ(index.entries.size(), 2U);
+  EXPECT_EQ(index.Find("weight"), 0);
+  EXPECT_EQ(index.Find("kernel"), 1);
+  EXPECT_EQ(index.Find("bias"), -1);
+  const float* weight = reinterpret_cast<const float*>(data);
+  EXPECT_EQ(std::vector<float>(weight, weight + 4), std::vector<float>({1, 2, 3, 4}));
+  for (size_t i = 0; i < 200; i++) {
+    EXPECT_EQ(data[kAlignment + i], 7);
+  }
+}
+
+}  // namespace
+
+TEST(HHBParams, RoundTrip) {
+  std::vector<char> content = ReadFile(WriteParams("hhb_params_plain.params", false));
+  ASSERT_TRUE(IsIndexedParams(content.data(), content.size()));
+  std::shared_ptr<char> file = Share(content);
+  ParamsIndex index;
+  std::shared_ptr<char> data = LoadIndexedParams(file, content.size(), true, &index);
+  // the data section is used in place, aligned for the generated code
+  EXPECT_GE(data.get(), file.get());
+  EXPECT_LT(data.get(), file.get() + content.size());
+  EXPECT_EQ((data.get() - file.get()) % kAlignment, 0U);
+  CheckData(data.get(), index);
+}
+
+TEST(HHBParams, Compressed) {
+  if (!ParamsCompressionEnabled()) {
+    GTEST_SKIP() << "TVM is built without USE_CSINN_ZLIB";
+  }
+  std::string plain_path = WriteParams("hhb_params_plain.params", false);
+  std::vector<char> content = ReadFile(WriteParams("hhb_params_packed.params", true));
+  EXPECT_LT(content.size(), ReadFile(plain_path).size());
+  ParamsIndex index;
+  std::shared_ptr<char> data = LoadIndexedParams(Share(content), content.size(), true, &index);
+  CheckData(data.get(), index);
+}
+
+TEST(HHBParams, Checksum) {
+  std::vector<char> content = ReadFile(WriteParams("hhb_params_plain.params", false));
+  // flip the last byte of the file, which belongs to the kernel
+  content[content.size() - 1] ^= 1;
+  ParamsIndex index;
+  EXPECT_THROW(LoadIndexedParams(Share(content), content.size(), true, &index),
+               tvm::runtime::InternalError);
+  // mapped files skip the check
+  EXPECT_NO_THROW(LoadIndexedParams(Share(content), content.size(), false, &index));
+  EXPECT_THROW(LoadIndexedParams(Share(content), content.size() - 1, false, &index),
+               tvm::runtime::InternalError);
+}
+
+TEST(HHBParams, Names) {
+  float value = 0;
+  ParamsWriter writer(kAlignment);
+  EXPECT_THROW(writer.Add("", kParamsConstant, "float", 0, &value, sizeof(value), false),
+               tvm::runtime::InternalError);
+  writer.Add("weight", kParamsConstant, "float", 0, &value, sizeof(value), false);
+  EXPECT_THROW(
+      writer.Add("weight", kParamsConstant, "float", kAlignment, &value, sizeof(value), false),
+      tvm::runtime::InternalError);
+}
+
+#endif  // USE_CSINN
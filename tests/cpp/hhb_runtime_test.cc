@@ -0,0 +1,291 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/container/array.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace tvm::runtime;
+
+namespace {
+
+constexpr int kLen = 4;
+constexpr int kRuns = 100;
+
+// Stands in for the library generated by the csinn ref codegen: out = in + params,
+// over float32 vectors of kLen elements. With layer_profile, it reports two layers
+// taking (k + 1) us each into the timing buffer of the call.
+class FakeModel : public ModuleNode {
+ public:
+  explicit FakeModel(bool layer_profile = false) : layer_profile_(layer_profile) {}
+
+  const char* type_key() const final { return "FakeHHBModel"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "csinn_runtime_wrapper_") {
+      bool layer_profile = layer_profile_;
+      return PackedFunc([layer_profile](TVMArgs args, TVMRetValue* rv) {
+        float* in = static_cast<float**>(args[0].operator void*())[0];
+        float* out = static_cast<float**>(args[1].operator void*())[0];
+        const float* params = static_cast<const float*>(args[2].operator void*());
+        for (int i = 0; i < kLen; i++) {
+          out[i] = in[i] + params[i];
+        }
+        if (layer_profile) {
+          ASSERT_EQ(args.num_args, 5);
+          int64_t* layer_time = static_cast<int64_t*>(args[4].operator void*());
+          for (int k = 0; layer_time != nullptr && k < 2; k++) {
+            layer_time[k] += (k + 1) * 1000;
+          }
+        }
+      });
+    } else if (name == "csinn_layer_info_" && layer_profile_) {
+      return PackedFunc([](TVMArgs args, TVMRetValue* rv) {
+        static const char* names[2] = {"conv", "relu"};
+        if (args.num_args < 2) {
+          *rv = 2;
+        } else if (args[1].operator int() == 0) {
+          *rv = static_cast<void*>(const_cast<char*>(names[args[0].operator int()]));
+        } else {
+          *rv = 0;
+        }
+      });
+    } else if (name == "csinn_io_info_") {
+      // one float32 input and one float32 output
+      return PackedFunc([](TVMArgs args, TVMRetValue* rv) {
+        if (args.num_args < 3) {
+          *rv = 1;
+          return;
+        }
+        int64_t info[3] = {kLen * static_cast<int64_t>(sizeof(float)), kDLFloat, 32};
+        *rv = info[args[2].operator int()];
+      });
+    }
+    return PackedFunc();
+  }
+
+ private:
+  bool layer_profile_;
+};
+
+// params[i] = scale * (i + 1)
+std::string WriteParams(int scale = 10) {
+  std::string path =
+      ::testing::TempDir() + "hhb_runtime_test_" + std::to_string(scale) + ".params";
+  float params[kLen];
+  for (int i = 0; i < kLen; i++) {
+    params[i] = scale * (i + 1);
+  }
+  FILE* fp = fopen(path.c_str(), "wb");
+  fwrite(params, sizeof(params), 1, fp);
+  fclose(fp);
+  return path;
+}
+
+Module CreateRuntime(bool layer_profile = false) {
+  const PackedFunc* fcreate = Registry::Get("tvm.hhb_runtime.create");
+  Module rt =
+      (*fcreate)(Module(make_object<FakeModel>(layer_profile)), static_cast<int>(kDLCPU), 0);
+  rt.GetFunction("set_params")(WriteParams());
+  return rt;
+}
+
+NDArray Vector(float start, int batch = 1) {
+  NDArray arr = NDArray::Empty({batch * kLen}, DLDataType{kDLFloat, 32, 1}, Device{kDLCPU, 0});
+  for (int i = 0; i < batch * kLen; i++) {
+    static_cast<float*>(arr->data)[i] = start + i;
+  }
+  return arr;
+}
+
+}  // namespace
+
+#define SKIP_WITHOUT_HHB_RUNTIME()                             \
+  if (Registry::Get("tvm.hhb_runtime.create") == nullptr) {   \
+    GTEST_SKIP() << "HHBRuntime is not built, need USE_CSINN"; \
+  }
+
+TEST(HHBRuntime, ZeroCopyByteOffset) {
+  SKIP_WITHOUT_HHB_RUNTIME();
+  Module rt = CreateRuntime();
+  // views into the middle of bigger buffers
+  std::vector<float> in = {-1, -1, 1, 2, 3, 4};
+  std::vector<float> out(kLen + 2, 0);
+  int64_t shape[1] = {kLen};
+  DLTensor in_view{in.data(), {kDLCPU, 0}, 1, {kDLFloat, 32, 1}, shape, nullptr,
+                   2 * sizeof(float)};
+  DLTensor out_view{out.data(), {kDLCPU, 0}, 1, {kDLFloat, 32, 1}, shape, nullptr,
+                    sizeof(float)};
+  rt.GetFunction("set_input_zero_copy")(0, &in_view);
+  rt.GetFunction("set_output_zero_copy")(0, &out_view);
+  rt.GetFunction("run")();
+  EXPECT_EQ(out, std::vector<float>({0, 11, 22, 33, 44, 0}));
+}
+
+TEST(HHBRuntime, MappedParams) {
+  SKIP_WITHOUT_HHB_RUNTIME();
+  Module rt = CreateRuntime();
+  // the model only reads the read-only mapping
+  rt.GetFunction("set_params")(WriteParams(100), true);
+  NDArray output = Vector(0);
+  rt.GetFunction("set_input")(0, Vector(1));
+  rt.GetFunction("set_output")(0, output);
+  rt.GetFunction("run")();
+  const float* out = static_cast<const float*>(output->data);
+  for (int k = 0; k < kLen; k++) {
+    EXPECT_EQ(out[k], 1 + k + (k + 1) * 100);
+  }
+}
+
+TEST(HHBRuntime, ZeroCopyChecks) {
+  SKIP_WITHOUT_HHB_RUNTIME();
+  Module rt = CreateRuntime();
+  PackedFunc set_input = rt.GetFunction("set_input_zero_copy");
+  std::vector<float> buf(2 * kLen);
+  int64_t shape[1] = {kLen};
+  int64_t short_shape[1] = {kLen - 1};
+  int64_t strides[1] = {2};
+  DLTensor good{buf.data(), {kDLCPU, 0}, 1, {kDLFloat, 32, 1}, shape, nullptr, 0};
+  set_input(0, &good);
+
+  DLTensor wrong_dtype = good;
+  wrong_dtype.dtype = DLDataType{kDLInt, 32, 1};
+  EXPECT_THROW(set_input(0, &wrong_dtype), Error);
+  DLTensor wrong_size = good;
+  wrong_size.shape = short_shape;
+  EXPECT_THROW(set_input(0, &wrong_size), Error);
+  DLTensor strided = good;
+  strided.strides = strides;
+  EXPECT_THROW(set_input(0, &strided), Error);
+  DLTensor on_gpu = good;
+  on_gpu.device = Device{kDLCUDA, 0};
+  EXPECT_THROW(set_input(0, &on_gpu), Error);
+  // the model has a single input
+  EXPECT_THROW(set_input(1, &good), Error);
+}
+
+TEST(HHBRuntime, ConcurrentSessions) {
+  SKIP_WITHOUT_HHB_RUNTIME();
+  Module rt = CreateRuntime();
+  const int kSessions = 4;
+  std::vector<Module> sessions = {rt};
+  for (int i = 1; i < kSessions; i++) {
+    sessions.push_back(rt.GetFunction("create_session")());
+  }
+  std::vector<NDArray> outputs;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kSessions; i++) {
+    NDArray input = Vector(i * 100);
+    NDArray output = Vector(0);
+    sessions[i].GetFunction("set_input")(0, input);
+    sessions[i].GetFunction("set_output")(0, output);
+    outputs.push_back(output);
+    PackedFunc run = sessions[i].GetFunction("run");
+    threads.emplace_back([run]() {
+      for (int k = 0; k < kRuns; k++) {
+        run();
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (int i = 0; i < kSessions; i++) {
+    const float* out = static_cast<const float*>(outputs[i]->data);
+    for (int k = 0; k < kLen; k++) {
+      EXPECT_EQ(out[k], i * 100 + k + (k + 1) * 10);
+    }
+  }
+}
+
+TEST(HHBRuntime, RunBatch) {
+  SKIP_WITHOUT_HHB_RUNTIME();
+  Module rt = CreateRuntime();
+  PackedFunc run_batch = rt.GetFunction("run_batch");
+  const int kBatch = 13;
+  NDArray input = Vector(0, kBatch);
+  NDArray output = Vector(0, kBatch);
+  auto check = [&](int scale) {
+    const float* out = static_cast<const float*>(output->data);
+    for (int i = 0; i < kBatch * kLen; i++) {
+      EXPECT_EQ(out[i], i + scale * (i % kLen + 1));
+    }
+  };
+  run_batch(Array<NDArray>{input}, Array<NDArray>{output}, kBatch);
+  check(10);
+
+  // the workers created by the first batch follow the new params
+  rt.GetFunction("set_params")(WriteParams(100));
+  run_batch(Array<NDArray>{input}, Array<NDArray>{output}, kBatch);
+  check(100);
+
+  // every array holds the batch times the model size
+  EXPECT_THROW(run_batch(Array<NDArray>{input}, Array<NDArray>{Vector(0, kBatch - 1)}, kBatch),
+               Error);
+  EXPECT_THROW(run_batch(Array<NDArray>{Vector(0, 2 * kBatch)}, Array<NDArray>{output}, kBatch),
+               Error);
+  EXPECT_THROW(run_batch(Array<NDArray>{}, Array<NDArray>{output}, kBatch), Error);
+}
+
+TEST(HHBRuntime, ProfileConcurrentSessions) {
+  SKIP_WITHOUT_HHB_RUNTIME();
+  Module rt = CreateRuntime(true);
+  std::vector<Module> sessions = {rt, rt.GetFunction("create_session")()};
+  std::vector<NDArray> outputs;
+  for (int i = 0; i < 2; i++) {
+    NDArray output = Vector(0);
+    sessions[i].GetFunction("set_input")(0, Vector(i * 100));
+    sessions[i].GetFunction("set_output")(0, output);
+    outputs.push_back(output);
+  }
+  // the first session profiles while the second one runs and profiles too
+  auto profile = [](Module sess) {
+    PackedFunc profile = sess.GetFunction("profile");
+    PackedFunc run = sess.GetFunction("run");
+    for (int k = 0; k < kRuns; k++) {
+      profiling::Report report = profile();
+      ASSERT_EQ(report->calls.size(), 2U);
+      for (int layer = 0; layer < 2; layer++) {
+        const auto* duration = report->calls[layer]["Duration (us)"].as<profiling::DurationNode>();
+        ASSERT_NE(duration, nullptr);
+        // every call times its own run only
+        EXPECT_EQ(duration->microseconds, layer + 1);
+      }
+      run();
+    }
+  };
+  std::thread first(profile, sessions[0]);
+  std::thread second(profile, sessions[1]);
+  first.join();
+  second.join();
+  for (int i = 0; i < 2; i++) {
+    const float* out = static_cast<const float*>(outputs[i]->data);
+    for (int k = 0; k < kLen; k++) {
+      EXPECT_EQ(out[k], i * 100 + k + (k + 1) * 10);
+    }
+  }
+}
@@ -0,0 +1,102 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#ifdef USE_CSINN
+
+#include <tvm/runtime/logging.h>
+
+#include <string>
+#include <vector>
+
+#include "../../../../src/relay/backend/contrib/csinn/memory_plan.h"
+
+using tvm::relay::contrib::ArenaPlanner;
+
+namespace {
+
+bool Overlap(const ArenaPlanner& planner, const std::string& a, size_t size_a,
+             const std::string& b, size_t size_b) {
+  size_t off_a = planner.GetOffset(a);
+  size_t off_b = planner.GetOffset(b);
+  return off_a < off_b + size_b && off_b < off_a + size_a;
+}
+
+}  // namespace
+
+TEST(CSINNArenaPlanner, ReuseAfterFree) {
+  ArenaPlanner planner(64);
+  // a -> b -> c, each layer frees its input once it has run
+  planner.Alloc("a", 1000, 0);
+  planner.Alloc("b", 1000, 1);
+  planner.Free("a", 1);
+  planner.Alloc("c", 1000, 2);
+  planner.Free("b", 2);
+  EXPECT_EQ(planner.Plan(), 2048U);
+  EXPECT_EQ(planner.TotalSize(), 3000U);
+  EXPECT_FALSE(Overlap(planner, "a", 1000, "b", 1000));
+  EXPECT_FALSE(Overlap(planner, "b", 1000, "c", 1000));
+  // a is dead once c is written
+  EXPECT_EQ(planner.GetOffset("a"), planner.GetOffset("c"));
+}
+
+TEST(CSINNArenaPlanner, LiveBuffersDoNotOverlap) {
+  ArenaPlanner planner(64);
+  std::vector<size_t> sizes = {100, 5000, 64, 700, 3000};
+  for (size_t i = 0; i < sizes.size(); i++) {
+    planner.Alloc("t" + std::to_string(i), sizes[i], i);
+  }
+  // never released, all live until the end
+  size_t arena = planner.Plan();
+  EXPECT_GE(arena, planner.TotalSize());
+  for (size_t i = 0; i < sizes.size(); i++) {
+    EXPECT_EQ(planner.GetOffset("t" + std::to_string(i)) % 64, 0U);
+    EXPECT_LE(planner.GetOffset("t" + std::to_string(i)) + sizes[i], arena);
+    for (size_t j = i + 1; j < sizes.size(); j++) {
+      EXPECT_FALSE(Overlap(planner, "t" + std::to_string(i), sizes[i], "t" + std::to_string(j),
+                           sizes[j]));
+    }
+  }
+}
+
+TEST(CSINNArenaPlanner, RemapSteps) {
+  ArenaPlanner planner(64);
+  planner.Alloc("a", 128, 0);
+  planner.Free("a", 1);
+  planner.Alloc("b", 128, 2);
+  planner.Free("b", 3);
+  // disjoint in emission order, reuse the same memory
+  ArenaPlanner in_order = planner;
+  EXPECT_EQ(in_order.Plan(), 128U);
+  // scheduled into one concurrent group, every statement at the same step
+  planner.RemapSteps({0, 0, 0, 0});
+  EXPECT_EQ(planner.Plan(), 256U);
+  EXPECT_FALSE(Overlap(planner, "a", 128, "b", 128));
+}
+
+TEST(CSINNArenaPlanner, Errors) {
+  ArenaPlanner planner;
+  planner.Alloc("a", 16, 3);
+  EXPECT_THROW(planner.Alloc("a", 16, 4), tvm::runtime::Error);
+  EXPECT_THROW(planner.Free("b", 4), tvm::runtime::Error);
+  EXPECT_THROW(planner.Free("a", 2), tvm::runtime::Error);
+}
+
+#endif  // USE_CSINN
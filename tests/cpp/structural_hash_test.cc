@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/node/structural_hash.h>
+#include <tvm/relay/expr.h>
+#include <tvm/relay/function.h>
+#include <tvm/relay/op.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+
+using namespace tvm;
+using namespace tvm::relay;
+
+namespace {
+
+// A stack of dense layers with their weights bound as constants.
+Function MakeMLP(int num_layers, int width) {
+  Var x("x", TensorType({1, width}, DataType::Float(32)));
+  Expr y = x;
+  for (int i = 0; i < num_layers; ++i) {
+    auto weight = runtime::NDArray::Empty({width, width}, {kDLFloat, 32, 1}, {kDLCPU, 0});
+    auto bias = runtime::NDArray::Empty({width}, {kDLFloat, 32, 1}, {kDLCPU, 0});
+    std::fill_n(static_cast<float*>(weight->data), width * width, 0.01f * i);
+    std::fill_n(static_cast<float*>(bias->data), width, 0.1f * i);
+    y = Call(Op::Get("nn.dense"), {y, Constant(weight)});
+    y = Call(Op::Get("nn.bias_add"), {y, Constant(bias)});
+    y = Call(Op::Get("nn.relu"), {y});
+  }
+  return Function({x}, y, Type(), {});
+}
+
+}  // namespace
+
+TEST(StructuralHashMemo, SameHash) {
+  Function func = MakeMLP(4, 64);
+  const auto* fhash = runtime::Registry::Get("node.StructuralHash");
+  size_t expected = StructuralHash()(func);
+  int64_t expected_mapped = (*fhash)(func, true);
+  StructuralHashMemo memo;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(StructuralHash()(func), expected);
+    int64_t mapped = (*fhash)(func, true);
+    EXPECT_EQ(mapped, expected_mapped);
+  }
+  // the constants and types are memoized, the calls and the variable are not.
+  EXPECT_GT(memo.size(), 0U);
+  {
+    StructuralHashMemo inner;
+    EXPECT_EQ(inner.size(), memo.size());
+  }
+  EXPECT_EQ(StructuralHash()(MakeMLP(4, 64)), expected);
+}
+
+TEST(StructuralHashMemo, CopyOnWrite) {
+  TensorType type({1, 64}, DataType::Float(32));
+  StructuralHashMemo memo;
+  size_t before = StructuralHash()(type);
+  // the memo references the node, so it is copied rather than changed in place.
+  const Object* node = type.get();
+  type.CopyOnWrite()->dtype = DataType::Float(16);
+  EXPECT_NE(type.get(), node);
+  size_t after = StructuralHash()(type);
+  EXPECT_NE(after, before);
+  EXPECT_EQ(after, StructuralHash()(TensorType({1, 64}, DataType::Float(16))));
+}
+
+TEST(StructuralHashMemo, RepeatedHashing) {
+  Function func = MakeMLP(12, 64);
+  size_t expected = StructuralHash()(func);
+  StructuralHashMemo memo;
+  EXPECT_EQ(StructuralHash()(func), expected);
+  size_t size = memo.size();
+  size_t hits = memo.hits();
+  EXPECT_GT(size, 0U);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(StructuralHash()(func), expected);
+    // the later hashes find the memoized nodes and memoize nothing new
+    EXPECT_EQ(memo.size(), size);
+    EXPECT_GT(memo.hits(), hits);
+    hits = memo.hits();
+  }
+}
@@ -19,6 +19,14 @@
 
 #include <gtest/gtest.h>
 #include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include <atomic>
 #include <memory>
@@ -63,3 +71,70 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
     }
   }
 }
+
+static FTVMParallelLambda nested_launch = [](int task_id, TVMParallelGroupEnv* penv,
+                                             void* cdata) -> int {
+  auto* data = reinterpret_cast<std::atomic<size_t>*>(cdata);
+  std::atomic<size_t> acc(0);
+  int ret = TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  data->fetch_add(acc.load(std::memory_order_relaxed), std::memory_order_relaxed);
+  return ret;
+};
+
+static FTVMParallelLambda barrier_task = [](int task_id, TVMParallelGroupEnv* penv,
+                                            void* cdata) -> int {
+  auto* arrived = reinterpret_cast<std::atomic<int>*>(cdata);
+  arrived->fetch_add(1);
+  TVMBackendParallelBarrier(task_id, penv);
+  // no task passes the barrier before all of them reached it
+  return arrived->load() == penv->num_task ? 0 : -1;
+};
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool_work_stealing");
+  const auto* stats = tvm::runtime::Registry::Get("runtime.threadpool_stealing_stats");
+  ASSERT_NE(config, nullptr);
+  (*config)(true, 8);
+
+  for (int num_task : {0, 1, 3, 64}) {
+    std::atomic<size_t> acc(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(atomic_add_task_id, &acc, num_task), 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  }
+
+  // nested launches run on the workers of the same pool
+  std::atomic<size_t> acc(0);
+  EXPECT_EQ(TVMBackendParallelLaunch(nested_launch, &acc, 4), 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), 4 * N * (N - 1) / 2);
+
+  // launches with more tasks than workers still meet at their barriers
+  for (int num_task : {0, 3, 32}) {
+    std::atomic<int> arrived(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(barrier_task, &arrived, num_task), 0);
+  }
+
+  tvm::runtime::profiling::Report report = (*stats)(true);
+  EXPECT_NE(report->calls.size(), 0);
+  (*config)(false);
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchSpecifiedCores) {
+  // a thread of its own, so the configuration stays with its thread pool
+  std::thread([]() {
+    const auto* config = tvm::runtime::Registry::Get("runtime.config_threadpool");
+    ASSERT_NE(config, nullptr);
+    (*config)(static_cast<int>(tvm::runtime::threading::ThreadGroup::kSpecifyOneCorePerThread), 1,
+              0);
+#if defined(__linux__)
+    // the calling thread runs task 0 on the given cores only
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    ASSERT_EQ(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset), 0);
+    EXPECT_EQ(CPU_COUNT(&cpuset), 1);
+    EXPECT_TRUE(CPU_ISSET(0, &cpuset));
+#endif
+    std::atomic<size_t> acc(0);
+    EXPECT_EQ(TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0), 0);
+    EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  }).join();
+}
@@ -0,0 +1,83 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/device_api.h>
+
+#include <cstring>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../../src/runtime/workspace_pool.h"
+
+using namespace tvm::runtime;
+
+TEST(WorkspacePool, SteadyStateReuse) {
+  Device dev{kDLCPU, 0};
+  WorkspacePool pool(kDLCPU, DeviceAPI::Get(dev));
+  std::vector<size_t> sizes = {1 << 20, 3000, 70000, 1 << 16, 123456};
+  for (int run = 0; run < 8; ++run) {
+    std::vector<void*> ptrs;
+    for (size_t size : sizes) {
+      ptrs.push_back(pool.AllocWorkspace(dev, size));
+      memset(ptrs.back(), run, size);
+    }
+    for (auto it = ptrs.rbegin(); it != ptrs.rend(); ++it) {
+      pool.FreeWorkspace(dev, *it);
+    }
+  }
+  WorkspacePool::Stats stats = pool.GetStats(dev);
+  EXPECT_EQ(stats.num_allocs, 8 * static_cast<int64_t>(sizes.size()));
+  // only the first run reaches the device API.
+  EXPECT_EQ(stats.num_device_allocs, static_cast<int64_t>(sizes.size()));
+  EXPECT_EQ(stats.in_use, 0);
+  EXPECT_GE(stats.peak_in_use, 1 << 20);
+  EXPECT_EQ(stats.peak_reserved, stats.reserved);
+}
+
+TEST(WorkspacePool, SplitAndCoalesce) {
+  Device dev{kDLCPU, 0};
+  WorkspacePool pool(kDLCPU, DeviceAPI::Get(dev));
+  std::mt19937 rng(0);
+  std::vector<std::pair<char*, size_t>> live;
+  for (int i = 0; i < 10000; ++i) {
+    if (live.size() < 16 && (live.empty() || rng() % 2)) {
+      size_t size = 1 + rng() % (1 << 18);
+      char* ptr = static_cast<char*>(pool.AllocWorkspace(dev, size));
+      for (const auto& other : live) {
+        ASSERT_TRUE(ptr + size <= other.first || other.first + other.second <= ptr);
+      }
+      memset(ptr, i, size);
+      live.emplace_back(ptr, size);
+    } else {
+      size_t index = rng() % live.size();
+      pool.FreeWorkspace(dev, live[index].first);
+      live.erase(live.begin() + index);
+    }
+  }
+  for (const auto& entry : live) {
+    pool.FreeWorkspace(dev, entry.first);
+  }
+  WorkspacePool::Stats stats = pool.GetStats(dev);
+  EXPECT_EQ(stats.in_use, 0);
+  EXPECT_LT(stats.num_device_allocs, stats.num_allocs / 10);
+  // freed chunks are given back before growing, so the pool stays near its high-water mark.
+  EXPECT_LE(stats.peak_reserved, 2 * stats.peak_in_use);
+}
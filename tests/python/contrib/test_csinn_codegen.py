@@ -0,0 +1,242 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Tests of the C code generated by the CSINN reference codegen."""
+import re
+import struct
+
+import numpy as np
+import pytest
+
+import tvm
+import tvm.testing
+import tvm.topi.testing
+from tvm import relay
+from tvm.contrib import utils
+
+# ACTIVATE, USE_MINMAX, PER_TENSOR, min, max
+QPARAMS = [1, 0, 0, -1.0, 1.0]
+
+requires_csinn = pytest.mark.skipif(
+    tvm.get_global_func("relay.ext.csinn", allow_missing=True) is None,
+    reason="CSINN codegen is not built, need USE_CSINN",
+)
+
+
+def _codegen(func, **options):
+    """Return the C source generated for func with the given csinn options."""
+    temp = utils.tempdir()
+    options.setdefault("target", "ref")
+    options.setdefault("params_path", temp.relpath(""))
+    func = relay.transform.InferType()(tvm.IRModule.from_expr(func))["main"]
+    with tvm.transform.PassContext(config={"relay.ext.csinn.options": options}):
+        mod = tvm.get_global_func("relay.ext.csinn")(func, tvm.target.Target("c"), "")
+    return mod.get_source()
+
+
+def _branches():
+    """x -> (relu, relu) -> add, the two relus are independent."""
+    x = relay.var("x", shape=(1, 4, 8, 8), dtype="float32")
+    left = relay.qnn.op.csi_relu(x, "float32", [QPARAMS, QPARAMS], layer_name="left")
+    right = relay.qnn.op.csi_relu(x, "float32", [QPARAMS, QPARAMS], layer_name="right")
+    out = relay.qnn.op.csi_add(left, right, [QPARAMS, QPARAMS, QPARAMS], layer_name="sum")
+    return relay.Function([x], out)
+
+
+@requires_csinn
+def test_parallel_layers():
+    source = _codegen(_branches(), parallel_layer_threads=2)
+    pragma = "#pragma omp parallel sections num_threads(2)"
+    assert source.count(pragma) == 1
+    # the second section runs on a session of its own
+    assert "sess_1 = csi_alloc_session();" in source
+    assert "->base.sess = sess_1;" in source
+
+    group = source[source.index(pragma) :]
+    group = group[: group.index("csi_add(")]
+    assert group.count("#pragma omp section\n") == 2
+    assert group.count("csi_relu(") == 2
+    # the add reads both relus, the inputs are only freed after it
+    free_at = source.find("csi_mem_free(", source.index(pragma))
+    assert free_at == -1 or free_at > source.index("csi_add(")
+
+
+@requires_csinn
+@pytest.mark.parametrize("threads", [0, 1])
+def test_layers_in_order(threads):
+    source = _codegen(_branches(), parallel_layer_threads=threads)
+    assert "#pragma omp" not in source
+    assert "sess_1" not in source
+    assert source.index("csi_relu(") < source.index("csi_add(")
+
+
+@requires_csinn
+def test_chain_not_parallel():
+    """Layers depending on each other never share a group."""
+    x = relay.var("x", shape=(1, 4, 8, 8), dtype="float32")
+    y = relay.qnn.op.csi_relu(x, "float32", [QPARAMS, QPARAMS], layer_name="first")
+    y = relay.qnn.op.csi_relu(y, "float32", [QPARAMS, QPARAMS], layer_name="second")
+    source = _codegen(relay.Function([x], y), parallel_layer_threads=2)
+    assert "#pragma omp" not in source
+
+
+def _c_function(source, signature):
+    """The text of the function of source starting with signature."""
+    func = source[source.index(signature) :]
+    return func[: func.index("\n}\n")]
+
+
+@requires_csinn
+@pytest.mark.parametrize("threads", [1, 2])
+def test_static_plan_setup_once(threads):
+    """With a static memory plan the runs reuse the sessions and tensors of the first run."""
+    source = _codegen(_branches(), static_memory_plan=True, parallel_layer_threads=threads)
+    func_id = re.search(r"static void (\w+)_setup_\(", source).group(1)
+    setup = _c_function(source, "static void %s_setup_(" % func_id)
+    assert "csi_alloc_session()" in setup
+    assert "csi_alloc_tensor(sess)" in setup
+    if threads > 1:
+        assert "sess_1 = csi_alloc_session();" in setup
+
+    run = _c_function(source, "void *%s_(" % func_id)
+    assert "%s_setup_(state_, params_base);" % func_id in run
+    wrapper = _c_function(source, "int %s_runtime_wrapper_(" % func_id)
+    # the conversion tensors of the wrapper are created under the same condition
+    wrapper = re.sub(
+        r"if \(io_state_->params_base != params_base\) \{.*?\n  \}\n", "", wrapper, flags=re.S
+    )
+    for body in (run, wrapper):
+        assert "csi_alloc_session" not in body
+        assert "csi_alloc_tensor" not in body
+        assert "csi_mem_free" not in body
+        assert "malloc(" not in body
+
+
+def _indexed_constants(path):
+    """Return the float constants of an uncompressed indexed params file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    assert data[:8] == b"HHBPARAM"
+    num_entries = struct.unpack_from("<I", data, 12)[0]
+    constants = []
+    for i in range(num_entries):
+        _, size, file_offset, _, kind, codec = struct.unpack_from("<QQQQII", data, 48 + 64 * i)
+        if kind == 1:
+            assert codec == 0
+            constants.append(np.frombuffer(data, "float32", size // 4, file_offset))
+    return constants, len(data)
+
+
+def _unpack_kernel(packed, m, k, packn):
+    """The [m, k] kernel read back from the layout of the c906/c908 GEMM kernels.
+
+    The rows are taken packn at a time, then the tails in blocks of packn / 2, ..., 1,
+    and every block is stored column by column, one vector load per column.
+    """
+    kernel = np.zeros((m, k), packed.dtype)
+    row, pos, block = 0, 0, packn
+    while block > 0:
+        while row + block <= m:
+            kernel[row : row + block] = packed[pos : pos + block * k].reshape(k, block).T
+            row, pos = row + block, pos + block * k
+        block //= 2
+    assert pos == packed.size
+    return kernel
+
+
+def _conv2d_model(shape, weight):
+    x = relay.var("x", shape=shape, dtype="float32")
+    out = relay.qnn.op.csi_conv2d(
+        x,
+        relay.const(weight),
+        relay.const(np.zeros(weight.shape[0], "float32")),
+        strides=[1, 1],
+        padding=[0, 0, 0, 0],
+        dilation=[1, 1],
+        groups=1,
+        channels=weight.shape[0],
+        kernel_size=list(weight.shape[2:]),
+        data_layout="NCHW",
+        kernel_layout="OIHW",
+        out_layout="",
+        out_dtype="float32",
+        q_params=[QPARAMS] * 4,
+        layer_name="conv",
+    )
+    return relay.Function([x], out)
+
+
+def _conv2d_as_gemm(data, kernel, kernel_shape):
+    """The output of the im2col GEMM over an [m, k] kernel, as the library computes it."""
+    _, channels, kh, kw = kernel_shape
+    oh, ow = data.shape[2] - kh + 1, data.shape[3] - kw + 1
+    cols = np.stack(
+        [
+            data[0, c, i : i + oh, j : j + ow].flatten()
+            for c in range(channels)
+            for i in range(kh)
+            for j in range(kw)
+        ]
+    )
+    return (kernel @ cols).reshape(1, kernel_shape[0], oh, ow)
+
+
+@requires_csinn
+def test_prepack_conv2d_kernel():
+    shape, wshape = (1, 3, 6, 6), (10, 3, 3, 3)
+    weight = np.random.uniform(-1, 1, wshape).astype("float32")
+    func = _conv2d_model(shape, weight)
+    temp = utils.tempdir()
+
+    def codegen(prepack):
+        path = temp.relpath("prepack_%d.params" % prepack)
+        source = _codegen(
+            func,
+            target="c906",
+            params_path=path,
+            params_format="indexed",
+            dtype_input="float32",
+            dtype_weight="float32",
+            dtype_activation="float32",
+            prepack_weights=prepack,
+        )
+        kernels = [c for c in _indexed_constants(path)[0] if c.size == weight.size]
+        return source, kernels
+
+    plain_source, plain = codegen(False)
+    packed_source, packed = codegen(True)
+    assert "kernel_tm" not in plain_source
+    assert re.search(r"->conv_extra.kernel_tm = kernel_\d+_tm;", packed_source)
+    assert "->conv_extra.conv_mode = CSINN_GEMM" in packed_source
+    # the kernel is kept as it is for the paths of the library reading it as OIHW
+    assert len(plain) == 1 and len(packed) == 2
+    np.testing.assert_array_equal(plain[0], weight.flatten())
+    np.testing.assert_array_equal(packed[0], weight.flatten())
+
+    # fp32 on the 128 bit vector registers of the c906: blocks of 4 rows, then 2
+    kernel = _unpack_kernel(packed[1], wshape[0], weight[0].size, 4)
+    np.testing.assert_array_equal(kernel, weight.reshape(wshape[0], -1))
+    data = np.random.uniform(-1, 1, shape).astype("float32")
+    tvm.testing.assert_allclose(
+        _conv2d_as_gemm(data, kernel, wshape),
+        tvm.topi.testing.conv2d_nchw_python(data, weight, 1, 0),
+        rtol=1e-5,
+        atol=1e-5,
+    )
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
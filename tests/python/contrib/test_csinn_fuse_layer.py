@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Tests of the CSINN layer fusion on Relay."""
+import numpy as np
+import pytest
+
+import tvm
+from tvm import relay
+
+# ACTIVATE, USE_MINMAX, PER_TENSOR, min, max
+QPARAMS = [1, 0, 0, -1.0, 1.0]
+
+requires_csinn = pytest.mark.skipif(
+    tvm.get_global_func("relay.ext.csinn", allow_missing=True) is None,
+    reason="CSINN codegen is not built, need USE_CSINN",
+)
+
+
+def _conv(x):
+    return relay.qnn.op.csi_conv2d(
+        x,
+        relay.const(np.ones((4, 4, 3, 3), "float32")),
+        relay.const(np.zeros(4, "float32")),
+        strides=[1, 1],
+        padding=[1, 1, 1, 1],
+        dilation=[1, 1],
+        groups=1,
+        channels=4,
+        kernel_size=[3, 3],
+        data_layout="NCHW",
+        kernel_layout="OIHW",
+        out_layout="",
+        out_dtype="float32",
+        q_params=[QPARAMS] * 4,
+        layer_name="conv",
+    )
+
+
+def _clip(x, a_max):
+    return relay.qnn.op.csi_clip(x, 0.0, a_max, "float32", [QPARAMS, QPARAMS], layer_name="clip")
+
+
+def _fuse(out):
+    # pylint: disable=import-outside-toplevel
+    from tvm.relay.quantize._convert_to_csi import fuse_layer
+
+    x = relay.analysis.free_vars(out)
+    mod = tvm.IRModule.from_expr(relay.Function(x, out))
+    mod = relay.transform.InferType()(mod)
+    options = {"fuse_conv_relu": True}
+    with tvm.transform.PassContext(config={"relay.ext.csinn.options": options}):
+        mod = fuse_layer(mod)
+    ops = []
+    relay.analysis.post_order_visit(
+        mod["main"], lambda e: ops.append(e.op.name) if isinstance(e, relay.Call) else None
+    )
+    return ops
+
+
+@requires_csinn
+@pytest.mark.parametrize(
+    "a_max,fused",
+    [(6.0, "qnn.csi.conv2d_relu6"), (float(np.finfo("float32").max), "qnn.csi.conv2d_relu")],
+)
+def test_fuse_conv_clip(a_max, fused):
+    x = relay.var("x", shape=(1, 4, 8, 8), dtype="float32")
+    assert _fuse(_clip(_conv(x), a_max)) == [fused]
+
+
+@requires_csinn
+def test_fuse_conv_clip_other_bounds():
+    x = relay.var("x", shape=(1, 4, 8, 8), dtype="float32")
+    assert _fuse(_clip(_conv(x), 4.0)) == ["qnn.csi.conv2d", "qnn.csi.clip"]
+
+
+@requires_csinn
+def test_fuse_conv_shared_output():
+    """A conv read by the clip and by another layer keeps its own output."""
+    x = relay.var("x", shape=(1, 4, 8, 8), dtype="float32")
+    conv = _conv(x)
+    out = relay.qnn.op.csi_add(conv, _clip(conv, 6.0), [QPARAMS] * 3, layer_name="add")
+    assert sorted(_fuse(out)) == ["qnn.csi.add", "qnn.csi.clip", "qnn.csi.conv2d"]
+
+    # the conv is also an output of the function
+    out = relay.Tuple([conv, _clip(conv, 6.0)])
+    assert "qnn.csi.conv2d_relu6" not in _fuse(out)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
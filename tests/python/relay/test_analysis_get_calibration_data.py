@@ -21,7 +21,8 @@ import tvm
 import tvm.relay.testing
 from tvm import relay
 from tvm.relay import transform
-from tvm.relay.analysis import get_calibration_data
+from tvm.relay.analysis import get_calibration_data, get_calibration_stats
+from tvm.relay.quantize.kl_divergence import _find_scale_by_kl
 
 
 def check_data_size(mod, data):
@@ -84,6 +85,62 @@ def test_simple_graph():
     tvm.testing.assert_allclose(data[g1]["outputs"][0].numpy(), x_data + y_data - z_data)
 
 
+def test_calibration_stats():
+    mod = tvm.IRModule()
+
+    x0 = relay.var("x0", shape=(8, 8))
+    y0 = relay.var("y0", shape=(8, 8))
+    f0 = relay.Function([x0, y0], x0 - y0)
+    f0 = f0.with_attr("Compiler", "test_graph")
+    g0 = relay.GlobalVar("g0")
+    mod[g0] = f0
+    mod = relay.transform.InferType()(mod)
+
+    x = relay.var("x", shape=(8, 8))
+    y = relay.var("y", shape=(8, 8))
+    mod["main"] = relay.Function([x, y], relay.Call(g0, [x, y]))
+    mod = relay.transform.InferType()(mod)
+
+    dataset = []
+    for scale in [1, 4, 16]:
+        dataset.append(
+            {
+                "x": np.random.uniform(-scale, scale, (8, 8)).astype("float32"),
+                "y": np.random.uniform(-scale, scale, (8, 8)).astype("float32"),
+            }
+        )
+    stats = get_calibration_stats(mod, dataset, num_bins=1025, num_workers=2, batch_size=2)
+
+    outputs = np.stack([d["x"] - d["y"] for d in dataset])
+    xs = np.stack([d["x"] for d in dataset])
+    tvm.testing.assert_allclose(stats[g0]["inputs"][0]["min"], xs.min())
+    tvm.testing.assert_allclose(stats[g0]["inputs"][0]["max"], xs.max())
+    tvm.testing.assert_allclose(stats[g0]["outputs"][0]["min"], outputs.min())
+    tvm.testing.assert_allclose(stats[g0]["outputs"][0]["max"], outputs.max())
+
+
+def test_calibration_stats_kl():
+    x = relay.var("x", shape=(16, 16))
+    y = relay.var("y", shape=(16, 16))
+    f0 = relay.Function([x], relay.nn.relu(x)).with_attr("Compiler", "test_graph")
+    g0 = relay.GlobalVar("g0")
+    mod = tvm.IRModule()
+    mod[g0] = f0
+    mod["main"] = relay.Function([y], relay.Call(g0, [y]))
+    mod = relay.transform.InferType()(mod)
+
+    # every sample reaches the same absolute max, so the histogram is the one of
+    # all samples whichever worker runs first
+    rng = np.random.RandomState(0)
+    xs = rng.normal(0, 1, (6, 16, 16)).clip(-3, 3).astype("float32")
+    xs[:, 0, 0] = 3
+    dataset = [{"y": x} for x in xs]
+    stats = get_calibration_stats(mod, dataset, num_bins=1025, num_workers=3, batch_size=4)
+
+    _, expected = _find_scale_by_kl(xs, num_bins=1025, num_quantized_bins=255)
+    tvm.testing.assert_allclose(stats[g0]["inputs"][0]["threshold"], expected, rtol=1e-5)
+
+
 def test_mobilenet_dnnl():
     if not tvm.get_global_func("relay.ext.dnnl", True):
         print("skip because DNNL codegen is not available")
@@ -106,4 +163,6 @@ def test_mobilenet_dnnl():
 
 if __name__ == "__main__":
     test_simple_graph()
+    test_calibration_stats()
+    test_calibration_stats_kl()
     test_mobilenet_dnnl()
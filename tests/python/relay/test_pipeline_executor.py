@@ -78,6 +78,7 @@ def get_manual_conf(mods, target):
     # is for mod2 input.
     pipe_config1 = {
         "mod_idx": 0,
+        "input": [{"global_input_name": "data_0", "input_name": "data_0"}],
         "output": [
             {"output_idx": 0, "dependencies": [{"mod_idx": 1, "input_name": "data_0"}]},
             {"output_idx": 1, "dependencies": [{"mod_idx": 2, "input_name": "data_0"}]},
@@ -96,6 +97,7 @@ def get_manual_conf(mods, target):
 
     pipe_config2 = {
         "mod_idx": 1,
+        "input": [{"global_input_name": "data_1", "input_name": "data_1"}],
         "output": [
             {"output_idx": 0, "dependencies": [{"mod_idx": 2, "input_name": "data_1"}]},
         ],
@@ -112,6 +114,7 @@ def get_manual_conf(mods, target):
 
     pipe_config3 = {
         "mod_idx": 2,
+        "input": [],
         "output": [{"output_idx": 0, "dependencies": [{"global_output_index": 1}]}],
     }
     mod_config[mods[2]] = {
@@ -249,6 +252,19 @@ def test_pipeline():
             pipeline_module_test = pipeline_executor.PipelineModule.load_library(config_file_name)
             assert pipeline_module_test.num_outputs == 2
 
+            # Feed all the requests before fetching any output, the modules overlap.
+            for data in datas:
+                pipeline_module.run(data_0=data, data_1=data)
+            assert pipeline_module.num_pending == len(datas)
+            for data in datas:
+                outputs = pipeline_module.get_output()
+                tvm.testing.assert_allclose(outputs[0].numpy(), data * 3)
+                tvm.testing.assert_allclose(
+                    outputs[1].numpy(), (data + 1 + 2 + data + 3) * 3 + (data - 2)
+                )
+            assert pipeline_module.num_pending == 0
+            assert "mod2" in pipeline_module.get_statistics().table()
+
 
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -14,6 +14,8 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import os
+
 import numpy as np
 import tvm
 from tvm import te
@@ -21,6 +23,7 @@ import tvm.testing
 from tvm import relay
 from tvm import autotvm
 from tvm import topi
+from tvm.contrib import graph_executor, utils
 from tvm.relay.backend import te_compiler
 from tvm.relay.testing import run_infer_type
 from tvm.relay.testing.temp_op_attr import TempOpAttr
@@ -261,6 +264,77 @@ def test_compile_nhwc_pack():
     relay.build(mod, target="llvm")
 
 
+@tvm.testing.requires_llvm
+def test_compile_parallel_build():
+    data = relay.var("data", shape=(1, 8, 16, 16))
+    out = data
+    for i in range(4):
+        weight = relay.const(np.random.uniform(size=(8, 8, 3, 3)).astype("float32"))
+        out = relay.nn.relu(relay.nn.conv2d(out, weight, padding=(i % 2, i % 2)))
+    out = relay.nn.dense(relay.nn.batch_flatten(out), relay.var("w", shape=(10, 8 * 12 * 12)))
+    mod = tvm.IRModule.from_expr(relay.Function(relay.analysis.free_vars(out), out))
+    inputs = {
+        "data": np.random.uniform(size=(1, 8, 16, 16)).astype("float32"),
+        "w": np.random.uniform(size=(10, 8 * 12 * 12)).astype("float32"),
+    }
+
+    def build_and_run(config):
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            lib = relay.build(mod, target="llvm")
+        m = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+        m.run(**inputs)
+        return lib.get_graph_json(), m.get_output(0).numpy()
+
+    serial_graph, serial_out = build_and_run({})
+    parallel_graph, parallel_out = build_and_run({"tir.num_build_threads": 4})
+    # the functions are named in the same order either way.
+    assert serial_graph == parallel_graph
+    tvm.testing.assert_allclose(serial_out, parallel_out, rtol=1e-5)
+
+
+@tvm.testing.requires_llvm
+def test_compile_disk_cache():
+    data = relay.var("data", shape=(1, 4, 8, 8))
+    weight = relay.var("weight", shape=(4, 4, 3, 3))
+    out = relay.nn.relu(relay.nn.conv2d(data, weight, padding=(1, 1)))
+    out = relay.nn.softmax(relay.nn.batch_flatten(out))
+    mod = tvm.IRModule.from_expr(relay.Function([data, weight], out))
+    inputs = {
+        "data": np.random.uniform(size=(1, 4, 8, 8)).astype("float32"),
+        "weight": np.random.uniform(size=(4, 4, 3, 3)).astype("float32"),
+    }
+    cache_dir = utils.tempdir().relpath("compile_cache")
+
+    def build_and_run():
+        config = {"relay.backend.compile_cache_dir": cache_dir}
+        with tvm.transform.PassContext(opt_level=3, config=config):
+            lib = relay.build(mod, target="llvm")
+        m = graph_executor.GraphModule(lib["default"](tvm.cpu()))
+        m.run(**inputs)
+        return lib.get_graph_json(), m.get_output(0).numpy()
+
+    def list_entries():
+        names = os.listdir(cache_dir)
+        return {name: os.stat(os.path.join(cache_dir, name)).st_mtime_ns for name in names}
+
+    graph, out = build_and_run()
+    entries = list_entries()
+    assert len(entries) > 0
+    cached_graph, cached_out = build_and_run()
+    # the second build only reads the cache.
+    assert entries == list_entries()
+    assert graph == cached_graph
+    tvm.testing.assert_allclose(out, cached_out, rtol=1e-5)
+
+    # builds applying tuning records neither read nor write the cache.
+    for name in os.listdir(cache_dir):
+        os.remove(os.path.join(cache_dir, name))
+    with autotvm.apply_history_best([]):
+        _, tuned_out = build_and_run()
+    assert list_entries() == {}
+    tvm.testing.assert_allclose(out, tuned_out, rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_get_valid_implementations()
     test_select_implementation()
@@ -270,3 +344,5 @@ if __name__ == "__main__":
     test_compile_tuple_dup()
     test_compile_full()
     test_compile_nhwc_pack()
+    test_compile_parallel_build()
+    test_compile_disk_cache()
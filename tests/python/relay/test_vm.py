@@ -781,6 +781,27 @@ def test_vm_reshape_and_copy(target, dev):
     check_result(target, dev, [x_np], x_np.reshape([1, 1]), mod)
 
 
+def test_vm_static_memory_plan(target, dev):
+    """The intermediates of a static chain are packed into one arena and reuse its bytes,
+    while the returned tensor keeps its own storage."""
+    x_np = np.random.uniform(size=(4, 16)).astype("float32")
+    x = relay.var("x", shape=(4, 16), dtype="float32")
+    y = relay.exp(relay.subtract(relay.multiply(relay.add(x, x), x), x))
+    mod = tvm.IRModule.from_expr(relay.Function([x], relay.negative(y)))
+    expected = -np.exp((x_np + x_np) * x_np - x_np)
+
+    config = {"relay.vm.static_memory_plan": True}
+    with tvm.transform.PassContext(opt_level=3, config=config, disabled_pass=["FuseOps"]):
+        exe = relay.vm.compile(mod, target)
+    with tvm.transform.PassContext(opt_level=3, disabled_pass=["FuseOps"]):
+        exe_ref = relay.vm.compile(mod, target)
+    assert exe.bytecode.count("alloc_storage") == 2
+    assert exe_ref.bytecode.count("alloc_storage") == 5
+
+    vm = runtime.vm.VirtualMachine(exe, dev)
+    tvm.testing.assert_allclose(vm.invoke("main", x_np).numpy(), expected, rtol=1e-5)
+
+
 def test_vm_reshape_tuple(target, dev, x_shape=(1, 4, 2), y_shape=(1, 2, 10)):
     tup = relay.var(
         "tup",
@@ -154,6 +154,29 @@ def test_const():
     tvm.testing.assert_allclose(res.numpy(), x_data + 1)
 
 
+def test_constants_mapped():
+    w_data = np.random.rand(256, 64).astype("float32")
+    b_data = np.random.rand(256).astype("float32")
+    x = relay.var("x", shape=(4, 64), dtype="float32")
+    y = relay.nn.bias_add(relay.nn.dense(x, relay.const(w_data)), relay.const(b_data))
+    f = relay.Function([x], y)
+    x_data = np.random.rand(4, 64).astype("float32")
+
+    exe = create_exec(f)
+    tmp = utils.tempdir()
+    path_consts = tmp.relpath("consts.bin")
+    exe.save_constants_mapped(path_consts)
+    code, lib = exe.save()
+    # the constant data is left out of the executable
+    assert len(code) < w_data.nbytes
+
+    des_exec = _vm.Executable.load_exec(code, lib)
+    des_exec.load_constants_mapped(path_consts)
+    des_vm = _vm.VirtualMachine(des_exec, tvm.cpu())
+    res = des_vm.run(x_data)
+    tvm.testing.assert_allclose(res.numpy(), x_data.dot(w_data.T) + b_data, rtol=1e-5)
+
+
 def test_if():
     x = relay.var("x", shape=(10, 10))
     y = relay.var("y", shape=(10, 10))
@@ -154,6 +154,98 @@ def test_pass_config():
         cfg = tvm.transform.PassContext(config={"tir.UnrollLoop": 1})
 
 
+def test_saveload_binary():
+    import numpy as np
+    from tvm import relay
+
+    x = relay.var("x", shape=(1, 64))
+    weight = np.random.uniform(size=(64, 64)).astype("float32")
+    bias = np.random.randint(-8, 8, size=(64,)).astype("int8")
+    y = relay.nn.dense(x, relay.const(weight))
+    y = relay.nn.bias_add(y, relay.cast(relay.const(bias), "float32"))
+    y = relay.nn.softmax(relay.nn.relu(y), axis=-1)
+    mod = relay.transform.InferType()(tvm.IRModule.from_expr(relay.Function([x], y)))
+    value = tvm.runtime.convert(
+        {"mod": mod, "attrs": {"inf": tvm.tir.const(float("inf"), "float64"), "s": "str"}}
+    )
+
+    blob = tvm.ir.save_binary(value)
+    loaded = tvm.ir.load_binary(blob)
+    tvm.ir.assert_structural_equal(loaded, value)
+    tvm.ir.assert_structural_equal(loaded, tvm.ir.load_json(tvm.ir.save_json(value)))
+    # the constants are stored raw rather than base64 encoded.
+    assert len(blob) < len(tvm.ir.save_json(value))
+    with pytest.raises(tvm.error.TVMError):
+        tvm.ir.load_binary(blob[: len(blob) // 2])
+
+    # tir, with variables shared across the function.
+    n = te.var("n")
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] * 2.0, name="B")
+    func = tvm.lower(te.create_schedule(B.op), [A, B])["main"]
+    tvm.ir.assert_structural_equal(tvm.ir.load_binary(tvm.ir.save_binary(func)), func)
+
+
+def _binary_index_counts(blob):
+    """Return the offsets of the node count and of the value count of the first object."""
+    import struct
+
+    def skip_strings(pos, depth):
+        (count,) = struct.unpack_from("<Q", blob, pos)
+        pos += 8
+        for _ in range(count):
+            if depth == 0:
+                pos += 8 + struct.unpack_from("<Q", blob, pos)[0]
+            else:
+                pos = skip_strings(pos, depth - 1)
+        return pos
+
+    # magic, index size, version, root, type keys and field names
+    pos = 16
+    pos += 8 + struct.unpack_from("<Q", blob, pos)[0] + 8
+    pos = skip_strings(pos, 0)
+    pos = skip_strings(pos, 1)
+    n_nodes = pos
+    pos += 8
+    while blob[pos] == 0:
+        pos += 1
+    # kind and type of an object, then its values
+    assert blob[pos] == 5
+    return n_nodes, pos + 5
+
+
+def test_load_binary_file():
+    import struct
+    import numpy as np
+    from tvm import relay
+    from tvm.contrib import utils
+
+    weight = np.random.uniform(size=(64, 64)).astype("float32")
+    value = tvm.runtime.convert({"w": relay.const(weight), "n": tvm.tir.const(3, "int64")})
+    temp = utils.tempdir()
+    path = temp.relpath("value.bin")
+    blob = bytes(tvm.ir.save_binary(value))
+    with open(path, "wb") as f:
+        f.write(blob)
+    loaded = tvm.ir.load_binary_file(path)
+    tvm.ir.assert_structural_equal(loaded, value)
+    np.testing.assert_array_equal(loaded["w"].data.numpy(), weight)
+    # the mapped constants are aligned like any other allocation
+    assert loaded["w"].data.handle.contents.data % 128 == 0
+
+    # counts beyond the size of the index are rejected before anything is allocated
+    n_nodes, num_values = _binary_index_counts(bytes(tvm.ir.save_binary(tvm.tir.const(1))))
+    for offset in [n_nodes, num_values]:
+        corrupt = bytearray(tvm.ir.save_binary(tvm.tir.const(1)))
+        struct.pack_into("<Q", corrupt, offset, 1 << 60)
+        with open(path, "wb") as f:
+            f.write(corrupt)
+        with pytest.raises(tvm.error.TVMError):
+            tvm.ir.load_binary_file(path)
+        with pytest.raises(tvm.error.TVMError):
+            tvm.ir.load_binary(corrupt)
+
+
 def test_dict():
     x = tvm.tir.const(1)  # a class that has Python-defined methods
     # instances should see the full class dict
@@ -166,6 +258,8 @@ if __name__ == "__main__":
     test_make_node()
     test_make_smap()
     test_const_saveload_json()
+    test_saveload_binary()
+    test_load_binary_file()
     test_make_sum()
     test_pass_config()
     test_dict()
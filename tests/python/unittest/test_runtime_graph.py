@@ -19,6 +19,11 @@ import tvm.testing
 from tvm import te, runtime
 import numpy as np
 import json
+import os
+import struct
+import time
+
+import pytest
 from tvm import rpc
 from tvm import relay
 from tvm.contrib import utils, graph_executor
@@ -80,6 +85,9 @@ def test_graph_simple():
         out = tvm.nd.empty((n,), device=dev)
         out = mod.get_output(0, out)
         np.testing.assert_equal(out.numpy(), a + 1)
+        # inputs, run and outputs in one round trip
+        outs = mod.run_from_bytes(x=a)
+        np.testing.assert_equal(outs[0], a + 1)
 
     def check_sharing():
         x = relay.var("x", shape=(1, 10))
@@ -138,6 +146,123 @@ def test_load_unexpected_params():
     rt_mod.load_params(runtime.save_param_dict(new_params))
 
 
+def _inter_op_graph():
+    x = relay.var("x", shape=(4, 32))
+    branches = []
+    weights = {}
+    for i in range(4):
+        w = relay.var("w%d" % i, shape=(16, 32))
+        weights["w%d" % i] = np.random.uniform(size=(16, 32)).astype("float32")
+        branches.append(relay.nn.relu(relay.nn.dense(x, w)))
+    out = relay.concatenate(branches, axis=1)
+    mod = tvm.IRModule.from_expr(relay.Function(relay.analysis.free_vars(out), out))
+    lib = relay.build(mod, target="llvm", params=weights)
+
+    x_np = np.random.uniform(size=(4, 32)).astype("float32")
+    expected = np.concatenate(
+        [np.maximum(x_np.dot(weights["w%d" % i].T), 0) for i in range(4)], axis=1
+    )
+    return lib, x_np, expected
+
+
+@tvm.testing.requires_llvm
+def test_graph_inter_op_parallel():
+    lib, x_np, expected = _inter_op_graph()
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.config_inter_op_parallel(4, 1)
+    for _ in range(3):
+        gmod.run(x=x_np)
+        tvm.testing.assert_allclose(gmod.get_output(0).numpy(), expected, rtol=1e-5)
+    # back to running the nodes in order
+    gmod.config_inter_op_parallel(1)
+    gmod.run(x=x_np)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), expected, rtol=1e-5)
+
+
+def _num_threads(at_least=0):
+    """The number of threads of this process once it stops changing."""
+    count = len(os.listdir("/proc/self/task"))
+    for _ in range(100):
+        time.sleep(0.05)
+        now = len(os.listdir("/proc/self/task"))
+        if now == count and count >= at_least:
+            break
+        count = now
+    return count
+
+
+@pytest.mark.skipif(
+    not os.path.isdir("/proc/self/task") or os.cpu_count() < 2,
+    reason="counts the threads in /proc, needs a core for each thread of a worker",
+)
+@tvm.testing.requires_llvm
+def test_graph_inter_op_parallel_threads():
+    """The pool of a worker only holds the threads of its slice of the cores."""
+    lib, x_np, expected = _inter_op_graph()
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    base = _num_threads()
+    gmod.config_inter_op_parallel(2, 2)
+    gmod.run(x=x_np)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), expected, rtol=1e-5)
+    # two workers and one pool thread each, the worker runs the other task itself
+    assert _num_threads(base + 4) == base + 4
+    gmod.config_inter_op_parallel(1)
+    assert _num_threads() == base
+
+
+@tvm.testing.requires_llvm
+def test_load_params_mapped():
+    x = relay.var("x", shape=(4, 10))
+    w = relay.var("w", shape=(16, 10))
+    mod = tvm.IRModule.from_expr(relay.Function([x, w], relay.nn.dense(x, w)))
+    lib = relay.build(mod, target="llvm")
+    w_np = np.random.uniform(size=(16, 10)).astype("float32")
+    x_np = np.random.uniform(size=(4, 10)).astype("float32")
+
+    temp = utils.tempdir()
+    path = temp.relpath("params.bin")
+    runtime.save_param_dict_mapped({"w": w_np}, path)
+    loaded = runtime.load_param_dict_mapped(path)
+    tvm.testing.assert_allclose(loaded["w"].numpy(), w_np)
+
+    gmod = graph_executor.GraphModule(lib["default"](tvm.cpu(0)))
+    gmod.load_params_mapped(path)
+    gmod.run(x=x_np)
+    tvm.testing.assert_allclose(gmod.get_output(0).numpy(), x_np.dot(w_np.T), rtol=1e-5)
+    tvm.testing.assert_allclose(gmod.get_input(1).numpy(), w_np)
+
+
+@pytest.mark.parametrize(
+    "field, fmt, value",
+    [
+        # alignment, not a power of two
+        (8, "<Q", 3),
+        # data offset of "w", past the end of the file
+        (33, "<Q", 1 << 40),
+        # ndim of "w"
+        (45, "<i", 1000),
+        # first dim of "w", larger than the file
+        (49, "<q", 1 << 40),
+    ],
+)
+def test_load_params_mapped_corrupt(field, fmt, value):
+    temp = utils.tempdir()
+    path = temp.relpath("params.bin")
+    runtime.save_param_dict_mapped({"w": np.ones((16, 10), "float32")}, path)
+    with open(path, "rb") as f:
+        data = bytearray(f.read())
+    # magic, alignment, then the names: count, length, "w", then the offset,
+    # dtype and ndim of "w" followed by its shape
+    assert struct.unpack_from("<QQQQc", data) == (0xF7E58D4F05049CB8, 128, 1, 1, b"w")
+    struct.pack_into(fmt, data, field, value)
+    with open(path, "wb") as f:
+        f.write(data)
+    with pytest.raises(tvm.TVMError):
+        runtime.load_param_dict_mapped(path)
+
+
 if __name__ == "__main__":
     test_graph_simple()
     test_load_unexpected_params()
+    test_graph_inter_op_parallel()
+    test_load_params_mapped()
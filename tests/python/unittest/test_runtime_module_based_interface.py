@@ -14,6 +14,8 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import threading
+
 import numpy as np
 from tvm import relay, runtime
 from tvm.relay import testing
@@ -86,6 +88,37 @@ def test_cpu():
     tvm.testing.assert_allclose(out, verify(data), atol=1e-5)
 
 
+@tvm.testing.requires_llvm
+def test_cpu_executor_pool():
+    mod, params = relay.testing.synthetic.get_workload()
+    with relay.build_config(opt_level=3):
+        complied_graph_lib = relay.build_module.build(mod, "llvm", params=params)
+    dev = tvm.cpu()
+    pool = graph_executor.GraphModulePool(complied_graph_lib["create_pool"](3, dev))
+    assert pool.get_num_instances() == 3
+
+    datas = [np.random.uniform(-1, 1, size=input_shape(mod)).astype("float32") for _ in range(6)]
+    results = [None] * len(datas)
+
+    def worker(index):
+        results[index] = pool.run(data=datas[index])[0].numpy()
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(len(datas))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for data, out in zip(datas, results):
+        tvm.testing.assert_allclose(out, verify(data), atol=1e-5)
+
+    # executors hold their own activations and share the weights
+    with pool.instance() as gmod_a, pool.instance() as gmod_b:
+        gmod_a.run(data=datas[0])
+        gmod_b.run(data=datas[1])
+        tvm.testing.assert_allclose(gmod_a.get_output(0).numpy(), results[0], atol=1e-5)
+        tvm.testing.assert_allclose(gmod_b.get_output(0).numpy(), results[1], atol=1e-5)
+
+
 @tvm.testing.requires_llvm
 def test_cpu_get_graph_json():
     mod, params = relay.testing.synthetic.get_workload()
@@ -622,3 +655,4 @@ if __name__ == "__main__":
     test_debug_graph_executor()
     test_multiple_imported_modules()
     test_cpu_get_graph_json()
+    test_cpu_executor_pool()
@@ -157,6 +157,65 @@ def test_rpc_large_array():
     check_remote()
 
 
+@tvm.testing.requires_rpc
+def test_rpc_copy_options():
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+    dev = remote.cpu(0)
+    # spans several copy blocks, mostly zeros so that compression kicks in
+    sparse_np = np.zeros((3, 1 << 20), dtype="float32")
+    sparse_np[:, ::97] = np.random.uniform(size=sparse_np[:, ::97].shape)
+    dense_np = np.random.uniform(size=(1 << 20,)).astype("float32")
+
+    for max_outstanding, compress in [(1, False), (4, False), (2, True)]:
+        remote.set_copy_options(max_outstanding, compress)
+        for a_np in [sparse_np, dense_np]:
+            a = tvm.nd.array(a_np, dev)
+            np.testing.assert_equal(a.numpy(), a_np)
+
+
+@tvm.testing.requires_rpc
+def test_rpc_async_call():
+    server = rpc.Server(key="x1")
+    client = rpc.connect("127.0.0.1", server.port, key="x1")
+
+    def check_remote():
+        futures = [client.async_call("rpc.test.addone", i) for i in range(10)]
+        assert [f.result() for f in futures] == list(range(1, 11))
+        future = client.async_call(client.get_function("rpc.test.strcat"), "abc", 11)
+        assert future.result() == "abc:11"
+        future = client.async_call("rpc.test.except", "abc")
+        with pytest.raises(tvm.error.TVMError):
+            future.result()
+        assert future.done()
+        # the session keeps working after a failed call
+        assert client.async_call("rpc.test.addone", 1).result() == 2
+
+    check_remote()
+
+
+@tvm.testing.requires_rpc
+def test_rpc_session_pool():
+    servers = [rpc.Server() for _ in range(2)]
+
+    def check_remote():
+        sessions = [rpc.connect("127.0.0.1", server.port) for server in servers]
+
+        def job(sess, seconds):
+            return sess.async_call("rpc.test.sleep", seconds).result(), sess
+
+        with rpc.SessionPool(sessions) as pool:
+            tstart = time.time()
+            results = pool.map(job, [0.5] * 4)
+            duration = time.time() - tstart
+        assert [value for value, _ in results] == [0.5] * 4
+        # both sessions took jobs and ran them side by side
+        assert len(set(id(sess) for _, sess in results)) == 2
+        assert duration < 1.9
+
+    check_remote()
+
+
 @tvm.testing.requires_rpc
 def test_rpc_echo():
     def check(remote):
@@ -845,6 +845,94 @@ def test_llvm_order_functions():
     assert matches == sorted(matches)
 
 
+@tvm.testing.requires_llvm
+def test_llvm_parallel_codegen():
+    n = 64
+    A = te.placeholder((n,), name="A")
+    funcs = {}
+    for i in range(6):
+        B = te.compute((n,), lambda j: A[j] * (i + 1), name="B")
+        s = te.create_schedule(B.op)
+        funcs["scale%d" % i] = tvm.lower(s, [A, B], name="scale%d" % i)["scale%d" % i]
+    mod = tvm.IRModule(functions=funcs)
+    with tvm.transform.PassContext(config={"tir.num_build_threads": 4}):
+        f = tvm.build(mod, target="llvm")
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+    b = tvm.nd.empty((n,), A.dtype, dev)
+    # the shards are linked back into one module.
+    for i in range(6):
+        f["scale%d" % i](a, b)
+        tvm.testing.assert_allclose(b.numpy(), a.numpy() * (i + 1))
+
+
+def _build_riscv(s, args, target):
+    """Build for RISC-V, skipping when LLVM cannot lower RVV."""
+    if tvm.target.codegen.llvm_version_major() < 14:
+        pytest.skip("RVV lowering needs LLVM 14 or later")
+    try:
+        return tvm.build(s, args, target=target)
+    except tvm.TVMError as err:
+        if "No available targets" not in str(err):
+            raise
+        pytest.skip("LLVM is built without the RISC-V target")
+
+
+@tvm.testing.requires_llvm
+def test_llvm_riscv_vector():
+    n = 256
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: te.exp(A[i]), name="B")
+    s = te.create_schedule(B.op)
+    xo, xi = s[B].split(B.op.axis[0], factor=8)
+    s[B].vectorize(xi)
+    target = "llvm -mtriple=riscv64-unknown-linux-gnu -mattr=+64bit,+m,+a,+f,+d,+c,+v,+zvl256b"
+    lib = _build_riscv(s, [A, B], target)
+    ll = lib.get_source("ll")
+    # vscale is VLEN / 64.
+    assert "vscale_range(4,4)" in ll
+    assert "<8 x float>" in ll
+    # the 8 x float vectors fill one 256 bit register
+    asm = lib.get_source("asm")
+    assert "vsetvli" in asm or "vsetivli" in asm
+    assert "vle32.v" in asm
+    fast = _build_riscv(s, [A, B], target + " -fast-math").get_source("ll")
+    # the vector exp is expanded inline rather than scalarized into expf calls.
+    assert "expf" not in fast
+    assert "llvm.exp." not in fast
+
+
+@tvm.testing.requires_llvm
+def test_llvm_riscv_vector_length_per_build():
+    """Every build lowers for its own vector length, not the one of the first build."""
+    n = 256
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: A[i] * 2.0, name="B")
+    s = te.create_schedule(B.op)
+    xo, xi = s[B].split(B.op.axis[0], factor=8)
+    s[B].vectorize(xi)
+    target = "llvm -mtriple=riscv64-unknown-linux-gnu -mattr=+64bit,+m,+a,+f,+d,+c,+v,+zvl%db"
+    for vlen, lmul in [(128, "m2"), (256, "m1"), (128, "m2")]:
+        asm = _build_riscv(s, [A, B], target % vlen).get_source("asm")
+        # 8 x float takes two 128 bit registers, or one 256 bit register
+        assert "e32, %s" % lmul in asm
+
+
+@tvm.testing.requires_llvm
+@pytest.mark.parametrize("func,libm", [(te.log, "logf"), (te.log2, "log2f"), (tvm.tir.exp2, "exp2f")])
+def test_llvm_riscv_vector_fast_math(func, libm):
+    n = 256
+    A = te.placeholder((n,), name="A")
+    B = te.compute((n,), lambda i: func(A[i]), name="B")
+    s = te.create_schedule(B.op)
+    xo, xi = s[B].split(B.op.axis[0], factor=8)
+    s[B].vectorize(xi)
+    target = "llvm -mtriple=riscv64-unknown-linux-gnu -mattr=+64bit,+m,+a,+f,+d,+c,+v,+zvl256b"
+    fast = _build_riscv(s, [A, B], target + " -fast-math").get_source("asm")
+    assert "vle32.v" in fast
+    assert libm not in fast
+
+
 @tvm.testing.requires_llvm
 def test_llvm_import():
     """all-platform-minimal-test: check shell dependent clang behavior."""